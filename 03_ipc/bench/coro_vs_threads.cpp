@@ -0,0 +1,493 @@
+// coro_vs_threads.cpp
+// Thread-per-conversation vs coroutines: switch cost, memory, IPC throughput
+//
+// switch: handing control between two conversations, as a condition
+//         variable handoff between two threads vs a coroutine resumed
+//         through the EventLoop run queue.
+// memory: N conversations parked waiting for an event, as N blocked
+//         threads vs N suspended coroutines. Reports heap (counted by this
+//         binary's operator new), reserved stack and, on Linux, resident
+//         memory per conversation.
+// ipc:    N concurrent conversations against a forked receiver whose
+//         handler waits -w us per request (a device, another server). With
+//         threads the receiver needs a worker per waiting request; with a
+//         CoroutineRoute one worker and one loop thread keep all of them
+//         in flight. The client side is the same CoroSender in both runs.
+#include "binary_log.h"
+#include "coro_sender.h"
+#include "coroutine_route.h"
+#include "event_loop.h"
+#include "message.h"
+#include "message_dispatcher.h"
+#include "message_sender.h"
+#include "secure_message_receiver.h"
+#include "task.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Count live heap bytes: coroutine frames and thread bookkeeping come from
+// here, thread stacks do not
+namespace {
+    std::atomic<int64_t> heap_bytes{0};
+    constexpr size_t HEADER = alignof(std::max_align_t);
+}
+
+void* operator new(size_t size) {
+    void* block = std::malloc(size + HEADER);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    heap_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    return static_cast<char*>(block) + HEADER;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr != nullptr) {
+        void* block = static_cast<char*>(ptr) - HEADER;
+        heap_bytes.fetch_sub(static_cast<int64_t>(*static_cast<size_t*>(block)),
+                             std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+// Every other form goes through the two above, so none can mix allocators
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace qnx::ipc;
+
+struct Options {
+    unsigned switches = 200000;         // Handoffs per switch measurement
+    unsigned parked = 1000;             // Conversations in the memory test
+    unsigned conversations = 64;        // Concurrent requests in the IPC test
+    std::chrono::microseconds work{1000};
+    std::chrono::milliseconds duration{1000};
+};
+
+// Resident set size in bytes, 0 where /proc does not report it
+size_t residentBytes() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+size_t defaultStackBytes() {
+    pthread_attr_t attr;
+    size_t size = 0;
+    if (pthread_attr_init(&attr) == 0) {
+        pthread_attr_getstacksize(&attr, &size);
+        pthread_attr_destroy(&attr);
+    }
+    return size;
+}
+
+// ---- switch ---------------------------------------------------------------
+
+double threadSwitchNs(unsigned switches) {
+    std::mutex mutex;
+    std::condition_variable turn_cv;
+    unsigned turn = 0;      // Handoffs so far; even: thread 0 runs, odd: thread 1
+
+    const auto player = [&](unsigned parity) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (turn < switches) {
+            turn_cv.wait(lock, [&] { return turn >= switches || turn % 2 == parity; });
+            if (turn < switches) {
+                ++turn;
+                turn_cv.notify_one();
+            }
+        }
+    };
+
+    const auto start = Clock::now();
+    std::thread other(player, 1u);
+    player(0u);
+    other.join();
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / switches;
+}
+
+double coroutineSwitchNs(unsigned switches) {
+    EventLoop loop(1);
+    const auto player = [](EventLoop& loop, unsigned rounds) -> Task<void> {
+        for (unsigned i = 0; i < rounds; ++i) {
+            co_await loop.schedule();   // Requeue behind the other conversation
+        }
+    };
+
+    const auto start = Clock::now();
+    loop.spawn(player(loop, switches / 2));
+    loop.spawn(player(loop, switches / 2));
+    loop.drain();
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / switches;
+}
+
+// ---- memory ---------------------------------------------------------------
+
+struct Footprint {
+    double create_us;       // Per conversation
+    double heap_bytes;
+    double resident_bytes;
+};
+
+Footprint parkThreads(unsigned count) {
+    std::mutex mutex;
+    std::condition_variable open_cv;
+    bool open = false;
+    std::atomic<unsigned> waiting{0};
+
+    const int64_t heap_before = heap_bytes.load();
+    const size_t resident_before = residentBytes();
+    const auto start = Clock::now();
+
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        threads.emplace_back([&] {
+            std::unique_lock<std::mutex> lock(mutex);
+            waiting.fetch_add(1);
+            open_cv.wait(lock, [&] { return open; });
+        });
+    }
+    while (waiting.load() < count) {
+        std::this_thread::yield();
+    }
+    const std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+
+    const Footprint footprint{
+        elapsed.count() / count,
+        static_cast<double>(heap_bytes.load() - heap_before) / count,
+        static_cast<double>(residentBytes() - resident_before) / count
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+    }
+    open_cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return footprint;
+}
+
+// Suspended coroutines waiting for open(), resumed on the loop
+class Gate {
+public:
+    explicit Gate(EventLoop& loop) : loop_(loop) {}
+
+    auto wait() noexcept {
+        struct Awaiter {
+            Gate& gate;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                std::lock_guard<std::mutex> lock(gate.mutex_);
+                gate.waiting_.push_back(handle);
+            }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    size_t waiting() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return waiting_.size();
+    }
+
+    void open() {
+        std::vector<std::coroutine_handle<>> waiting;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            waiting = waiting_;
+            waiting_.clear();       // Keeps its capacity for the next round
+        }
+        for (const auto handle : waiting) {
+            loop_.post(handle);
+        }
+    }
+
+private:
+    EventLoop& loop_;
+    std::mutex mutex_;
+    std::vector<std::coroutine_handle<>> waiting_;
+};
+
+Footprint parkCoroutines(unsigned count) {
+    EventLoop loop(1);
+    Gate gate(loop);
+    const auto conversation = [](Gate& gate) -> Task<void> {
+        co_await gate.wait();
+    };
+
+    // Warm-up round: the gate's vector and the run queue grow here, not below
+    for (unsigned i = 0; i < count; ++i) {
+        loop.spawn(conversation(gate));
+    }
+    while (gate.waiting() < count) {
+        std::this_thread::yield();
+    }
+    gate.open();
+    loop.drain();
+
+    const int64_t heap_before = heap_bytes.load();
+    const size_t resident_before = residentBytes();
+    const auto start = Clock::now();
+
+    for (unsigned i = 0; i < count; ++i) {
+        loop.spawn(conversation(gate));
+    }
+    while (gate.waiting() < count) {
+        std::this_thread::yield();
+    }
+    const std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+
+    const Footprint footprint{
+        elapsed.count() / count,
+        static_cast<double>(heap_bytes.load() - heap_before) / count,
+        static_cast<double>(residentBytes() - resident_before) / count
+    };
+
+    gate.open();
+    loop.drain();
+    return footprint;
+}
+
+// ---- ipc ------------------------------------------------------------------
+
+std::chrono::microseconds handler_work{1000};
+EventLoop* handler_loop = nullptr;
+
+int waitingHandler(const MessageContext&, std::string_view) {
+    std::this_thread::sleep_for(handler_work);
+    return EOK;
+}
+
+Task<int> waitingCoroutine(const MessageContext&, std::string_view) {
+    co_await handler_loop->sleepFor(handler_work);
+    co_return EOK;
+}
+
+using ThreadDispatcher = MessageDispatcher<Route<1, 1, &waitingHandler>>;
+using CoroutineDispatcher = MessageDispatcher<CoroutineRoute<1, 1, &waitingCoroutine>>;
+
+// Child process: a receiver that answers type 1/1 after handler_work
+[[noreturn]] void runReceiver(const std::string& name, bool coroutines, unsigned workers,
+                              int ready_fd) {
+    LogConfig log_config{};
+    log_config.output = LogOutput::FILE;
+    log_config.path = "/dev/null";
+    BinaryLog::start(log_config);
+
+    std::optional<ThreadPoolConfig> pool;
+    std::optional<EventLoop> loop;
+    if (coroutines) {
+        loop.emplace(1);
+        handler_loop = &*loop;
+    } else {
+        pool = ThreadPoolConfig{workers, 1, workers, workers, 0};
+    }
+
+    SecureMessageReceiver receiver(name, pool);
+    receiver.setMessageDispatch(coroutines ? &CoroutineDispatcher::dispatch
+                                           : &ThreadDispatcher::dispatch);
+    if (!receiver.initialize()) {
+        _exit(EXIT_FAILURE);
+    }
+    const char ready = 1;
+    (void)::write(ready_fd, &ready, 1);
+    ::close(ready_fd);
+
+    receiver.run();
+    _exit(EXIT_SUCCESS);
+}
+
+struct IpcResult {
+    double msgs_per_sec;
+    uint64_t errors;
+};
+
+IpcResult measureIpc(const std::string& name, const Options& options) {
+    MessageSender sender("COROBENCH", name);
+    if (!sender.connect() || !sender.startPipeline(options.conversations)) {
+        return IpcResult{0, 0};
+    }
+
+    EventLoop loop(1);
+    CoroSender coro(sender, loop);
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> errors{0};
+
+    const auto conversation = [&]() -> Task<void> {
+        const char payload[64] = {};
+        const MessageView msg{1, 1, std::string_view(payload, sizeof(payload))};
+        while (running.load(std::memory_order_relaxed)) {
+            const SendResult result = co_await coro.send(msg);
+            if (result.ok() && result.status == EOK) {
+                total.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                errors.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    const auto start = Clock::now();
+    for (unsigned i = 0; i < options.conversations; ++i) {
+        loop.spawn(conversation());
+    }
+    std::this_thread::sleep_for(options.duration);
+    running = false;
+    loop.drain();
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    return IpcResult{static_cast<double>(total.load()) / elapsed.count(), errors.load()};
+}
+
+bool runIpc(const std::string& name, bool coroutines, const Options& options,
+            IpcResult& result) {
+    int ready[2];
+    if (::pipe(ready) == -1) {
+        return false;
+    }
+    const pid_t child = ::fork();
+    if (child == -1) {
+        std::fprintf(stderr, "Error: fork failed: %s\n", std::strerror(errno));
+        return false;
+    }
+    if (child == 0) {
+        ::close(ready[0]);
+        runReceiver(name, coroutines, options.conversations, ready[1]);
+    }
+    ::close(ready[1]);
+
+    char byte;
+    const bool attached = (::read(ready[0], &byte, 1) == 1);
+    ::close(ready[0]);
+    if (attached) {
+        result = measureIpc(name, options);
+        BinaryLog::flush();
+    }
+
+    ::kill(child, SIGTERM);
+    ::waitpid(child, nullptr, 0);
+    return attached;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:c:w:d:")) != -1) {
+        switch (opt) {
+            case 's': options.switches = std::strtoul(optarg, nullptr, 0); break;
+            case 'n': options.parked = std::strtoul(optarg, nullptr, 0); break;
+            case 'c': options.conversations = std::strtoul(optarg, nullptr, 0); break;
+            case 'w': options.work = std::chrono::microseconds(std::atoi(optarg)); break;
+            case 'd': options.duration = std::chrono::milliseconds(std::atoi(optarg)); break;
+            default:
+                std::fprintf(stderr,
+                             "Usage: %s [-s switches] [-n parked] [-c conversations]"
+                             " [-w work_us] [-d duration_ms]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (options.switches < 2 || options.parked == 0 || options.conversations == 0) {
+        return EXIT_FAILURE;
+    }
+    handler_work = options.work;
+
+    std::printf("switch: %u handoffs between two conversations\n", options.switches);
+    std::printf("%12s %12s\n", "", "ns/switch");
+    std::printf("%12s %12.0f\n", "threads", threadSwitchNs(options.switches));
+    std::printf("%12s %12.0f\n", "coroutines", coroutineSwitchNs(options.switches));
+
+    std::printf("\nmemory: %u parked conversations (thread stacks reserve %zu KB each)\n",
+                options.parked, defaultStackBytes() / 1024);
+    std::printf("%12s %12s %12s %12s\n", "", "create us", "heap B", "resident B");
+    const Footprint threads = parkThreads(options.parked);
+    const Footprint coroutines = parkCoroutines(options.parked);
+    std::printf("%12s %12.1f %12.0f %12.0f\n", "threads",
+                threads.create_us, threads.heap_bytes, threads.resident_bytes);
+    std::printf("%12s %12.1f %12.0f %12.0f\n", "coroutines",
+                coroutines.create_us, coroutines.heap_bytes, coroutines.resident_bytes);
+
+    // A name of our own, so a running receiver is left alone
+    const std::string name = "coro_vs_threads_" + std::to_string(getpid());
+    std::printf("\nipc: %u conversations, handler waits %lld us, %lld ms per run\n",
+                options.conversations, static_cast<long long>(options.work.count()),
+                static_cast<long long>(options.duration.count()));
+    std::printf("%12s %16s %12s %8s\n", "", "receiver threads", "msg/s", "errors");
+    for (const bool use_coroutines : {false, true}) {
+        IpcResult result{0, 0};
+        if (!runIpc(name, use_coroutines, options, result)) {
+            return EXIT_FAILURE;
+        }
+        std::printf("%12s %16u %12.0f %8llu\n", use_coroutines ? "coroutines" : "threads",
+                    use_coroutines ? 2u : options.conversations, result.msgs_per_sec,
+                    static_cast<unsigned long long>(result.errors));
+    }
+
+    return EXIT_SUCCESS;
+}
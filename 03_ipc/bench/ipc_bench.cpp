@@ -0,0 +1,554 @@
+// ipc_bench.cpp
+// IPC benchmark suite: ping-pong RTT, one-way throughput, payload and
+// sender-count sweeps, priority lanes, with HdrHistogram-style percentiles
+// and JSON output
+//
+// The server is a SecureMessageReceiver in this process, with a
+// MessageDispatcher for the bench message types, and every sender thread
+// is a MessageSender with its own connection, like a separate sender
+// process. A regression in either library shows up here. Everything goes
+// through the transport library, so the suite runs on the target (QNX
+// kernel calls) and on a Linux host (--config=linux-host, Unix sockets).
+#include "binary_log.h"
+#include "latency_histogram.h"
+#include "message.h"
+#include "message_dispatcher.h"
+#include "message_sender.h"
+#include "secure_message_receiver.h"
+#include "transport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sched.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace qnx::ipc;
+
+// Message types understood by the bench server
+constexpr uint16_t BENCH_TYPE_ECHO = 1;     // Reply carries the payload back
+constexpr uint16_t BENCH_TYPE_SINK = 2;     // Reply carries only a status
+constexpr uint16_t BENCH_TYPE_WORK = 3;     // Busy for LANE_WORK_US first
+constexpr uint16_t BENCH_SUBTYPE = 0;
+
+constexpr int PULSE_CODE_BENCH = PULSE_CODE_USER_MIN;
+
+// Payload sweep: fewer iterations for large payloads (bytes per point)
+constexpr size_t SWEEP_BYTE_BUDGET = 256 * 1024 * 1024;
+constexpr size_t SWEEP_MIN_MESSAGES = 200;
+
+// Lanes: paced control sender vs. bulk senders saturating a small pool
+constexpr size_t LANE_CONTROL_MESSAGES = 2000;
+constexpr auto LANE_CONTROL_INTERVAL = std::chrono::microseconds(500);
+constexpr unsigned LANE_BULK_SENDERS = 4;
+constexpr unsigned LANE_BULK_WORKERS = 2;
+constexpr auto LANE_WORK_US = std::chrono::microseconds(50);
+constexpr int LANE_HI_PRIORITY = 20;
+constexpr int LANE_LO_PRIORITY = 9;
+constexpr const char* LANE_CONTROL = "ctl";
+
+enum class LaneLayout {
+    IDLE,       // Control sender alone
+    SHARED,     // Control and bulk senders on one channel
+    SPLIT       // Control on its own lane (channel and workers)
+};
+
+struct Options {
+    std::string mode = "all";
+    size_t messages = 20000;        // Per sender
+    size_t warmup = 1000;           // Per sender, not measured
+    size_t payload = 64;
+    size_t max_payload = 1024 * 1024;
+    unsigned max_senders = 16;
+    std::string json_path;
+};
+
+struct Result {
+    std::string scenario;
+    size_t payload;
+    unsigned senders;
+    uint64_t messages;
+    uint64_t errors;        // Failed sends, or pulses that had to be retried
+    double seconds;
+    LatencyHistogram latency;
+
+    [[nodiscard]] double msgsPerSec() const noexcept {
+        return seconds > 0 ? messages / seconds : 0.0;
+    }
+    [[nodiscard]] double mbPerSec() const noexcept {
+        return msgsPerSec() * payload / (1024.0 * 1024.0);
+    }
+};
+
+int handleEcho(const MessageContext& ctx, std::string_view payload) {
+    if (!payload.empty() && !ctx.reply->append(payload)) {
+        return ENOMEM;
+    }
+    return EOK;
+}
+
+int handleSink(const MessageContext&, std::string_view) {
+    return EOK;
+}
+
+int handleWork(const MessageContext&, std::string_view) {
+    const auto until = Clock::now() + LANE_WORK_US;
+    while (Clock::now() < until) {
+    }
+    return EOK;
+}
+
+using Dispatcher = MessageDispatcher<
+    Route<BENCH_TYPE_ECHO, BENCH_SUBTYPE, &handleEcho>,
+    Route<BENCH_TYPE_SINK, BENCH_SUBTYPE, &handleSink>,
+    Route<BENCH_TYPE_WORK, BENCH_SUBTYPE, &handleWork>>;
+
+/**
+ * @brief Bench server: a SecureMessageReceiver running on its own thread
+ *
+ * Each server attaches a name of its own, so a running receiver is left
+ * alone and scenarios do not see each other's clients.
+ */
+class BenchServer {
+public:
+    explicit BenchServer(unsigned max_workers)
+        : BenchServer(poolFor(max_workers)) {}
+
+    explicit BenchServer(const ThreadPoolConfig& config,
+                         std::optional<LaneConfig> lane = std::nullopt)
+        : name_("ipc_bench_" + std::to_string(getpid()) + "_" +
+                std::to_string(next_serial_++)),
+          receiver_(name_, config) {
+        receiver_.setMessageDispatch(&Dispatcher::dispatch);
+        (void)receiver_.registerPulseHandler(PULSE_CODE_BENCH, [this](int, int, int) {
+            pulses_.fetch_add(1, std::memory_order_relaxed);
+        });
+        if ((lane && !receiver_.addLane(std::move(*lane))) || !receiver_.initialize()) {
+            std::fprintf(stderr, "Error: Cannot start bench receiver %s\n", name_.c_str());
+            std::exit(EXIT_FAILURE);
+        }
+        thread_ = std::thread([this] { receiver_.run(); });
+    }
+
+    ~BenchServer() {
+        receiver_.requestStop();
+        thread_.join();
+    }
+
+    BenchServer(const BenchServer&) = delete;
+    BenchServer& operator=(const BenchServer&) = delete;
+
+    /**
+     * @brief A connected sender
+     * @param lane Lane suffix; empty for the main channel
+     */
+    [[nodiscard]] std::unique_ptr<MessageSender> connect(std::string_view lane = {}) {
+        std::string target = name_;
+        if (!lane.empty()) {
+            target += ".";
+            target += lane;
+        }
+        // Sender ids name the senders' metrics, so each gets its own
+        auto sender = std::make_unique<MessageSender>(
+            "BENCH-" + std::to_string(next_serial_++), target);
+        if (!sender->connect()) {
+            std::fprintf(stderr, "Error: Cannot connect to %s\n", target.c_str());
+            std::exit(EXIT_FAILURE);
+        }
+        return sender;
+    }
+
+    [[nodiscard]] uint64_t pulses() const noexcept {
+        return pulses_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static ThreadPoolConfig poolFor(unsigned max_workers) {
+        ThreadPoolConfig config{};
+        config.maximum = std::max(config.maximum, max_workers);
+        return config;
+    }
+
+    static inline std::atomic<unsigned> next_serial_{0};
+
+    std::string name_;
+    std::atomic<uint64_t> pulses_{0};
+    SecureMessageReceiver receiver_;
+    std::thread thread_;
+};
+
+uint64_t elapsedNs(Clock::time_point since) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count());
+}
+
+// One synchronous send; an echo reply must come back whole
+bool sendOne(MessageSender& sender, const MessageView& msg, std::vector<char>& reply) {
+    int status = 0;
+    if (msg.type == BENCH_TYPE_ECHO) {
+        const auto echoed = sender.request(msg, reply.data(), reply.size(), status);
+        return echoed && status == EOK && echoed->size() == msg.payload.size();
+    }
+    return sender.sendMessage(msg, status) && status == EOK;
+}
+
+/**
+ * @brief Synchronous sends from `senders` threads, each on its own connection
+ */
+Result runSends(const char* scenario, uint16_t type, size_t payload_size,
+                unsigned senders, size_t messages, size_t warmup) {
+    BenchServer server(senders + 1);
+
+    Result result{scenario, payload_size, senders, 0, 0, 0.0, LatencyHistogram()};
+    std::vector<LatencyHistogram> histograms(senders);
+    std::vector<uint64_t> errors(senders, 0);
+
+    std::promise<void> go;
+    std::shared_future<void> start = go.get_future().share();
+    std::atomic<unsigned> ready{0};
+    std::vector<std::thread> threads;
+
+    for (unsigned s = 0; s < senders; ++s) {
+        threads.emplace_back([&, s] {
+            auto sender = server.connect();
+            std::vector<char> payload(payload_size, 'x');
+            std::vector<char> reply(std::max<size_t>(payload_size, 1));
+            const MessageView msg{type, BENCH_SUBTYPE,
+                                  std::string_view(payload.data(), payload.size())};
+
+            for (size_t i = 0; i < warmup; ++i) {
+                (void)sendOne(*sender, msg, reply);
+            }
+
+            ++ready;
+            start.wait();
+
+            for (size_t i = 0; i < messages; ++i) {
+                const auto sent = Clock::now();
+                if (!sendOne(*sender, msg, reply)) {
+                    ++errors[s];
+                    continue;
+                }
+                histograms[s].record(elapsedNs(sent));
+            }
+        });
+    }
+
+    while (ready.load() < senders) {
+        std::this_thread::yield();
+    }
+    const auto begin = Clock::now();
+    go.set_value();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    for (unsigned s = 0; s < senders; ++s) {
+        result.latency.merge(histograms[s]);
+        result.errors += errors[s];
+    }
+    result.messages = result.latency.count();
+    return result;
+}
+
+/**
+ * @brief One-way pulses: the sender never waits for the receiver
+ *
+ * Latency here is the cost of the send call itself. Pulses that cannot
+ * be queued (EAGAIN) are retried and counted as errors.
+ */
+Result runPulses(size_t messages) {
+    BenchServer server(2);
+    auto sender = server.connect();
+
+    Result result{"pulse", sizeof(int), 1, 0, 0, 0.0, LatencyHistogram()};
+
+    const auto begin = Clock::now();
+    for (size_t i = 0; i < messages; ++i) {
+        const auto sent = Clock::now();
+        while (!sender->sendPulse(PULSE_CODE_BENCH, static_cast<int>(i))) {
+            if (sender->pulseStats().failed > 0) {
+                std::fprintf(stderr, "Error: sendPulse failed\n");
+                std::exit(EXIT_FAILURE);
+            }
+            ++result.errors;
+            sched_yield();
+        }
+        result.latency.record(elapsedNs(sent));
+    }
+
+    // Throughput counts delivery, not just queueing
+    while (server.pulses() < messages) {
+        std::this_thread::yield();
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    result.messages = messages;
+    return result;
+}
+
+/**
+ * @brief Control-message RTT while bulk senders saturate the receiver
+ *
+ * A paced, high-priority control sender measures round trips. In SHARED
+ * layout LANE_BULK_SENDERS low-priority senders keep the main channel's
+ * LANE_BULK_WORKERS workers busy; in SPLIT layout the control sender has
+ * a lane of the same receiver to itself (channel and workers).
+ */
+Result runLanes(const char* scenario, LaneLayout layout, size_t messages,
+                size_t warmup, bool priorities) {
+    ThreadPoolConfig bulk_config{};
+    bulk_config.lo_water = 1;
+    bulk_config.hi_water = LANE_BULK_WORKERS;
+    bulk_config.maximum = LANE_BULK_WORKERS;
+    bulk_config.priority = priorities ? LANE_LO_PRIORITY : 0;
+
+    std::optional<LaneConfig> control_lane;
+    std::string_view control_suffix;
+    if (layout == LaneLayout::SPLIT) {
+        ThreadPoolConfig control_config{};
+        control_config.priority = priorities ? LANE_HI_PRIORITY : 0;
+        control_lane = LaneConfig{LANE_CONTROL, control_config.priority, control_config};
+        control_suffix = LANE_CONTROL;
+    }
+    BenchServer server(bulk_config, std::move(control_lane));
+
+    const unsigned bulk_senders = layout == LaneLayout::IDLE ? 0 : LANE_BULK_SENDERS;
+    Result result{scenario, 0, 1 + bulk_senders, 0, 0, 0.0, LatencyHistogram()};
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> bulk;
+    for (unsigned s = 0; s < bulk_senders; ++s) {
+        bulk.emplace_back([&] {
+            if (priorities) {
+                setThreadPriority(LANE_LO_PRIORITY);
+            }
+            auto sender = server.connect();
+            const MessageView msg{BENCH_TYPE_WORK, BENCH_SUBTYPE, {}};
+            int status = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                (void)sender->sendMessage(msg, status);
+            }
+        });
+    }
+
+    std::thread control([&] {
+        if (priorities) {
+            setThreadPriority(LANE_HI_PRIORITY);
+        }
+        auto sender = server.connect(control_suffix);
+        const MessageView msg{BENCH_TYPE_SINK, BENCH_SUBTYPE, {}};
+        std::vector<char> reply(1);
+
+        for (size_t i = 0; i < warmup; ++i) {
+            (void)sendOne(*sender, msg, reply);
+        }
+
+        const auto begin = Clock::now();
+        for (size_t i = 0; i < messages; ++i) {
+            const auto sent = Clock::now();
+            if (!sendOne(*sender, msg, reply)) {
+                ++result.errors;
+            } else {
+                result.latency.record(elapsedNs(sent));
+            }
+            std::this_thread::sleep_for(LANE_CONTROL_INTERVAL);
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    });
+
+    control.join();
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& thread : bulk) {
+        thread.join();
+    }
+
+    result.messages = result.latency.count();
+    return result;
+}
+
+void printHeader() {
+    std::printf("%-11s %8s %7s %12s %9s %9s %9s %9s %10s %10s\n",
+                "scenario", "payload", "senders", "msg/s", "MB/s",
+                "p50 ns", "p99 ns", "p99.9 ns", "max ns", "errors");
+}
+
+void printResult(const Result& r) {
+    std::printf("%-11s %8zu %7u %12.0f %9.1f %9llu %9llu %9llu %10llu %10llu\n",
+                r.scenario.c_str(), r.payload, r.senders, r.msgsPerSec(), r.mbPerSec(),
+                static_cast<unsigned long long>(r.latency.percentile(50.0)),
+                static_cast<unsigned long long>(r.latency.percentile(99.0)),
+                static_cast<unsigned long long>(r.latency.percentile(99.9)),
+                static_cast<unsigned long long>(r.latency.max()),
+                static_cast<unsigned long long>(r.errors));
+    std::fflush(stdout);
+}
+
+bool writeJson(const std::string& path, const Options& options,
+               const std::vector<Result>& results) {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (out == nullptr) {
+        std::fprintf(stderr, "Error: Cannot write %s: %s\n", path.c_str(),
+                     std::strerror(errno));
+        return false;
+    }
+
+    std::fprintf(out, "{\n  \"transport\": \"%s\",\n", transportName());
+    std::fprintf(out, "  \"config\": {\"mode\": \"%s\", \"messages\": %zu, "
+                      "\"warmup\": %zu, \"payload\": %zu},\n",
+                 options.mode.c_str(), options.messages, options.warmup, options.payload);
+    std::fprintf(out, "  \"results\": [\n");
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        const LatencyHistogram& h = r.latency;
+        std::fprintf(out,
+            "    {\"scenario\": \"%s\", \"payload\": %zu, \"senders\": %u, "
+            "\"messages\": %llu, \"errors\": %llu, \"seconds\": %.6f, "
+            "\"msgs_per_sec\": %.1f, \"mb_per_sec\": %.3f,\n"
+            "     \"latency_ns\": {\"min\": %llu, \"mean\": %.1f, \"p50\": %llu, "
+            "\"p90\": %llu, \"p99\": %llu, \"p99_9\": %llu, \"p99_99\": %llu, "
+            "\"max\": %llu}}%s\n",
+            r.scenario.c_str(), r.payload, r.senders,
+            static_cast<unsigned long long>(r.messages),
+            static_cast<unsigned long long>(r.errors),
+            r.seconds, r.msgsPerSec(), r.mbPerSec(),
+            static_cast<unsigned long long>(h.min()), h.mean(),
+            static_cast<unsigned long long>(h.percentile(50.0)),
+            static_cast<unsigned long long>(h.percentile(90.0)),
+            static_cast<unsigned long long>(h.percentile(99.0)),
+            static_cast<unsigned long long>(h.percentile(99.9)),
+            static_cast<unsigned long long>(h.percentile(99.99)),
+            static_cast<unsigned long long>(h.max()),
+            i + 1 < results.size() ? "," : "");
+    }
+
+    std::fprintf(out, "  ]\n}\n");
+    return std::fclose(out) == 0;
+}
+
+void printUsage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [-m mode] [-n messages] [-w warmup] [-s payload]"
+        " [-S max_payload] [-c max_senders] [-j results.json]\n"
+        "  -m  pingpong | throughput | pulse | payload | senders | lanes | all\n"
+        "      pingpong:   1 sender, payload echoed back (round-trip time)\n"
+        "      throughput: 1 sender, status-only reply\n"
+        "      pulse:      1 sender, one-way pulses\n"
+        "      payload:    ping-pong for payloads 0..max_payload\n"
+        "      senders:    throughput for 1..max_senders concurrent senders\n"
+        "      lanes:      control RTT idle, sharing a channel with bulk\n"
+        "                  senders, and on its own lane\n"
+        "  -n  Measured messages per sender (default 20000)\n"
+        "  -w  Unmeasured warm-up messages per sender (default 1000)\n"
+        "  -j  Also write results as JSON\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "m:n:w:s:S:c:j:")) != -1) {
+        switch (opt) {
+            case 'm': options.mode = optarg; break;
+            case 'n': options.messages = std::strtoul(optarg, nullptr, 0); break;
+            case 'w': options.warmup = std::strtoul(optarg, nullptr, 0); break;
+            case 's': options.payload = std::strtoul(optarg, nullptr, 0); break;
+            case 'S': options.max_payload = std::strtoul(optarg, nullptr, 0); break;
+            case 'c': options.max_senders = std::strtoul(optarg, nullptr, 0); break;
+            case 'j': options.json_path = optarg; break;
+            default:
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    const auto wants = [&options](const char* mode) {
+        return options.mode == "all" || options.mode == mode;
+    };
+    if (!wants("pingpong") && !wants("throughput") && !wants("pulse") &&
+        !wants("payload") && !wants("senders") && !wants("lanes")) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    options.payload = std::min(options.payload, MAX_PAYLOAD_SIZE);
+    options.max_payload = std::min(options.max_payload, MAX_PAYLOAD_SIZE);
+    options.max_senders = std::max(options.max_senders, 1u);
+
+    // The libraries' own logging is discarded; failures are counted instead
+    LogConfig log_config{};
+    log_config.output = LogOutput::FILE;
+    log_config.path = "/dev/null";
+    BinaryLog::start(log_config);
+
+    std::printf("IPC benchmark (transport: %s, %zu messages per sender)\n",
+                transportName(), options.messages);
+    printHeader();
+
+    std::vector<Result> results;
+    const auto add = [&results](Result result) {
+        printResult(result);
+        results.push_back(std::move(result));
+    };
+
+    if (wants("pingpong")) {
+        add(runSends("pingpong", BENCH_TYPE_ECHO, options.payload, 1,
+                     options.messages, options.warmup));
+    }
+    if (wants("throughput")) {
+        add(runSends("throughput", BENCH_TYPE_SINK, options.payload, 1,
+                     options.messages, options.warmup));
+    }
+    if (wants("pulse")) {
+        add(runPulses(options.messages));
+    }
+    if (wants("payload")) {
+        for (size_t size = 0; size <= options.max_payload; size = size ? size * 4 : 16) {
+            const size_t messages = std::clamp(SWEEP_BYTE_BUDGET / std::max<size_t>(size, 1),
+                                               SWEEP_MIN_MESSAGES, options.messages);
+            add(runSends("payload", BENCH_TYPE_ECHO, size, 1, messages,
+                         std::min(options.warmup, messages)));
+        }
+    }
+    if (wants("senders")) {
+        for (unsigned senders = 1; senders <= options.max_senders; senders *= 2) {
+            add(runSends("senders", BENCH_TYPE_SINK, options.payload, senders,
+                         options.messages, options.warmup));
+        }
+    }
+
+    if (wants("lanes")) {
+        // Priorities need a policy that has them (SCHED_RR on QNX, root on Linux)
+        bool priorities = false;
+        std::thread([&priorities] { priorities = setThreadPriority(LANE_HI_PRIORITY); }).join();
+        if (!priorities) {
+            std::printf("# lanes: thread priorities unavailable, running without them\n");
+        }
+
+        const size_t messages = std::min(options.messages, LANE_CONTROL_MESSAGES);
+        const size_t warmup = std::min(options.warmup, messages);
+        add(runLanes("lane-idle", LaneLayout::IDLE, messages, warmup, priorities));
+        add(runLanes("lane-shared", LaneLayout::SHARED, messages, warmup, priorities));
+        add(runLanes("lane-split", LaneLayout::SPLIT, messages, warmup, priorities));
+    }
+
+    if (!options.json_path.empty() && !writeJson(options.json_path, options, results)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
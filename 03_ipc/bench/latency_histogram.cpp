@@ -0,0 +1,93 @@
+// latency_histogram.cpp
+// HdrHistogram-style latency recorder - Implementation
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace qnx::ipc {
+
+namespace {
+    // 2048 sub-buckets in bucket 0, 1024 (the upper half) in every other
+    constexpr unsigned SUB_BUCKET_BITS = 11;
+    constexpr unsigned SUB_BUCKET_HALF_BITS = SUB_BUCKET_BITS - 1;
+    constexpr uint64_t SUB_BUCKET_HALF = uint64_t{1} << SUB_BUCKET_HALF_BITS;
+    constexpr uint64_t SUB_BUCKET_MASK = (uint64_t{1} << SUB_BUCKET_BITS) - 1;
+
+    // Highest trackable value: 2^42 ns, about 73 minutes
+    constexpr unsigned BUCKET_COUNT = 42 - SUB_BUCKET_BITS + 1;
+    constexpr size_t COUNTS_SIZE = (BUCKET_COUNT + 1) * SUB_BUCKET_HALF;
+
+    unsigned log2Floor(uint64_t value) noexcept {
+        return 63u - static_cast<unsigned>(__builtin_clzll(value | 1));
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+    : counts_(COUNTS_SIZE, 0),
+      total_(0),
+      min_(UINT64_MAX),
+      max_(0),
+      sum_(0) {}
+
+size_t LatencyHistogram::indexOf(uint64_t value) noexcept {
+    const unsigned bucket = log2Floor(value | SUB_BUCKET_MASK) - SUB_BUCKET_HALF_BITS;
+    const uint64_t sub_bucket = value >> bucket;
+    const size_t index = ((bucket + 1) << SUB_BUCKET_HALF_BITS) + sub_bucket - SUB_BUCKET_HALF;
+    return std::min(index, COUNTS_SIZE - 1);
+}
+
+uint64_t LatencyHistogram::highestEquivalent(size_t index) noexcept {
+    int bucket = static_cast<int>(index >> SUB_BUCKET_HALF_BITS) - 1;
+    uint64_t sub_bucket = (index & (SUB_BUCKET_HALF - 1)) + SUB_BUCKET_HALF;
+    if (bucket < 0) {
+        sub_bucket -= SUB_BUCKET_HALF;
+        bucket = 0;
+    }
+    const uint64_t lowest = sub_bucket << bucket;
+    return lowest + (uint64_t{1} << bucket) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value_ns) noexcept {
+    ++counts_[indexOf(value_ns)];
+    ++total_;
+    min_ = std::min(min_, value_ns);
+    max_ = std::max(max_, value_ns);
+    sum_ += value_ns;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) noexcept {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    total_ += other.total_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const noexcept {
+    if (total_ == 0) {
+        return 0;
+    }
+
+    const double clamped = std::clamp(percent, 0.0, 100.0);
+    const uint64_t target = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * total_)));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            // The last occupied bucket holds the maximum, known exactly
+            return seen == total_ ? max_ : std::min(highestEquivalent(i), max_);
+        }
+    }
+    return max_;
+}
+
+double LatencyHistogram::mean() const noexcept {
+    return total_ ? static_cast<double>(sum_ / total_) : 0.0;
+}
+
+} // namespace qnx::ipc
@@ -0,0 +1,59 @@
+// latency_histogram.h
+// HdrHistogram-style latency recorder for the IPC benchmarks - Header
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Log-linear histogram of nanosecond values, as in HdrHistogram
+ *
+ * Values are grouped into power-of-two buckets each split into 1024
+ * linear sub-buckets, so any recorded value is reported within 0.1%
+ * (three significant digits) from 1 ns up to about 73 minutes, in a
+ * fixed 256 KB of counters. Recording is a shift and an increment.
+ * Not thread-safe: record per thread and merge() afterwards.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Count one value; values above the range count as the maximum
+     */
+    void record(uint64_t value_ns) noexcept;
+
+    /**
+     * @brief Add another histogram's counts to this one
+     */
+    void merge(const LatencyHistogram& other) noexcept;
+
+    /**
+     * @brief Value at or below which `percent` of recorded values fall
+     * @param percent 0..100 (e.g. 99.9)
+     */
+    [[nodiscard]] uint64_t percentile(double percent) const noexcept;
+
+    [[nodiscard]] uint64_t count() const noexcept { return total_; }
+    [[nodiscard]] uint64_t min() const noexcept { return total_ ? min_ : 0; }
+    [[nodiscard]] uint64_t max() const noexcept { return max_; }
+    [[nodiscard]] double mean() const noexcept;
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t total_;
+    uint64_t min_;
+    uint64_t max_;
+    long double sum_;
+
+    [[nodiscard]] static size_t indexOf(uint64_t value) noexcept;
+    [[nodiscard]] static uint64_t highestEquivalent(size_t index) noexcept;
+};
+
+} // namespace qnx::ipc
+
+#endif // LATENCY_HISTOGRAM_H
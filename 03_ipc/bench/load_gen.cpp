@@ -0,0 +1,393 @@
+// load_gen.cpp
+// Open-loop load generator: paced arrivals over N MessageSender connections,
+// latency corrected for coordinated omission
+//
+// Every message has an intended send time taken from the arrival schedule
+// (constant or Poisson) and is submitted at that time whether or not earlier
+// replies have come back. Latency is measured from the intended time, so when
+// the receiver stalls, the messages that queued up behind the stall are
+// charged for it instead of silently not being sent. Service time (submit to
+// reply) is reported alongside to show the difference.
+//
+// Each connection runs a SendPipeline with `window` requests in flight; a
+// list of rates is run back to back to find the saturation point. With -F
+// the connections join the receiver's flow control and an arrival that
+// finds no free credit is shed (counted, not sent) instead of queueing.
+// With -D every message must be replied to within that long of its intended
+// time; those that are not give up with ETIMEDOUT and count as timed out.
+#include "binary_log.h"
+#include "latency_histogram.h"
+#include "message_sender.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace qnx::ipc;
+
+constexpr const char* DEFAULT_RECEIVER = "qnx_receiver_secure";
+
+// Sleep most of a gap, spin the rest: timer ticks (1 ms on QNX by default)
+// are far coarser than the pacing we need
+constexpr auto SPIN_THRESHOLD = std::chrono::microseconds(1500);
+
+// Submissions this far behind their intended time count as late
+constexpr auto LATE_THRESHOLD = std::chrono::microseconds(100);
+
+enum class Arrivals {
+    CONSTANT,   // Fixed interval
+    POISSON     // Exponential interarrival times
+};
+
+/**
+ * @brief Payload size distribution: N, MIN-MAX (uniform) or exp:MEAN
+ */
+struct SizeSpec {
+    enum class Kind { FIXED, UNIFORM, EXPONENTIAL } kind = Kind::FIXED;
+    size_t min = 64;
+    size_t max = 64;    // Upper bound for every kind
+    double mean = 64;
+};
+
+struct Options {
+    std::string receiver = DEFAULT_RECEIVER;
+    std::string lane;
+    std::vector<double> rates{1000};    // Total messages/sec, across connections
+    Arrivals arrivals = Arrivals::CONSTANT;
+    SizeSpec size;
+    unsigned connections = 1;
+    size_t window = 16;                 // Requests in flight per connection
+    double seconds = 10;                // Measured time per rate
+    double warmup = 1;                  // Unmeasured time per rate
+    uint16_t type = 1;
+    uint16_t subtype = 1;
+    bool flow_control = false;          // Shed arrivals that would wait for a credit
+    std::chrono::microseconds deadline{0};  // From the intended time; 0 = none
+};
+
+/**
+ * @brief One connection's sender, schedule and results for the current rate
+ */
+struct Connection {
+    explicit Connection(const std::string& id, const Options& options)
+        : sender(id, options.receiver) {}
+
+    MessageSender sender;
+    std::mutex mutex;               // Replies arrive on pipeline threads
+    LatencyHistogram latency;       // Intended send time to reply
+    LatencyHistogram service;       // Actual submit to reply
+    uint64_t errors = 0;
+    uint64_t timeouts = 0;          // Deadline passed (-D); not in errors
+    uint64_t late = 0;              // Submitted LATE_THRESHOLD or more behind schedule
+    uint64_t submitted = 0;
+    uint64_t shed = 0;              // Refused for lack of credit (-F)
+};
+
+std::optional<SizeSpec> parseSize(const std::string& text) {
+    SizeSpec spec;
+    char* end = nullptr;
+
+    if (text.rfind("exp:", 0) == 0) {
+        spec.kind = SizeSpec::Kind::EXPONENTIAL;
+        spec.mean = std::strtod(text.c_str() + 4, &end);
+        spec.min = 1;
+        spec.max = MAX_PAYLOAD_SIZE;
+        return (*end == '\0' && spec.mean >= 1) ? std::optional(spec) : std::nullopt;
+    }
+
+    spec.min = std::strtoul(text.c_str(), &end, 0);
+    spec.max = spec.min;
+    if (*end == '-') {
+        spec.kind = SizeSpec::Kind::UNIFORM;
+        spec.max = std::strtoul(end + 1, &end, 0);
+    }
+    if (*end != '\0' || spec.min == 0 || spec.min > spec.max || spec.max > MAX_PAYLOAD_SIZE) {
+        return std::nullopt;
+    }
+    return spec;
+}
+
+std::vector<double> parseRates(const std::string& text) {
+    std::vector<double> rates;
+    const char* pos = text.c_str();
+    while (*pos != '\0') {
+        char* end = nullptr;
+        const double rate = std::strtod(pos, &end);
+        if (end == pos || rate <= 0) {
+            return {};
+        }
+        rates.push_back(rate);
+        pos = (*end == ',') ? end + 1 : end;
+    }
+    return rates;
+}
+
+void waitUntil(Clock::time_point when) {
+    if (when - Clock::now() > SPIN_THRESHOLD) {
+        std::this_thread::sleep_until(when - SPIN_THRESHOLD);
+    }
+    while (Clock::now() < when) {
+    }
+}
+
+uint64_t elapsedNs(Clock::time_point from, Clock::time_point to) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+/**
+ * @brief Submit one connection's share of the schedule for one rate
+ *
+ * Intended times advance by the interarrival distribution independently
+ * of when replies come back; if submitting falls behind (full pipeline),
+ * the following messages go out at once and are charged from their
+ * intended time.
+ */
+void runSchedule(Connection& connection, const Options& options, double rate,
+                 Clock::time_point start, Clock::time_point measure_from,
+                 Clock::time_point end, uint64_t seed, const std::string& payload) {
+    std::mt19937_64 rng(seed);
+    std::exponential_distribution<double> poisson(rate / 1e9);
+    std::uniform_int_distribution<size_t> uniform(options.size.min, options.size.max);
+    std::exponential_distribution<double> exponential(1.0 / options.size.mean);
+
+    const double interval_ns = 1e9 / rate;
+    double offset_ns = 0;
+
+    while (true) {
+        offset_ns += (options.arrivals == Arrivals::POISSON) ? poisson(rng) : interval_ns;
+        const auto intended = start + std::chrono::nanoseconds(static_cast<int64_t>(offset_ns));
+        if (intended >= end) {
+            break;
+        }
+
+        size_t size = options.size.min;
+        if (options.size.kind == SizeSpec::Kind::UNIFORM) {
+            size = uniform(rng);
+        } else if (options.size.kind == SizeSpec::Kind::EXPONENTIAL) {
+            size = std::clamp<size_t>(static_cast<size_t>(exponential(rng)), 1,
+                                      options.size.max);
+        }
+
+        waitUntil(intended);
+        const auto submitted = Clock::now();
+        const bool measured = intended >= measure_from;
+        if (measured) {
+            ++connection.submitted;
+            if (submitted - intended > LATE_THRESHOLD) {
+                ++connection.late;
+            }
+        }
+
+        const MessageView msg{options.type, options.subtype,
+                              std::string_view(payload.data(), size)};
+        const auto on_reply = [&connection, intended, submitted, measured](
+                                  const SendResult& result) {
+            if (!measured) {
+                return;
+            }
+            const auto replied = Clock::now();
+            std::lock_guard<std::mutex> lock(connection.mutex);
+            if (!result.ok() && result.error == ETIMEDOUT) {
+                ++connection.timeouts;
+                return;
+            }
+            if (!result.ok() || result.status != EOK) {
+                ++connection.errors;
+                return;
+            }
+            connection.latency.record(elapsedNs(intended, replied));
+            connection.service.record(elapsedNs(submitted, replied));
+        };
+
+        const auto deadline = (options.deadline.count() > 0)
+            ? intended + options.deadline : NO_DEADLINE;
+        if (!options.flow_control) {
+            connection.sender.sendAsync(msg, on_reply, std::nullopt, deadline);
+        } else if (connection.sender.trySendAsync(msg, on_reply, std::nullopt, deadline) != EOK &&
+                   measured) {
+            std::lock_guard<std::mutex> lock(connection.mutex);
+            ++connection.shed;
+        }
+    }
+
+    connection.sender.flushPipeline();
+}
+
+void printUsage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [-r rate[,rate...]] [-a constant|poisson] [-s size]"
+        " [-c connections] [-W window] [-d seconds] [-w warmup] [-n name]"
+        " [-l lane] [-t type] [-u subtype] [-F] [-D deadline_us]\n"
+        "  -r  Total target messages/sec; a list runs each rate in turn\n"
+        "      (default 1000)\n"
+        "  -a  Arrival process (default constant)\n"
+        "  -s  Payload bytes: N, MIN-MAX (uniform) or exp:MEAN (default 64)\n"
+        "  -c  Concurrent connections, each its own MessageSender (default 1)\n"
+        "  -W  Requests in flight per connection (default 16)\n"
+        "  -d  Measured seconds per rate (default 10)\n"
+        "  -w  Unmeasured warm-up seconds per rate (default 1)\n"
+        "  -n  Receiver name (default %s)\n"
+        "  -l  Receiver lane suffix\n"
+        "  -t  Message type, -u subtype (default 1/1, opaque data)\n"
+        "  -F  Use the receiver's flow control; shed arrivals with no credit\n"
+        "  -D  Give up on a message this long after its intended time\n",
+        prog, DEFAULT_RECEIVER);
+}
+
+double toUs(uint64_t ns) {
+    return ns / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:a:s:c:W:d:w:n:l:t:u:FD:")) != -1) {
+        switch (opt) {
+            case 'r': options.rates = parseRates(optarg); break;
+            case 'a':
+                if (std::strcmp(optarg, "poisson") == 0) {
+                    options.arrivals = Arrivals::POISSON;
+                } else if (std::strcmp(optarg, "constant") != 0) {
+                    printUsage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's': {
+                const auto size = parseSize(optarg);
+                if (!size) {
+                    std::fprintf(stderr, "Error: Invalid payload size '%s'\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                options.size = *size;
+                break;
+            }
+            case 'c': options.connections = std::strtoul(optarg, nullptr, 0); break;
+            case 'W': options.window = std::strtoul(optarg, nullptr, 0); break;
+            case 'd': options.seconds = std::strtod(optarg, nullptr); break;
+            case 'w': options.warmup = std::strtod(optarg, nullptr); break;
+            case 'n': options.receiver = optarg; break;
+            case 'l': options.lane = optarg; break;
+            case 't': options.type = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 0)); break;
+            case 'u': options.subtype = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 0)); break;
+            case 'F': options.flow_control = true; break;
+            case 'D':
+                options.deadline = std::chrono::microseconds(std::strtoul(optarg, nullptr, 0));
+                break;
+            default:
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (options.rates.empty() || options.connections == 0 || options.window == 0 ||
+        options.seconds <= 0 || options.warmup < 0) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::unique_ptr<Connection>> connections;
+    for (unsigned c = 0; c < options.connections; ++c) {
+        auto connection = std::make_unique<Connection>("LOADGEN" + std::to_string(c), options);
+        if (!connection->sender.connect() ||
+            (options.flow_control && !connection->sender.enableFlowControl()) ||
+            !connection->sender.startPipeline(options.window, options.lane)) {
+            return EXIT_FAILURE;
+        }
+        connections.push_back(std::move(connection));
+    }
+    BinaryLog::flush();
+
+    const std::string payload(options.size.max, 'x');
+
+    std::printf("# %u connections x %zu in flight, %s arrivals, %s\n",
+                options.connections, options.window,
+                options.arrivals == Arrivals::POISSON ? "Poisson" : "constant",
+                options.receiver.c_str());
+    std::printf("# latency is from the intended send time (corrected for coordinated"
+                " omission); svc = submit to reply\n");
+    std::printf("%10s %10s %8s %7s %7s %7s %10s %10s %10s %10s %10s %10s\n",
+                "target/s", "achieved/s", "errors", "late%", "shed%", "tmo%",
+                "p50 us", "p90 us", "p99 us", "p99.9 us", "max us", "svc p99 us");
+
+    uint64_t seed = static_cast<uint64_t>(Clock::now().time_since_epoch().count());
+
+    for (const double rate : options.rates) {
+        for (auto& connection : connections) {
+            connection->latency = LatencyHistogram();
+            connection->service = LatencyHistogram();
+            connection->errors = 0;
+            connection->timeouts = 0;
+            connection->late = 0;
+            connection->submitted = 0;
+            connection->shed = 0;
+        }
+
+        const auto start = Clock::now() + std::chrono::milliseconds(10);
+        const auto measure_from = start + std::chrono::duration_cast<Clock::duration>(
+                                              std::chrono::duration<double>(options.warmup));
+        const auto end = measure_from + std::chrono::duration_cast<Clock::duration>(
+                                            std::chrono::duration<double>(options.seconds));
+
+        std::vector<std::thread> schedulers;
+        for (auto& connection : connections) {
+            schedulers.emplace_back(runSchedule, std::ref(*connection), std::cref(options),
+                                    rate / options.connections, start, measure_from, end,
+                                    seed++, std::cref(payload));
+        }
+        for (auto& thread : schedulers) {
+            thread.join();
+        }
+        const double drained = std::chrono::duration<double>(Clock::now() - measure_from).count();
+
+        LatencyHistogram latency;
+        LatencyHistogram service;
+        uint64_t errors = 0;
+        uint64_t timeouts = 0;
+        uint64_t late = 0;
+        uint64_t submitted = 0;
+        uint64_t shed = 0;
+        for (const auto& connection : connections) {
+            latency.merge(connection->latency);
+            service.merge(connection->service);
+            errors += connection->errors;
+            timeouts += connection->timeouts;
+            late += connection->late;
+            submitted += connection->submitted;
+            shed += connection->shed;
+        }
+
+        // Replies per second until the last one arrived: falls below the
+        // target once the receiver saturates
+        std::printf("%10.0f %10.0f %8llu %7.2f %7.2f %7.2f %10.1f %10.1f %10.1f %10.1f %10.1f"
+                    " %10.1f\n",
+                    rate, latency.count() / std::max(drained, options.seconds),
+                    static_cast<unsigned long long>(errors),
+                    submitted ? 100.0 * late / submitted : 0.0,
+                    submitted ? 100.0 * shed / submitted : 0.0,
+                    submitted ? 100.0 * timeouts / submitted : 0.0,
+                    toUs(latency.percentile(50)), toUs(latency.percentile(90)),
+                    toUs(latency.percentile(99)), toUs(latency.percentile(99.9)),
+                    toUs(latency.max()), toUs(service.percentile(99)));
+        std::fflush(stdout);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,199 @@
+// pool_scaling.cpp
+// Worker pool scaling benchmark: messages/sec for 1..16 concurrent senders
+//
+// Senders and workers rendezvous through an in-process channel with the
+// same send/receive/reply blocking semantics as MsgSend/MsgReceive/MsgReply,
+// so the pool can be measured on the host without a QNX target.
+#include "thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Rendezvous channel: send() blocks until a worker replies
+ */
+class SimChannel {
+public:
+    struct Request {
+        int value = 0;
+        int status = 0;
+        bool replied = false;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    int send(int value) {
+        Request request;
+        request.value = value;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(&request);
+        }
+        cv_.notify_one();
+
+        std::unique_lock<std::mutex> lock(request.mutex);
+        request.cv.wait(lock, [&request] { return request.replied; });
+        return request.status;
+    }
+
+    // Returns nullptr once the channel is closed
+    Request* receive() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return nullptr;
+        }
+        Request* request = queue_.front();
+        queue_.pop_front();
+        return request;
+    }
+
+    static void reply(Request* request, int status) {
+        {
+            std::lock_guard<std::mutex> lock(request->mutex);
+            request->status = status;
+            request->replied = true;
+        }
+        request->cv.notify_one();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request*> queue_;
+    bool closed_ = false;
+};
+
+class SimWorker : public qnx::ipc::PoolWorker {
+public:
+    SimWorker(SimChannel& channel, std::chrono::nanoseconds work) noexcept
+        : channel_(channel), work_(work) {}
+
+    bool block() override {
+        request_ = channel_.receive();
+        return request_ != nullptr;
+    }
+
+    void handle() override {
+        // Stand-in for handler cost: busy for the configured duration
+        const auto until = Clock::now() + work_;
+        while (Clock::now() < until) {
+        }
+        SimChannel::reply(request_, request_->value);
+    }
+
+private:
+    SimChannel& channel_;
+    std::chrono::nanoseconds work_;
+    SimChannel::Request* request_ = nullptr;
+};
+
+struct Result {
+    double msgs_per_sec;
+    unsigned peak_threads;
+};
+
+Result measure(const qnx::ipc::ThreadPoolConfig& config, int senders,
+               std::chrono::milliseconds duration,
+               std::chrono::nanoseconds work) {
+    SimChannel channel;
+    qnx::ipc::ThreadPool pool(
+        config,
+        [&channel, work] {
+            return std::make_unique<SimWorker>(channel, work);
+        },
+        [&channel] { channel.close(); });
+    pool.start();
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> total{0};
+    std::vector<std::thread> threads;
+
+    for (int s = 0; s < senders; ++s) {
+        threads.emplace_back([&channel, &running, &total] {
+            uint64_t count = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                channel.send(static_cast<int>(count));
+                ++count;
+            }
+            total += count;
+        });
+    }
+
+    const auto start = Clock::now();
+    std::this_thread::sleep_for(duration);
+    running = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    const unsigned peak = pool.stats().peak_threads;
+    channel.close();
+    pool.wait();
+
+    return Result{static_cast<double>(total.load()) / elapsed.count(), peak};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto duration = std::chrono::milliseconds(1000);
+    auto work = std::chrono::nanoseconds(5000);
+    int max_senders = 16;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:w:n:")) != -1) {
+        switch (opt) {
+            case 'd': duration = std::chrono::milliseconds(std::atoi(optarg)); break;
+            case 'w': work = std::chrono::nanoseconds(std::atoi(optarg)); break;
+            case 'n': max_senders = std::atoi(optarg); break;
+            default:
+                std::fprintf(stderr,
+                             "Usage: %s [-d duration_ms] [-w work_ns]"
+                             " [-n max_senders]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    // Single-threaded receiver vs. the default pool watermarks
+    const qnx::ipc::ThreadPoolConfig single{1, 1, 1, 1};
+    const qnx::ipc::ThreadPoolConfig pooled{};
+
+    std::printf("handler work: %lld ns, %lld ms per point\n",
+                static_cast<long long>(work.count()),
+                static_cast<long long>(duration.count()));
+    std::printf("%8s %16s %16s %8s %8s\n",
+                "senders", "single msg/s", "pool msg/s", "speedup", "threads");
+
+    for (int senders = 1; senders <= max_senders; senders *= 2) {
+        const Result one = measure(single, senders, duration, work);
+        const Result many = measure(pooled, senders, duration, work);
+        std::printf("%8d %16.0f %16.0f %7.2fx %8u\n",
+                    senders, one.msgs_per_sec, many.msgs_per_sec,
+                    many.msgs_per_sec / one.msgs_per_sec, many.peak_threads);
+    }
+
+    return EXIT_SUCCESS;
+}
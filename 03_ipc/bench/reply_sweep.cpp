@@ -0,0 +1,241 @@
+// reply_sweep.cpp
+// Request/response round trips over a sweep of reply payload sizes
+//
+// A forked receiver answers each request with as many bytes as it asks
+// for, taken from a table it keeps in memory, in one of two ways:
+//
+// gather: the table bytes are appended to the reply as they are
+//         (ReplyPayload::append); the kernel copies them once, straight
+//         into the sender's buffer.
+// copy:   the handler first copies them into a pooled reply buffer
+//         (ReplyPayload::allocate), as a server building its reply in a
+//         message buffer would, and that buffer is replied.
+//
+// The client receives each reply into one buffer of its own with
+// MessageSender::request() and reports the round trip (p50/p99) and the
+// reply bandwidth per size.
+#include "binary_log.h"
+#include "latency_histogram.h"
+#include "message.h"
+#include "message_dispatcher.h"
+#include "message_sender.h"
+#include "secure_message_receiver.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace qnx::ipc;
+
+constexpr uint16_t MSG_TYPE_SWEEP = 1;
+constexpr uint16_t SUBTYPE_GATHER = 1;
+constexpr uint16_t SUBTYPE_COPY = 2;
+
+// Reply sizes, smallest to largest
+constexpr size_t SIZES[] = {
+    0, 64, 256, 1024, 4 * 1024, 16 * 1024, 64 * 1024,
+    256 * 1024, 1024 * 1024, 4 * 1024 * 1024
+};
+constexpr size_t LARGEST = SIZES[sizeof(SIZES) / sizeof(SIZES[0]) - 1];
+
+struct Options {
+    unsigned iterations = 2000;     // Round trips per size and mode
+    size_t max_size = LARGEST;
+};
+
+// Receiver side: the bytes replies are made of
+std::vector<char> table;
+
+// Reads the requested reply size from the payload
+bool requestedSize(std::string_view payload, uint32_t& size) {
+    if (payload.size() != sizeof(size)) {
+        return false;
+    }
+    std::memcpy(&size, payload.data(), sizeof(size));
+    return size <= table.size();
+}
+
+int handleGather(const MessageContext& ctx, std::string_view payload) {
+    uint32_t size = 0;
+    if (!requestedSize(payload, size)) {
+        return EINVAL;
+    }
+    if (size > 0 && !ctx.reply->append(std::string_view(table.data(), size))) {
+        return ENOMEM;
+    }
+    return EOK;
+}
+
+int handleCopy(const MessageContext& ctx, std::string_view payload) {
+    uint32_t size = 0;
+    if (!requestedSize(payload, size)) {
+        return EINVAL;
+    }
+    if (size > 0) {
+        char* const out = ctx.reply->allocate(size);
+        if (out == nullptr) {
+            return ENOMEM;
+        }
+        std::memcpy(out, table.data(), size);
+    }
+    return EOK;
+}
+
+using Dispatcher = MessageDispatcher<
+    Route<MSG_TYPE_SWEEP, SUBTYPE_GATHER, &handleGather>,
+    Route<MSG_TYPE_SWEEP, SUBTYPE_COPY, &handleCopy>>;
+
+// Child process: a single-threaded receiver serving the sweep
+[[noreturn]] void runReceiver(const std::string& name, size_t max_size, int ready_fd) {
+    LogConfig log_config{};
+    log_config.output = LogOutput::FILE;
+    log_config.path = "/dev/null";
+    BinaryLog::start(log_config);
+
+    table.resize(max_size);
+    for (size_t i = 0; i < table.size(); ++i) {
+        table[i] = static_cast<char>(i);
+    }
+
+    SecureMessageReceiver receiver(name, std::nullopt);
+    receiver.setMessageDispatch(&Dispatcher::dispatch);
+    if (!receiver.initialize()) {
+        _exit(EXIT_FAILURE);
+    }
+    const char ready = 1;
+    (void)::write(ready_fd, &ready, 1);
+    ::close(ready_fd);
+
+    receiver.run();
+    _exit(EXIT_SUCCESS);
+}
+
+struct SweepResult {
+    LatencyHistogram rtt;
+    double mb_per_sec;
+    uint64_t errors;
+};
+
+SweepResult measure(MessageSender& sender, uint16_t subtype, uint32_t size,
+                    std::vector<char>& buffer, unsigned iterations) {
+    SweepResult result{LatencyHistogram(), 0, 0};
+    const MessageView msg{MSG_TYPE_SWEEP, subtype,
+                          std::string_view(reinterpret_cast<const char*>(&size), sizeof(size))};
+
+    // Warm-up: pool buffers, page faults in the reply buffer
+    int status = 0;
+    for (unsigned i = 0; i < 16; ++i) {
+        (void)sender.request(msg, buffer.data(), buffer.size(), status);
+    }
+
+    const auto start = Clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        const auto sent = Clock::now();
+        const auto reply = sender.request(msg, buffer.data(), buffer.size(), status);
+        const auto received = Clock::now();
+        if (!reply || status != EOK || reply->size() != size) {
+            ++result.errors;
+            continue;
+        }
+        result.rtt.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(received - sent).count()));
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    result.mb_per_sec = static_cast<double>(size) * static_cast<double>(result.rtt.count())
+                        / elapsed.count() / (1024.0 * 1024.0);
+    return result;
+}
+
+bool runSweep(const std::string& name, const Options& options) {
+    MessageSender sender("REPLYSWEEP", name);
+    if (!sender.connect()) {
+        return false;
+    }
+    BinaryLog::flush();     // The connect banner goes out before the table
+    std::vector<char> buffer(options.max_size);
+
+    std::printf("%10s %8s %10s %10s %10s %8s\n",
+                "reply B", "mode", "p50 us", "p99 us", "MB/s", "errors");
+    for (const size_t size : SIZES) {
+        if (size > options.max_size) {
+            break;
+        }
+        // Fewer round trips for the megabyte replies
+        const unsigned iterations = std::max(
+            16u, static_cast<unsigned>(std::min<size_t>(
+                     options.iterations, options.iterations * 64 * 1024 / std::max<size_t>(
+                                                                    size, 1))));
+        for (const uint16_t subtype : {SUBTYPE_GATHER, SUBTYPE_COPY}) {
+            const SweepResult result = measure(sender, subtype, static_cast<uint32_t>(size),
+                                               buffer, iterations);
+            std::printf("%10zu %8s %10.1f %10.1f %10.0f %8llu\n", size,
+                        subtype == SUBTYPE_GATHER ? "gather" : "copy",
+                        static_cast<double>(result.rtt.percentile(50)) / 1000.0,
+                        static_cast<double>(result.rtt.percentile(99)) / 1000.0,
+                        result.mb_per_sec, static_cast<unsigned long long>(result.errors));
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:m:")) != -1) {
+        switch (opt) {
+            case 'n': options.iterations = std::strtoul(optarg, nullptr, 0); break;
+            case 'm': options.max_size = std::strtoul(optarg, nullptr, 0); break;
+            default:
+                std::fprintf(stderr, "Usage: %s [-n iterations] [-m max_reply_bytes]\n",
+                             argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (options.iterations == 0 || options.max_size > LARGEST) {
+        return EXIT_FAILURE;
+    }
+
+    // A name of our own, so a running receiver is left alone
+    const std::string name = "reply_sweep_" + std::to_string(getpid());
+    int ready[2];
+    if (::pipe(ready) == -1) {
+        return EXIT_FAILURE;
+    }
+    const pid_t child = ::fork();
+    if (child == -1) {
+        std::fprintf(stderr, "Error: fork failed: %s\n", std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (child == 0) {
+        ::close(ready[0]);
+        runReceiver(name, options.max_size, ready[1]);
+    }
+    ::close(ready[1]);
+
+    char byte;
+    const bool attached = (::read(ready[0], &byte, 1) == 1);
+    ::close(ready[0]);
+    bool ok = false;
+    if (attached) {
+        ok = runSweep(name, options);
+        BinaryLog::flush();
+    }
+
+    ::kill(child, SIGTERM);
+    ::waitpid(child, nullptr, 0);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,222 @@
+// ring_vs_sync.cpp
+// Shared ring vs. synchronous MsgSend: messages/sec and one-way latency
+//
+// Producer and consumer run as two threads on a private channel, so the
+// numbers reflect the transport (two context switches per message for
+// MsgSend/MsgReply vs. a memory ring plus occasional doorbell pulses)
+// rather than any message handler.
+#include "message.h"
+#include "shared_ring_channel.h"
+#include "transport.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sched.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using qnx::ipc::MessageHeader;
+using qnx::ipc::MessageView;
+using qnx::ipc::SharedRingChannel;
+using qnx::ipc::ReceiveInfo;
+
+constexpr uint16_t BENCH_TYPE = 1;
+
+struct Result {
+    double msgs_per_sec;
+    std::vector<uint64_t> latency_ns;
+};
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count());
+}
+
+uint64_t latencySince(std::string_view payload) {
+    uint64_t sent;
+    std::memcpy(&sent, payload.data(), sizeof(sent));
+    return nowNs() - sent;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+// Private channel plus a connection to it; exits if either fails
+std::pair<std::unique_ptr<qnx::ipc::ServerChannel>, std::unique_ptr<qnx::ipc::ClientConnection>>
+openChannel() {
+    auto channel = qnx::ipc::createChannel();
+    auto connection = channel ? channel->connectSelf() : nullptr;
+    if (!connection) {
+        std::fprintf(stderr, "Error: Cannot create bench channel: %s\n",
+                     std::strerror(errno));
+        std::exit(EXIT_FAILURE);
+    }
+    return {std::move(channel), std::move(connection)};
+}
+
+Result runSync(int count, size_t payload_size) {
+    auto [channel, connection] = openChannel();
+
+    Result result;
+    result.latency_ns.reserve(count);
+
+    std::thread consumer([&result, &channel = *channel, count] {
+        std::vector<char> buffer(sizeof(MessageHeader) + qnx::ipc::MAX_PAYLOAD_SIZE);
+        ReceiveInfo info;
+        for (int i = 0; i < count; ++i) {
+            const int rcvid = channel.receive(buffer.data(), buffer.size(), info);
+            if (rcvid <= 0) {
+                --i;
+                continue;
+            }
+            result.latency_ns.push_back(latencySince(
+                std::string_view(buffer.data() + sizeof(MessageHeader), sizeof(uint64_t))));
+            int status = 0;
+            const iovec reply{&status, sizeof(status)};
+            channel.reply(rcvid, 0, &reply, 1);
+        }
+    });
+
+    std::string payload(payload_size, 'x');
+    MessageHeader header{BENCH_TYPE, 0, static_cast<uint32_t>(payload.size())};
+    const iovec iov[2] = {
+        {&header, sizeof(header)},
+        {payload.data(), payload.size()}
+    };
+
+    const auto start = Clock::now();
+    for (int i = 0; i < count; ++i) {
+        const uint64_t sent = nowNs();
+        std::memcpy(payload.data(), &sent, sizeof(sent));
+        int status;
+        const iovec reply{&status, sizeof(status)};
+        connection->send(iov, 2, &reply, 1);
+    }
+    consumer.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    result.msgs_per_sec = count / elapsed.count();
+    return result;
+}
+
+Result runRing(int count, size_t payload_size, uint32_t capacity) {
+    auto [channel, connection] = openChannel();
+
+    uint64_t handle = 0;
+    auto consumer_ring = SharedRingChannel::create(capacity, getpid(), handle);
+    auto producer_ring = consumer_ring
+        ? SharedRingChannel::open(handle, consumer_ring->capacity())
+        : std::nullopt;
+    if (!producer_ring) {
+        std::fprintf(stderr, "Error: Cannot set up shared ring\n");
+        std::exit(EXIT_FAILURE);
+    }
+    if (payload_size > producer_ring->maxPayload()) {
+        std::fprintf(stderr, "Error: Payload exceeds ring limit (%zu bytes)\n",
+                     producer_ring->maxPayload());
+        std::exit(EXIT_FAILURE);
+    }
+
+    Result result;
+    result.latency_ns.reserve(count);
+
+    std::thread consumer([&result, &consumer_ring, &channel = *channel, count] {
+        const auto record = [&result](const MessageView& msg) {
+            result.latency_ns.push_back(latencySince(msg.payload));
+        };
+        std::array<char, 64> buffer;
+        ReceiveInfo info;
+        while (static_cast<int>(result.latency_ns.size()) < count) {
+            if (channel.receive(buffer.data(), buffer.size(), info) != 0) {
+                continue;
+            }
+            // Same idle protocol as SecureMessageReceiver::drainRing()
+            do {
+                consumer_ring->setConsumerIdle(false);
+                consumer_ring->drain(SIZE_MAX, record);
+                consumer_ring->setConsumerIdle(true);
+            } while (!consumer_ring->empty());
+        }
+    });
+
+    std::string payload(payload_size, 'x');
+    const auto start = Clock::now();
+    for (int i = 0; i < count; ++i) {
+        const uint64_t sent = nowNs();
+        std::memcpy(payload.data(), &sent, sizeof(sent));
+        const MessageView msg{BENCH_TYPE, 0, payload};
+
+        bool wake_consumer = false;
+        while (!producer_ring->tryPush(msg, wake_consumer)) {
+            sched_yield();
+        }
+        if (wake_consumer) {
+            connection->sendPulse(qnx::ipc::PULSE_CODE_RING_DOORBELL, 0);
+        }
+    }
+    consumer.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    result.msgs_per_sec = count / elapsed.count();
+    return result;
+}
+
+void report(const char* name, Result& result) {
+    std::sort(result.latency_ns.begin(), result.latency_ns.end());
+    std::printf("%-6s %14.0f %10llu %10llu %10llu\n", name, result.msgs_per_sec,
+                static_cast<unsigned long long>(percentile(result.latency_ns, 0.50)),
+                static_cast<unsigned long long>(percentile(result.latency_ns, 0.99)),
+                static_cast<unsigned long long>(result.latency_ns.back()));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = 100000;
+    size_t payload_size = 64;
+    uint32_t capacity = qnx::ipc::DEFAULT_RING_CAPACITY;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:c:")) != -1) {
+        switch (opt) {
+            case 'n': count = std::atoi(optarg); break;
+            case 's': payload_size = std::strtoul(optarg, nullptr, 0); break;
+            case 'c': capacity = std::strtoul(optarg, nullptr, 0); break;
+            default:
+                std::fprintf(stderr, "Usage: %s [-n count] [-s payload_bytes]"
+                                     " [-c ring_capacity]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    payload_size = std::max(payload_size, sizeof(uint64_t));
+
+    std::printf("%d messages, %zu byte payload\n", count, payload_size);
+    std::printf("%-6s %14s %10s %10s %10s\n",
+                "path", "msg/s", "p50 ns", "p99 ns", "max ns");
+
+    Result sync = runSync(count, payload_size);
+    report("sync", sync);
+
+    Result ring = runRing(count, payload_size, capacity);
+    report("ring", ring);
+
+    return EXIT_SUCCESS;
+}
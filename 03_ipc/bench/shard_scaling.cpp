@@ -0,0 +1,223 @@
+// shard_scaling.cpp
+// Sharded receiver benchmark: aggregate messages/sec over 1..N receiver shards
+//
+// Each shard is a child process attached as <name>.<i> that handles one
+// message at a time, at a fixed cost per message, so a single shard tops
+// out at 1/work messages/sec. The parent routes MessageSender::sendRouted()
+// traffic over the shards with a different key per message and a few
+// sender threads per shard. Throughput should grow with the shard count
+// until the CPUs run out; with -b the handlers block instead of spinning
+// (like a handler waiting on a device) and scaling does not depend on the
+// number of CPUs.
+#include "binary_log.h"
+#include "message.h"
+#include "message_sender.h"
+#include "transport.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace qnx::ipc;
+
+struct Options {
+    std::chrono::milliseconds duration{1000};
+    std::chrono::microseconds work{50};
+    unsigned max_shards = 8;
+    unsigned senders = 2;               // Sender threads per shard
+    bool blocking = false;              // Handlers sleep instead of spinning
+};
+
+// Child process: one receive thread, replies EOK after the handler cost
+[[noreturn]] void runShard(const std::string& name, const Options& options, int ready_fd) {
+    const auto channel = attachChannel(name);
+    if (!channel) {
+        std::fprintf(stderr, "Error: Cannot attach %s: %s\n", name.c_str(), std::strerror(errno));
+        _exit(EXIT_FAILURE);
+    }
+    const char ready = 1;
+    (void)::write(ready_fd, &ready, 1);
+    ::close(ready_fd);
+
+    alignas(MessageHeader) char buffer[sizeof(MessageHeader) + 256];
+    for (;;) {
+        ReceiveInfo info{};
+        const int rcvid = channel->receive(buffer, sizeof(buffer), info);
+        if (rcvid == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            _exit(EXIT_FAILURE);
+        }
+        if (rcvid == 0) {
+            continue;   // Disconnect pulses
+        }
+
+        if (options.blocking) {
+            std::this_thread::sleep_for(options.work);
+        } else {
+            const auto until = Clock::now() + options.work;
+            while (Clock::now() < until) {
+            }
+        }
+        (void)channel->reply(rcvid, EOK, nullptr, 0);
+    }
+}
+
+struct Result {
+    double msgs_per_sec;
+    uint64_t errors;
+};
+
+bool startShards(const std::string& base, unsigned shards, const Options& options,
+                 std::vector<pid_t>& children) {
+    int ready[2];
+    if (::pipe(ready) == -1) {
+        return false;
+    }
+    for (unsigned i = 0; i < shards; ++i) {
+        const pid_t pid = ::fork();
+        if (pid == -1) {
+            std::fprintf(stderr, "Error: fork failed: %s\n", std::strerror(errno));
+            break;
+        }
+        if (pid == 0) {
+            ::close(ready[0]);
+            runShard(base + "." + std::to_string(i), options, ready[1]);
+        }
+        children.push_back(pid);
+    }
+    ::close(ready[1]);
+
+    // One byte per shard once its name is attached
+    size_t attached = 0;
+    char byte;
+    while (attached < children.size() && ::read(ready[0], &byte, 1) == 1) {
+        ++attached;
+    }
+    ::close(ready[0]);
+    return attached == shards;
+}
+
+void stopShards(std::vector<pid_t>& children) {
+    for (const pid_t pid : children) {
+        ::kill(pid, SIGTERM);
+    }
+    for (const pid_t pid : children) {
+        ::waitpid(pid, nullptr, 0);
+    }
+    children.clear();
+}
+
+Result measure(const std::string& base, unsigned shards, const Options& options) {
+    MessageSender sender("SHARDBENCH", base);
+    if (!sender.connectShards(shards) || sender.liveShards() != shards) {
+        return Result{0, 0};
+    }
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> errors{0};
+    std::vector<std::thread> threads;
+
+    const unsigned thread_count = options.senders * shards;
+    for (unsigned t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            const char payload[64] = {};
+            const MessageView msg{1, 1, std::string_view(payload, sizeof(payload))};
+            uint64_t count = 0;
+            uint64_t failed = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                int status = 0;
+                const uint64_t key = count * thread_count + t;
+                if (sender.sendRouted(msg, key, status)) {
+                    ++count;
+                } else {
+                    ++failed;
+                }
+            }
+            total += count;
+            errors += failed;
+        });
+    }
+
+    const auto start = Clock::now();
+    std::this_thread::sleep_for(options.duration);
+    running = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    return Result{static_cast<double>(total.load()) / elapsed.count(), errors.load()};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:w:n:s:b")) != -1) {
+        switch (opt) {
+            case 'd': options.duration = std::chrono::milliseconds(std::atoi(optarg)); break;
+            case 'w': options.work = std::chrono::microseconds(std::atoi(optarg)); break;
+            case 'n': options.max_shards = std::strtoul(optarg, nullptr, 0); break;
+            case 's': options.senders = std::strtoul(optarg, nullptr, 0); break;
+            case 'b': options.blocking = true; break;
+            default:
+                std::fprintf(stderr,
+                             "Usage: %s [-d duration_ms] [-w work_us] [-n max_shards]"
+                             " [-s senders_per_shard] [-b]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (options.max_shards == 0 || options.senders == 0) {
+        return EXIT_FAILURE;
+    }
+
+    // A name of our own, so a running receiver's shards are left alone
+    const std::string base = "shard_scaling_" + std::to_string(getpid());
+
+    std::printf("handler work: %lld us (%s), %u senders per shard, %lld ms per point, %u CPUs\n",
+                static_cast<long long>(options.work.count()),
+                options.blocking ? "blocking" : "spinning", options.senders,
+                static_cast<long long>(options.duration.count()),
+                std::thread::hardware_concurrency());
+    std::printf("%8s %12s %12s %8s %10s %8s\n",
+                "shards", "msg/s", "per shard", "speedup", "efficiency", "errors");
+
+    double single = 0;
+    for (unsigned shards = 1; shards <= options.max_shards; shards *= 2) {
+        std::vector<pid_t> children;
+        if (!startShards(base, shards, options, children)) {
+            stopShards(children);
+            return EXIT_FAILURE;
+        }
+        const Result result = measure(base, shards, options);
+        stopShards(children);
+        BinaryLog::flush();
+
+        if (shards == 1) {
+            single = result.msgs_per_sec;
+        }
+        const double speedup = (single > 0) ? result.msgs_per_sec / single : 0;
+        std::printf("%8u %12.0f %12.0f %7.2fx %9.0f%% %8llu\n",
+                    shards, result.msgs_per_sec, result.msgs_per_sec / shards, speedup,
+                    100.0 * speedup / shards, static_cast<unsigned long long>(result.errors));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+// shm_vs_copy.cpp
+// Large payloads: copied through the kernel vs passed as shared memory
+//
+// A forked receiver reads every cache line of each payload it is sent.
+// The client sends payloads of 64 KB to 64 MB three ways:
+//
+// copy:     sendMessage(); the kernel copies the payload from the
+//           client into the receiver's buffer (up to MAX_PAYLOAD_SIZE).
+// shm:      allocateShared() + sendShared() from the pooled segments; only
+//           a ShmPayloadHeader is copied, and the receiver reads the
+//           segment it mapped when the first message in it arrived.
+// one-shot: the same with no pooling (setSharedSegments(0)), so every
+//           message creates, maps and unmaps a segment on both sides.
+//
+// Reports effective GB/s (payload bytes per second of round trips) and
+// the median round trip. -w also writes the whole payload before every
+// send, as a producer filling each frame would.
+#include "binary_log.h"
+#include "latency_histogram.h"
+#include "message.h"
+#include "message_dispatcher.h"
+#include "message_sender.h"
+#include "secure_message_receiver.h"
+#include "shm_segment.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace qnx::ipc;
+
+constexpr uint16_t MSG_TYPE_FRAME = 1;
+constexpr uint16_t SUBTYPE_FRAME = 1;
+
+// Payload sizes, smallest to largest
+constexpr size_t SIZES[] = {
+    64 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024,
+    8 * 1024 * 1024, 16 * 1024 * 1024, 64 * 1024 * 1024
+};
+
+enum class Mode { COPY, SHM, ONE_SHOT };
+
+struct Options {
+    std::chrono::milliseconds duration{500};    // Per size and mode
+    bool write = false;                         // Fill the payload before each send
+};
+
+// Receiver side: read one byte per cache line, as a consumer would
+volatile uint64_t checksum = 0;
+
+int handleFrame(const MessageContext&, std::string_view payload) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < payload.size(); i += 64) {
+        sum += static_cast<unsigned char>(payload[i]);
+    }
+    checksum = checksum + sum;
+    return EOK;
+}
+
+using Dispatcher = MessageDispatcher<Route<MSG_TYPE_FRAME, SUBTYPE_FRAME, &handleFrame>>;
+
+// Child process: a single-threaded receiver
+[[noreturn]] void runReceiver(const std::string& name, int ready_fd) {
+    LogConfig log_config{};
+    log_config.output = LogOutput::FILE;
+    log_config.path = "/dev/null";
+    BinaryLog::start(log_config);
+
+    SecureMessageReceiver receiver(name, std::nullopt);
+    receiver.setMessageDispatch(&Dispatcher::dispatch);
+    if (!receiver.initialize()) {
+        _exit(EXIT_FAILURE);
+    }
+    const char ready = 1;
+    (void)::write(ready_fd, &ready, 1);
+    ::close(ready_fd);
+
+    receiver.run();
+    _exit(EXIT_SUCCESS);
+}
+
+struct Result {
+    double gb_per_sec;
+    double p50_us;
+    uint64_t errors;
+};
+
+// One round trip in the given mode; false if it failed
+bool sendOne(MessageSender& sender, Mode mode, size_t size, std::vector<char>& buffer,
+             bool write, uint8_t fill) {
+    int status = 0;
+    if (mode == Mode::COPY) {
+        if (write) {
+            std::memset(buffer.data(), fill, size);
+        }
+        const MessageView msg{MSG_TYPE_FRAME, SUBTYPE_FRAME,
+                              std::string_view(buffer.data(), size)};
+        return sender.sendMessage(msg, status) && status == EOK;
+    }
+
+    ShmPayload payload = sender.allocateShared(size);
+    if (!payload) {
+        return false;
+    }
+    if (write) {
+        std::memset(payload.data(), fill, size);
+    }
+    return sender.sendShared(MSG_TYPE_FRAME, SUBTYPE_FRAME, std::move(payload), size,
+                             status) && status == EOK;
+}
+
+Result measure(MessageSender& sender, Mode mode, size_t size, std::vector<char>& buffer,
+               const Options& options) {
+    sender.setSharedSegments(mode == Mode::ONE_SHOT ? 0 : DEFAULT_POOLED_SEGMENTS);
+    LatencyHistogram rtt;
+    uint64_t errors = 0;
+
+    // Warm-up: the pool's segment, the receiver's buffer and mapping
+    for (int i = 0; i < 4; ++i) {
+        (void)sendOne(sender, mode, size, buffer, true, 0);
+    }
+
+    uint8_t fill = 0;
+    const auto start = Clock::now();
+    const auto end = start + options.duration;
+    auto now = start;
+    while (now < end) {
+        const bool ok = sendOne(sender, mode, size, buffer, options.write, ++fill);
+        const auto replied = Clock::now();
+        if (ok) {
+            rtt.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(replied - now).count()));
+        } else {
+            ++errors;
+        }
+        now = replied;
+    }
+    const std::chrono::duration<double> elapsed = now - start;
+    return Result{
+        static_cast<double>(size) * static_cast<double>(rtt.count()) / elapsed.count() / 1e9,
+        static_cast<double>(rtt.percentile(50)) / 1000.0,
+        errors
+    };
+}
+
+bool runComparison(const std::string& name, const Options& options) {
+    MessageSender sender("SHMBENCH", name);
+    if (!sender.connect()) {
+        return false;
+    }
+    BinaryLog::flush();     // The connect banner goes out before the table
+    std::vector<char> buffer(MAX_PAYLOAD_SIZE);
+
+    std::printf("%10s %12s %12s %12s %12s %12s %12s\n", "payload KB",
+                "copy GB/s", "shm GB/s", "1-shot GB/s", "copy p50 us", "shm p50 us",
+                "1-shot p50");
+    uint64_t errors = 0;
+    ShmPoolStats pooled{0, 0, 0, 0};
+    for (const size_t size : SIZES) {
+        std::printf("%10zu ", size / 1024);
+        Result copy{0, 0, 0};
+        const bool copied = size <= MAX_PAYLOAD_SIZE;
+        if (copied) {
+            copy = measure(sender, Mode::COPY, size, buffer, options);
+        }
+        const Result shm = measure(sender, Mode::SHM, size, buffer, options);
+        const ShmPoolStats stats = sender.sharedStats();
+        pooled.created += stats.created;
+        pooled.reused += stats.reused;
+        const Result one_shot = measure(sender, Mode::ONE_SHOT, size, buffer, options);
+        if (copied) {
+            std::printf("%12.2f ", copy.gb_per_sec);
+        } else {
+            std::printf("%12s ", "-");
+        }
+        std::printf("%12.2f %12.2f ", shm.gb_per_sec, one_shot.gb_per_sec);
+        if (copied) {
+            std::printf("%12.0f ", copy.p50_us);
+        } else {
+            std::printf("%12s ", "-");
+        }
+        std::printf("%12.0f %12.0f\n", shm.p50_us, one_shot.p50_us);
+        errors += copy.errors + shm.errors + one_shot.errors;
+    }
+
+    std::printf("\n%llu errors; shm runs created %llu segments and reused them %llu times\n",
+                static_cast<unsigned long long>(errors),
+                static_cast<unsigned long long>(pooled.created),
+                static_cast<unsigned long long>(pooled.reused));
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:w")) != -1) {
+        switch (opt) {
+            case 'd': options.duration = std::chrono::milliseconds(std::atoi(optarg)); break;
+            case 'w': options.write = true; break;
+            default:
+                std::fprintf(stderr, "Usage: %s [-d duration_ms] [-w]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (options.duration.count() <= 0) {
+        return EXIT_FAILURE;
+    }
+
+    // A name of our own, so a running receiver is left alone
+    const std::string name = "shm_vs_copy_" + std::to_string(getpid());
+    int ready[2];
+    if (::pipe(ready) == -1) {
+        return EXIT_FAILURE;
+    }
+    const pid_t child = ::fork();
+    if (child == -1) {
+        std::fprintf(stderr, "Error: fork failed: %s\n", std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (child == 0) {
+        ::close(ready[0]);
+        runReceiver(name, ready[1]);
+    }
+    ::close(ready[1]);
+
+    char byte;
+    const bool attached = (::read(ready[0], &byte, 1) == 1);
+    ::close(ready[0]);
+    bool ok = false;
+    if (attached) {
+        ok = runComparison(name, options);
+        BinaryLog::flush();
+    }
+
+    ::kill(child, SIGTERM);
+    ::waitpid(child, nullptr, 0);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
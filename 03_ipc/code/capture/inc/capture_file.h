@@ -0,0 +1,179 @@
+// capture_file.h
+// Append-only capture of received IPC traffic in a memory-mapped file - Header
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include "message.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace qnx::ipc {
+
+/// Default size limit of a capture file; recording stops when it is full
+constexpr size_t DEFAULT_CAPTURE_BYTES = 256 * 1024 * 1024;
+
+/// Records start on this boundary
+constexpr size_t CAPTURE_RECORD_ALIGN = 8;
+
+/**
+ * @brief What a capture record holds
+ */
+enum class CaptureKind : uint16_t {
+    MESSAGE = 1,    // MsgSend() request: header and payload as received
+    RING_RECORD,    // Record drained from a shared ring (no reply)
+    PULSE           // header.type = pulse code, payload = 4-byte value
+};
+
+/**
+ * @brief Start of a capture file
+ */
+struct CaptureFileHeader {
+    static constexpr uint32_t MAGIC = 0x50435049;   // "IPCP"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t start_realtime_ns;     // Wall clock when recording started
+    uint64_t reserved[2];
+};
+
+/**
+ * @brief Header in front of every captured message
+ *
+ * Followed by header.size payload bytes, then padding to
+ * CAPTURE_RECORD_ALIGN. A length of 0 marks the end of the data.
+ */
+struct CaptureRecord {
+    uint32_t length;            // This header, payload and padding
+    uint16_t kind;              // CaptureKind
+    uint16_t reserved;
+    uint64_t timestamp_ns;      // Since recording started (monotonic)
+    int32_t pid;                // Sending process, 0 if unknown
+    int32_t scoid;              // Sender's connection on the receiver
+    MessageHeader header;
+};
+
+static_assert(sizeof(CaptureFileHeader) % CAPTURE_RECORD_ALIGN == 0,
+              "records must start aligned");
+static_assert(sizeof(CaptureRecord) % CAPTURE_RECORD_ALIGN == 0,
+              "payloads must start aligned");
+
+/**
+ * @brief Capture writer counters
+ */
+struct CaptureStats {
+    uint64_t records;
+    uint64_t bytes;
+    uint64_t dropped;           // Did not fit in the file any more
+};
+
+/**
+ * @brief Appends records to a file mapped into memory
+ *
+ * The file is sized to its limit up front (sparse) and mapped once, so
+ * appending is one atomic add to reserve space plus a memcpy, with no
+ * system call and no lock; any number of receive threads may append at
+ * once. Records from concurrent threads appear in reservation order, which
+ * can differ slightly from timestamp order. Once the file is full further
+ * records are dropped and counted. The destructor trims the file to the
+ * data actually written.
+ */
+class CaptureWriter {
+public:
+    /**
+     * @brief Create (or truncate) a capture file
+     * @param max_bytes File size limit, including the file header
+     * @return nullptr if the file cannot be created or mapped
+     */
+    static std::unique_ptr<CaptureWriter> create(const std::string& path,
+                                                 size_t max_bytes = DEFAULT_CAPTURE_BYTES);
+
+    ~CaptureWriter();
+
+    // Prevent copying and moving (appending threads hold a reference)
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * @brief Append one record
+     * @return false if the file is full
+     */
+    bool append(CaptureKind kind, int pid, int scoid, const MessageView& msg) noexcept;
+
+    [[nodiscard]] CaptureStats stats() const noexcept;
+
+private:
+    CaptureWriter(int fd, char* base, size_t capacity) noexcept;
+
+    int fd_;
+    char* base_;
+    size_t capacity_;
+    int64_t start_ns_;
+    std::atomic<size_t> next_;
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * @brief One record read back from a capture
+ */
+struct CaptureEntry {
+    CaptureKind kind;
+    uint64_t timestamp_ns;
+    int pid;
+    int scoid;
+    MessageView msg;    // Payload points into the mapped file
+};
+
+/**
+ * @brief Reads a capture file sequentially
+ *
+ * The file is mapped read-only; entries stay valid while the reader
+ * lives. Every length is bounds-checked, so a truncated file simply ends
+ * early.
+ */
+class CaptureReader {
+public:
+    /**
+     * @brief Map a capture file
+     * @return std::nullopt if it cannot be read or is not a capture
+     */
+    static std::optional<CaptureReader> open(const std::string& path);
+
+    CaptureReader(CaptureReader&& other) noexcept;
+    CaptureReader& operator=(CaptureReader&& other) = delete;
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    ~CaptureReader();
+
+    /**
+     * @brief Read the next record
+     * @return false at the end of the data
+     */
+    bool next(CaptureEntry& entry) noexcept;
+
+    /// Go back to the first record
+    void rewind() noexcept { offset_ = sizeof(CaptureFileHeader); }
+
+    [[nodiscard]] const CaptureFileHeader& header() const noexcept {
+        return *reinterpret_cast<const CaptureFileHeader*>(base_);
+    }
+
+private:
+    CaptureReader(const char* base, size_t size) noexcept;
+
+    const char* base_;
+    size_t size_;
+    size_t offset_;
+};
+
+} // namespace qnx::ipc
+
+#endif // CAPTURE_FILE_H
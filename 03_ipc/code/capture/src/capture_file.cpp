@@ -0,0 +1,187 @@
+// capture_file.cpp
+// Memory-mapped IPC capture file - Implementation
+#include "capture_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace qnx::ipc {
+
+namespace {
+    constexpr size_t alignRecord(size_t bytes) noexcept {
+        return (bytes + CAPTURE_RECORD_ALIGN - 1) / CAPTURE_RECORD_ALIGN * CAPTURE_RECORD_ALIGN;
+    }
+
+    int64_t monotonicNs() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+std::unique_ptr<CaptureWriter> CaptureWriter::create(const std::string& path,
+                                                     size_t max_bytes) {
+    const size_t capacity = std::max(alignRecord(max_bytes),
+                                     sizeof(CaptureFileHeader) + sizeof(CaptureRecord));
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd == -1) {
+        std::cerr << "Error: Cannot create capture " << path << ": "
+                  << std::strerror(errno) << "\n";
+        return nullptr;
+    }
+
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(capacity)) == -1 ||
+        (base = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0)) == MAP_FAILED) {
+        std::cerr << "Error: Cannot map capture " << path << ": "
+                  << std::strerror(errno) << "\n";
+        ::close(fd);
+        return nullptr;
+    }
+
+    CaptureFileHeader header{};
+    header.magic = CaptureFileHeader::MAGIC;
+    header.version = CaptureFileHeader::VERSION;
+    header.start_realtime_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    std::memcpy(base, &header, sizeof(header));
+
+    return std::unique_ptr<CaptureWriter>(
+        new CaptureWriter(fd, static_cast<char*>(base), capacity));
+}
+
+CaptureWriter::CaptureWriter(int fd, char* base, size_t capacity) noexcept
+    : fd_(fd),
+      base_(base),
+      capacity_(capacity),
+      start_ns_(monotonicNs()),
+      next_(sizeof(CaptureFileHeader)) {}
+
+CaptureWriter::~CaptureWriter() {
+    const size_t used = std::min(next_.load(), capacity_);
+    msync(base_, used, MS_SYNC);
+    munmap(base_, capacity_);
+
+    // Leave a zero length after the last record unless the file is full
+    const size_t end = std::min(used + sizeof(uint32_t), capacity_);
+    if (ftruncate(fd_, static_cast<off_t>(end)) == -1) {
+        std::cerr << "Error: Cannot trim capture: " << std::strerror(errno) << "\n";
+    }
+    ::close(fd_);
+}
+
+bool CaptureWriter::append(CaptureKind kind, int pid, int scoid,
+                           const MessageView& msg) noexcept {
+    const size_t length = alignRecord(sizeof(CaptureRecord) + msg.payload.size());
+    const size_t offset = next_.fetch_add(length, std::memory_order_relaxed);
+    if (offset > capacity_ || capacity_ - offset < length) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    CaptureRecord record{};
+    record.kind = static_cast<uint16_t>(kind);
+    record.timestamp_ns = static_cast<uint64_t>(monotonicNs() - start_ns_);
+    record.pid = pid;
+    record.scoid = scoid;
+    record.header = MessageHeader{msg.type, msg.subtype,
+                                  static_cast<uint32_t>(msg.payload.size())};
+
+    char* out = base_ + offset;
+    std::memcpy(out + sizeof(record), msg.payload.data(), msg.payload.size());
+
+    // Length goes in last: a record cut short by a crash reads as the end
+    std::memcpy(out + sizeof(record.length), reinterpret_cast<const char*>(&record) + sizeof(record.length),
+                sizeof(record) - sizeof(record.length));
+    const uint32_t length32 = static_cast<uint32_t>(length);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(out, &length32, sizeof(length32));
+
+    records_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+CaptureStats CaptureWriter::stats() const noexcept {
+    return CaptureStats{
+        records_.load(std::memory_order_relaxed),
+        std::min(next_.load(std::memory_order_relaxed), capacity_),
+        dropped_.load(std::memory_order_relaxed)
+    };
+}
+
+std::optional<CaptureReader> CaptureReader::open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        std::cerr << "Error: Cannot open capture " << path << ": "
+                  << std::strerror(errno) << "\n";
+        return std::nullopt;
+    }
+
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(CaptureFileHeader)) {
+        base = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Error: Cannot map capture " << path << "\n";
+        return std::nullopt;
+    }
+
+    CaptureReader reader(static_cast<const char*>(base), static_cast<size_t>(st.st_size));
+    if (reader.header().magic != CaptureFileHeader::MAGIC ||
+        reader.header().version != CaptureFileHeader::VERSION) {
+        std::cerr << "Error: " << path << " is not an IPC capture\n";
+        return std::nullopt;
+    }
+    return reader;
+}
+
+CaptureReader::CaptureReader(const char* base, size_t size) noexcept
+    : base_(base), size_(size), offset_(sizeof(CaptureFileHeader)) {}
+
+CaptureReader::CaptureReader(CaptureReader&& other) noexcept
+    : base_(other.base_), size_(other.size_), offset_(other.offset_) {
+    other.base_ = nullptr;
+}
+
+CaptureReader::~CaptureReader() {
+    if (base_ != nullptr) {
+        munmap(const_cast<char*>(base_), size_);
+    }
+}
+
+bool CaptureReader::next(CaptureEntry& entry) noexcept {
+    CaptureRecord record;
+    if (size_ - offset_ < sizeof(record)) {
+        return false;
+    }
+    std::memcpy(&record, base_ + offset_, sizeof(record));
+
+    if (record.length < sizeof(record) || record.length > size_ - offset_ ||
+        record.header.size > record.length - sizeof(record)) {
+        return false;
+    }
+
+    entry = CaptureEntry{
+        static_cast<CaptureKind>(record.kind),
+        record.timestamp_ns,
+        record.pid,
+        record.scoid,
+        MessageView{record.header.type, record.header.subtype,
+                    std::string_view(base_ + offset_ + sizeof(record), record.header.size)}
+    };
+    offset_ += record.length;
+    return true;
+}
+
+} // namespace qnx::ipc
@@ -0,0 +1,225 @@
+// replay.cpp
+// ipc_replay: send a recorded capture back to a receiver
+//
+// Every client connection in the capture (by its scoid on the recording
+// receiver) gets its own MessageSender and thread, so the original
+// concurrency is kept: each replays its records in order, one request in
+// flight, at the recorded offsets scaled by the speed factor. Ring records
+// are replayed as ordinary messages, since their ring is gone; MSG_TYPE_RING_SETUP
+// requests are skipped for the same reason, and so are MSG_TYPE_CREDIT requests
+// (the replaying connections do not take part in flow control).
+#include "binary_log.h"
+#include "capture_file.h"
+#include "latency_histogram.h"
+#include "message_sender.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace qnx::ipc;
+
+constexpr const char* DEFAULT_RECEIVER = "qnx_receiver_secure";
+
+const char* kindName(CaptureKind kind) {
+    switch (kind) {
+        case CaptureKind::MESSAGE: return "msg";
+        case CaptureKind::RING_RECORD: return "ring";
+        case CaptureKind::PULSE: return "pulse";
+    }
+    return "?";
+}
+
+/**
+ * @brief One recorded client connection and its replay results
+ */
+struct Stream {
+    Stream(int scoid, const std::string& receiver)
+        : sender("REPLAY" + std::to_string(scoid), receiver) {}
+
+    MessageSender sender;
+    std::vector<CaptureEntry> entries;
+    LatencyHistogram latency;       // Send to reply, requests only
+    uint64_t sent = 0;
+    uint64_t pulses = 0;
+    uint64_t rejected = 0;          // Replied with a status other than EOK
+    uint64_t failed = 0;            // Could not be delivered
+};
+
+void replayStream(Stream& stream, Clock::time_point start, double speed) {
+    for (const CaptureEntry& entry : stream.entries) {
+        if (speed > 0) {
+            std::this_thread::sleep_until(
+                start + std::chrono::nanoseconds(
+                            static_cast<int64_t>(entry.timestamp_ns / speed)));
+        }
+
+        if (entry.kind == CaptureKind::PULSE) {
+            int32_t value = 0;
+            std::memcpy(&value, entry.msg.payload.data(),
+                        std::min(sizeof(value), entry.msg.payload.size()));
+            const bool sent = (entry.msg.type == PULSE_CODE_TELEMETRY)
+                ? stream.sender.sendTelemetry(decodeTelemetry(static_cast<uint32_t>(value)))
+                : stream.sender.sendPulse(entry.msg.type, value);
+            ++(sent ? stream.pulses : stream.failed);
+            continue;
+        }
+
+        const auto submitted = Clock::now();
+        const SendResult result = stream.sender.sendAsync(entry.msg).get();
+        if (!result.ok()) {
+            ++stream.failed;
+            continue;
+        }
+        stream.latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - submitted).count()));
+        ++stream.sent;
+        if (result.status != EOK) {
+            ++stream.rejected;
+        }
+    }
+}
+
+void listCapture(CaptureReader& reader) {
+    std::printf("%14s %-5s %8s %8s %6s %7s %8s\n",
+                "time us", "kind", "pid", "scoid", "type", "subtype", "bytes");
+    CaptureEntry entry;
+    while (reader.next(entry)) {
+        std::printf("%14.1f %-5s %8d %8d %6u %7u %8zu\n",
+                    entry.timestamp_ns / 1000.0, kindName(entry.kind), entry.pid,
+                    entry.scoid, entry.msg.type, entry.msg.subtype,
+                    entry.msg.payload.size());
+    }
+}
+
+void printUsage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [-s speed] [-n name] [-l lane] [-i] capture_file\n"
+        "  -s  Time scale: 1 = as recorded (default), 2 = twice as fast,\n"
+        "      0 = as fast as replies allow\n"
+        "  -n  Receiver name (default %s)\n"
+        "  -l  Receiver lane suffix for requests\n"
+        "  -i  List the records instead of replaying them\n",
+        prog, DEFAULT_RECEIVER);
+}
+
+double toUs(uint64_t ns) {
+    return ns / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string receiver = DEFAULT_RECEIVER;
+    std::string lane;
+    double speed = 1.0;
+    bool list = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:l:i")) != -1) {
+        switch (opt) {
+            case 's': speed = std::strtod(optarg, nullptr); break;
+            case 'n': receiver = optarg; break;
+            case 'l': lane = optarg; break;
+            case 'i': list = true; break;
+            default:
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1 || speed < 0) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto reader = CaptureReader::open(argv[optind]);
+    if (!reader) {
+        return EXIT_FAILURE;
+    }
+    if (list) {
+        listCapture(*reader);
+        return EXIT_SUCCESS;
+    }
+
+    // Entries point into the mapping, which outlives every stream
+    std::map<int, std::unique_ptr<Stream>> streams;
+    uint64_t skipped = 0;
+    CaptureEntry entry;
+    while (reader->next(entry)) {
+        if (entry.kind != CaptureKind::PULSE &&
+            (entry.msg.type == MSG_TYPE_RING_SETUP || entry.msg.type == MSG_TYPE_CREDIT)) {
+            ++skipped;
+            continue;
+        }
+        auto& stream = streams[entry.scoid];
+        if (!stream) {
+            stream = std::make_unique<Stream>(entry.scoid, receiver);
+        }
+        stream->entries.push_back(entry);
+    }
+
+    for (auto& [scoid, stream] : streams) {
+        if (!stream->sender.connect() || !stream->sender.startPipeline(1, lane)) {
+            return EXIT_FAILURE;
+        }
+    }
+    BinaryLog::flush();
+
+    if (speed > 0) {
+        std::printf("# replaying %zu connections to %s at %gx\n", streams.size(),
+                    receiver.c_str(), speed);
+    } else {
+        std::printf("# replaying %zu connections to %s at full speed\n", streams.size(),
+                    receiver.c_str());
+    }
+
+    const auto start = Clock::now() + std::chrono::milliseconds(10);
+    std::vector<std::thread> threads;
+    for (auto& [scoid, stream] : streams) {
+        threads.emplace_back(replayStream, std::ref(*stream), start, speed);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    LatencyHistogram latency;
+    uint64_t sent = 0;
+    uint64_t pulses = 0;
+    uint64_t rejected = 0;
+    uint64_t failed = 0;
+    for (const auto& [scoid, stream] : streams) {
+        latency.merge(stream->latency);
+        sent += stream->sent;
+        pulses += stream->pulses;
+        rejected += stream->rejected;
+        failed += stream->failed;
+    }
+
+    std::printf("%10s %8s %8s %8s %8s %10s %10s %10s %10s %10s\n",
+                "requests", "pulses", "rejected", "failed", "skipped",
+                "msg/s", "p50 us", "p99 us", "p99.9 us", "max us");
+    std::printf("%10llu %8llu %8llu %8llu %8llu %10.0f %10.1f %10.1f %10.1f %10.1f\n",
+                static_cast<unsigned long long>(sent),
+                static_cast<unsigned long long>(pulses),
+                static_cast<unsigned long long>(rejected),
+                static_cast<unsigned long long>(failed),
+                static_cast<unsigned long long>(skipped),
+                (sent + pulses) / elapsed,
+                toUs(latency.percentile(50)), toUs(latency.percentile(99)),
+                toUs(latency.percentile(99.9)), toUs(latency.max()));
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,138 @@
+// event_loop.h
+// Small executor that resumes coroutines on a few threads - Header
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "task.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Executor counters since the loop was created
+ */
+struct EventLoopStats {
+    uint64_t resumed;       // Coroutines resumed by loop threads
+    uint64_t timers;        // sleepFor() wake-ups
+    uint64_t spawned;       // Tasks started with spawn()
+    uint64_t active;        // Spawned tasks not finished yet
+};
+
+/**
+ * @brief Resumes suspended coroutines on a fixed, small set of threads
+ *
+ * A run queue of coroutine handles plus a timer heap, both under one
+ * mutex; idle threads sleep on a condition variable until the next
+ * handle or deadline. A suspended coroutine costs only its frame, so
+ * thousands of conversations can wait on messages or timers while the
+ * loop keeps a handful of threads.
+ *
+ * Work that blocks (MsgSend, a device read) must not run on a loop
+ * thread: hand it to a thread that may block (e.g. a SendPipeline) and
+ * post() the coroutine back when it is done.
+ */
+class EventLoop {
+public:
+    /**
+     * @brief Start the loop threads
+     * @param threads Number of loop threads (at least one)
+     */
+    explicit EventLoop(unsigned threads = 1);
+
+    // Prevent copying and moving (loop threads reference the loop)
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief drain(), then stop the loop threads
+     */
+    ~EventLoop();
+
+    /**
+     * @brief Queue a suspended coroutine to be resumed on a loop thread
+     *
+     * Safe from any thread, including from a completion callback.
+     */
+    void post(std::coroutine_handle<> handle);
+
+    /**
+     * @brief co_await loop.schedule() continues on a loop thread
+     */
+    [[nodiscard]] auto schedule() noexcept {
+        struct Awaiter {
+            EventLoop& loop;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { loop.post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    /**
+     * @brief co_await loop.sleepFor(d) resumes on a loop thread after d,
+     *        holding no thread meanwhile
+     */
+    [[nodiscard]] auto sleepFor(std::chrono::steady_clock::duration delay) noexcept {
+        struct Awaiter {
+            EventLoop& loop;
+            std::chrono::steady_clock::time_point deadline;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                loop.postAt(deadline, handle);
+            }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this, std::chrono::steady_clock::now() + delay};
+    }
+
+    /**
+     * @brief Start a task on a loop thread and let it run to completion
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Block until every spawned task has finished
+     */
+    void drain();
+
+    [[nodiscard]] size_t threadCount() const noexcept { return threads_.size(); }
+    [[nodiscard]] EventLoopStats stats() const noexcept;
+
+private:
+    struct Timer {
+        std::chrono::steady_clock::time_point deadline;
+        std::coroutine_handle<> handle;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::coroutine_handle<>> ready_;     // mutex_
+    std::vector<Timer> timers_;                     // mutex_, min-heap by deadline
+    bool stopping_ = false;                         // mutex_
+
+    std::atomic<uint64_t> resumed_{0};
+    std::atomic<uint64_t> fired_{0};
+    std::atomic<uint64_t> spawned_{0};
+    std::atomic<uint64_t> active_{0};
+
+    std::vector<std::thread> threads_;
+
+    void postAt(std::chrono::steady_clock::time_point deadline, std::coroutine_handle<> handle);
+    void loopThread();
+    void taskFinished();
+    Task<void> runSpawned(Task<void> task);
+};
+
+} // namespace qnx::ipc
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,220 @@
+// task.h
+// Lazily started coroutine that produces one value - Header
+#ifndef TASK_H
+#define TASK_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace qnx::ipc {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+    /**
+     * @brief Promise state shared by Task<T> and Task<void>
+     *
+     * The task starts suspended; co_await starts it and, when it finishes,
+     * the final awaiter transfers straight back to the awaiting coroutine
+     * (symmetric transfer), so chains of tasks neither nest on the stack
+     * nor pass through a scheduler.
+     */
+    struct TaskPromiseBase {
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+        std::exception_ptr exception;
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> done) noexcept {
+                return done.promise().continuation;
+            }
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+    };
+
+    template <typename T>
+    struct TaskPromise : TaskPromiseBase {
+        std::optional<T> value;
+
+        Task<T> get_return_object() noexcept;
+        template <typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+        T take() {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+            return std::move(*value);
+        }
+    };
+
+    template <>
+    struct TaskPromise<void> : TaskPromiseBase {
+        Task<void> get_return_object() noexcept;
+        void return_void() const noexcept {}
+
+        void take() const {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+    };
+
+    /**
+     * @brief Fire-and-forget coroutine: runs eagerly, frees itself at the end
+     */
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() const noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+}
+
+/**
+ * @brief A coroutine returning T, started when first awaited
+ *
+ * Owns its frame: destroying a Task that was never awaited destroys the
+ * coroutine without running it. Exceptions escaping the coroutine are
+ * rethrown from co_await.
+ *
+ * @code
+ * Task<int> handle(...) {
+ *     co_await loop.sleepFor(1ms);
+ *     co_return EOK;
+ * }
+ * @endcode
+ */
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    /**
+     * @brief co_await starts the task and resumes the caller with its result
+     */
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> task;
+
+            bool await_ready() const noexcept { return !task || task.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                task.promise().continuation = caller;
+                return task;
+            }
+            T await_resume() { return task.promise().take(); }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    friend promise_type;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+    template <typename T>
+    Task<T> TaskPromise<T>::get_return_object() noexcept {
+        return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+        return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+    }
+
+    inline Detached detach(Task<void> task) {
+        co_await std::move(task);
+    }
+}
+
+/**
+ * @brief Start a task on the calling thread and let it finish on its own
+ *
+ * The task runs until its first suspension before spawn() returns; it is
+ * then resumed by whatever it awaits (a loop thread, a pipeline thread).
+ * Exceptions escaping it terminate the process.
+ */
+inline void spawn(Task<void> task) {
+    detail::detach(std::move(task));
+}
+
+/**
+ * @brief Run a task to completion, blocking the calling thread until it is done
+ *
+ * For code that is not a coroutine itself (main(), a receive thread).
+ * Never call it on the EventLoop thread the task needs to make progress.
+ */
+template <typename T>
+T syncWait(Task<T> task) {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done = false;
+    std::exception_ptr exception;
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> result;
+
+    const auto run = [&]() -> detail::Detached {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await std::move(task);
+                result.emplace(true);
+            } else {
+                result.emplace(co_await std::move(task));
+            }
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        done_cv.notify_one();
+    };
+    run();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [&done] { return done; });
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*result);
+    }
+}
+
+} // namespace qnx::ipc
+
+#endif // TASK_H
@@ -0,0 +1,132 @@
+// event_loop.cpp
+// Small executor that resumes coroutines on a few threads - Implementation
+#include "event_loop.h"
+
+#include <algorithm>
+
+namespace qnx::ipc {
+
+namespace {
+    // std::push_heap/pop_heap build a max-heap; earliest deadline on top
+    struct LaterDeadline {
+        template <typename Timer>
+        bool operator()(const Timer& a, const Timer& b) const noexcept {
+            return a.deadline > b.deadline;
+        }
+    };
+}
+
+EventLoop::EventLoop(unsigned threads) {
+    threads = std::max(threads, 1u);
+    threads_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        threads_.emplace_back([this] { loopThread(); });
+    }
+}
+
+EventLoop::~EventLoop() {
+    drain();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void EventLoop::post(std::coroutine_handle<> handle) {
+    // Notify under the lock: once the coroutine runs, the loop may be
+    // drained and destroyed, and a poster must not touch it after that
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.push_back(handle);
+    work_cv_.notify_one();
+}
+
+void EventLoop::postAt(std::chrono::steady_clock::time_point deadline,
+                       std::coroutine_handle<> handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timers_.push_back(Timer{deadline, handle});
+    std::push_heap(timers_.begin(), timers_.end(), LaterDeadline{});
+    // Only a new earliest deadline shortens anyone's sleep
+    if (timers_.front().handle == handle) {
+        work_cv_.notify_one();
+    }
+}
+
+void EventLoop::spawn(Task<void> task) {
+    spawned_.fetch_add(1, std::memory_order_relaxed);
+    active_.fetch_add(1, std::memory_order_relaxed);
+    qnx::ipc::spawn(runSpawned(std::move(task)));
+}
+
+Task<void> EventLoop::runSpawned(Task<void> task) {
+    co_await schedule();
+    try {
+        co_await std::move(task);
+    } catch (...) {
+        taskFinished();
+        throw;
+    }
+    taskFinished();
+}
+
+void EventLoop::taskFinished() {
+    if (active_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_cv_.notify_all();
+    }
+}
+
+void EventLoop::drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return active_.load(std::memory_order_acquire) == 0; });
+}
+
+EventLoopStats EventLoop::stats() const noexcept {
+    return EventLoopStats{
+        resumed_.load(std::memory_order_relaxed),
+        fired_.load(std::memory_order_relaxed),
+        spawned_.load(std::memory_order_relaxed),
+        active_.load(std::memory_order_relaxed)
+    };
+}
+
+void EventLoop::loopThread() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Move due timers onto the run queue
+        const auto now = std::chrono::steady_clock::now();
+        while (!timers_.empty() && timers_.front().deadline <= now) {
+            std::pop_heap(timers_.begin(), timers_.end(), LaterDeadline{});
+            ready_.push_back(timers_.back().handle);
+            timers_.pop_back();
+            fired_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (!ready_.empty()) {
+            const std::coroutine_handle<> handle = ready_.front();
+            ready_.pop_front();
+            if (!ready_.empty()) {
+                work_cv_.notify_one();      // Let an idle thread take the rest
+            }
+            lock.unlock();
+            resumed_.fetch_add(1, std::memory_order_relaxed);
+            handle.resume();
+            lock.lock();
+            continue;
+        }
+
+        if (stopping_) {
+            return;     // Sleeping coroutines are abandoned, never resumed
+        }
+        if (timers_.empty()) {
+            work_cv_.wait(lock);
+        } else {
+            work_cv_.wait_until(lock, timers_.front().deadline);
+        }
+    }
+}
+
+} // namespace qnx::ipc
@@ -0,0 +1,153 @@
+// binary_log.h
+// Asynchronous binary logger - Header
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include "log_record.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Lowest level compiled in
+ *
+ * Statements below it generate no code at all. Release builds (NDEBUG)
+ * keep INFO and up, so per-message DEBUG records vanish; override with
+ * -DIPC_LOG_MIN_LEVEL=n.
+ */
+#ifndef IPC_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define IPC_LOG_MIN_LEVEL IPC_LOG_LEVEL_INFO
+#else
+#define IPC_LOG_MIN_LEVEL IPC_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+/**
+ * @brief Log a record: IPC_LOG_INFO("chid {} ready", chid)
+ *
+ * The format must be a string literal; "{}" marks each argument. Arguments
+ * are copied in binary form and formatted later, off the calling thread.
+ * The format travels in __VA_ARGS__ with them, so a statement without
+ * arguments needs no GNU extension.
+ */
+#define IPC_LOG_AT(lvl, ...)                                                       \
+    do {                                                                           \
+        if constexpr (::qnx::ipc::logEnabled(lvl)) {                               \
+            static ::qnx::ipc::LogSite ipc_log_site_{                              \
+                lvl, __FILE__, __LINE__, IPC_LOG_FORMAT_(__VA_ARGS__, ~)};         \
+            ::qnx::ipc::BinaryLog::write(ipc_log_site_, __VA_ARGS__);              \
+        }                                                                          \
+    } while (false)
+
+/// First of a statement's arguments (the trailing one keeps ... non-empty)
+#define IPC_LOG_FORMAT_(fmt, ...) fmt
+
+#define IPC_LOG_DEBUG(...) IPC_LOG_AT(::qnx::ipc::LogLevel::DEBUG, __VA_ARGS__)
+#define IPC_LOG_INFO(...)  IPC_LOG_AT(::qnx::ipc::LogLevel::INFO, __VA_ARGS__)
+#define IPC_LOG_WARN(...)  IPC_LOG_AT(::qnx::ipc::LogLevel::WARN, __VA_ARGS__)
+#define IPC_LOG_ERROR(...) IPC_LOG_AT(::qnx::ipc::LogLevel::ERROR, __VA_ARGS__)
+
+namespace qnx::ipc {
+
+/// Whether statements at this level are compiled in
+constexpr bool logEnabled(LogLevel level) noexcept {
+#if IPC_LOG_MIN_LEVEL > IPC_LOG_LEVEL_DEBUG
+    return static_cast<int>(level) >= IPC_LOG_MIN_LEVEL;
+#else
+    return static_cast<void>(level), true;
+#endif
+}
+
+/**
+ * @brief Where the drain thread sends records
+ */
+enum class LogOutput {
+    CONSOLE,    // Formatted text on stdout
+    FILE,       // Binary records; decode with ipc_logdump
+    SLOGGER2    // Formatted text to slogger2 (QNX; console elsewhere)
+};
+
+struct LogConfig {
+    LogOutput output = LogOutput::CONSOLE;
+    std::string path;                                   // FILE: output file; SLOGGER2: buffer set name
+    std::chrono::milliseconds drain_interval{20};       // Max delay for DEBUG/INFO
+};
+
+/**
+ * @brief Drain thread counters
+ */
+struct LogStats {
+    uint64_t written;
+    uint64_t dropped;       // Lost to a full per-thread buffer
+};
+
+/**
+ * @brief Process-wide asynchronous logger
+ *
+ * Each thread writes fixed-size binary records into its own single-producer
+ * ring; a background thread drains every ring and does the formatting and
+ * output. Logging never blocks or locks: a full ring drops the record and
+ * counts it. WARN and ERROR wake the drain thread at once; lower levels
+ * wait at most drain_interval.
+ *
+ * Starts on first use with the console output; call start() first to pick
+ * another. Remaining records are written at exit or by flush().
+ */
+class BinaryLog {
+public:
+    /**
+     * @brief Choose the output; records already queued go to the new one
+     * @return false if the output could not be opened (console is kept)
+     */
+    static bool start(const LogConfig& config);
+
+    /**
+     * @brief Block until everything logged so far has been written
+     */
+    static void flush();
+
+    static LogStats stats() noexcept;
+
+    /**
+     * @brief Give the calling thread its ring now instead of at its first
+     *        record, so a realtime thread's first log does not allocate
+     */
+    static void attachThread() noexcept;
+
+    /**
+     * @brief Record args at site (use the IPC_LOG_* macros)
+     * @param format The site's format, which the macros pass first; not stored
+     */
+    template <typename... Args>
+    static void write(LogSite& site, const char* /*format*/, const Args&... args) noexcept {
+        uint32_t id = site.id.load(std::memory_order_acquire);
+        if (id == 0) {
+            id = registerSite(site);
+        }
+
+        uint8_t* slot = reserve();
+        if (slot == nullptr) {
+            return;
+        }
+
+        RecordEncoder encoder(slot + sizeof(RecordHeader), slot + LOG_RECORD_SIZE);
+        (encoder.put(args), ...);
+        commit(site.level, id, encoder.size(), encoder.count());
+    }
+
+private:
+    static uint32_t registerSite(LogSite& site) noexcept;
+
+    /// Calling thread's next free slot, or nullptr if its ring is full
+    static uint8_t* reserve() noexcept;
+
+    /// Fill in the header of the reserved slot and publish it
+    static void commit(LogLevel level, uint32_t site, uint16_t size,
+                       uint16_t arg_count) noexcept;
+};
+
+} // namespace qnx::ipc
+
+#endif // BINARY_LOG_H
@@ -0,0 +1,180 @@
+// log_record.h
+// Binary log record layout and deferred formatting - Header
+#ifndef LOG_RECORD_H
+#define LOG_RECORD_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/// Numeric levels, usable in #if and IPC_LOG_MIN_LEVEL
+#define IPC_LOG_LEVEL_DEBUG 0
+#define IPC_LOG_LEVEL_INFO  1
+#define IPC_LOG_LEVEL_WARN  2
+#define IPC_LOG_LEVEL_ERROR 3
+
+namespace qnx::ipc {
+
+enum class LogLevel : uint8_t {
+    DEBUG = IPC_LOG_LEVEL_DEBUG,
+    INFO = IPC_LOG_LEVEL_INFO,
+    WARN = IPC_LOG_LEVEL_WARN,
+    ERROR = IPC_LOG_LEVEL_ERROR
+};
+
+const char* levelName(LogLevel level) noexcept;
+
+/// Fixed record slot: header plus encoded arguments
+constexpr size_t LOG_RECORD_SIZE = 256;
+
+/// Longest string argument kept; longer ones are cut
+constexpr size_t LOG_MAX_STRING = 96;
+
+/**
+ * @brief One log statement in the source
+ *
+ * A function-local static per call site, constant-initialised. The id is
+ * assigned on first use; records carry only the id, and the format string
+ * is written to the output once.
+ */
+struct LogSite {
+    LogLevel level;
+    const char* file;
+    int line;
+    const char* format;
+    std::atomic<uint32_t> id;
+
+    constexpr LogSite(LogLevel lvl, const char* f, int l, const char* fmt) noexcept
+        : level(lvl), file(f), line(l), format(fmt), id(0) {}
+};
+
+/**
+ * @brief Start of each record slot
+ */
+struct RecordHeader {
+    uint32_t site;
+    uint16_t size;          // Encoded argument bytes that follow
+    uint16_t arg_count;
+    uint32_t thread;        // Logger-assigned thread number
+    uint32_t reserved;
+    uint64_t timestamp_ns;  // CLOCK_REALTIME
+};
+
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader layout is part of the file format");
+
+constexpr size_t LOG_MAX_ARG_BYTES = LOG_RECORD_SIZE - sizeof(RecordHeader);
+
+/// Tag byte in front of each encoded argument
+enum class LogArg : uint8_t {
+    INT,        // int64_t
+    UINT,       // uint64_t
+    DOUBLE,     // double
+    STRING      // uint16_t length, then bytes
+};
+
+/**
+ * @brief Appends arguments to a record without formatting them
+ *
+ * Arguments that do not fit are dropped; the decoder prints "?" for them.
+ */
+class RecordEncoder {
+public:
+    RecordEncoder(uint8_t* begin, uint8_t* end) noexcept
+        : pos_(begin), begin_(begin), end_(end) {}
+
+    template <typename T>
+    void put(const T& value) noexcept {
+        if constexpr (std::is_enum_v<T>) {
+            put(static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_same_v<T, bool> || std::is_unsigned_v<T>) {
+            putScalar(LogArg::UINT, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            putScalar(LogArg::INT, static_cast<int64_t>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            putScalar(LogArg::DOUBLE, static_cast<double>(value));
+        } else {
+            putString(std::string_view(value));
+        }
+    }
+
+    [[nodiscard]] uint16_t size() const noexcept {
+        return static_cast<uint16_t>(pos_ - begin_);
+    }
+    [[nodiscard]] uint16_t count() const noexcept { return count_; }
+
+private:
+    template <typename V>
+    void putScalar(LogArg tag, V value) noexcept {
+        if (static_cast<size_t>(end_ - pos_) < 1 + sizeof(V)) {
+            return;
+        }
+        *pos_++ = static_cast<uint8_t>(tag);
+        std::memcpy(pos_, &value, sizeof(V));
+        pos_ += sizeof(V);
+        ++count_;
+    }
+
+    void putString(std::string_view text) noexcept {
+        constexpr size_t overhead = 1 + sizeof(uint16_t);
+        const size_t room = static_cast<size_t>(end_ - pos_);
+        if (room < overhead) {
+            return;
+        }
+        const auto length = static_cast<uint16_t>(
+            std::min({text.size(), LOG_MAX_STRING, room - overhead}));
+        *pos_++ = static_cast<uint8_t>(LogArg::STRING);
+        std::memcpy(pos_, &length, sizeof(length));
+        pos_ += sizeof(length);
+        std::memcpy(pos_, text.data(), length);
+        pos_ += length;
+        ++count_;
+    }
+
+    uint8_t* pos_;
+    uint8_t* begin_;
+    uint8_t* end_;
+    uint16_t count_ = 0;
+};
+
+/**
+ * @brief Substitute encoded arguments into a format string
+ *
+ * Each "{}" takes the next argument. Runs on the drain thread or in
+ * ipc_logdump, never on the thread that logged.
+ */
+std::string formatMessage(std::string_view format, const uint8_t* args,
+                          size_t size, uint16_t arg_count);
+
+/**
+ * @brief Binary log file layout (LogOutput::FILE)
+ *
+ * A LogFileHeader, then chunks. A SITE chunk precedes the first record
+ * that uses it, so the file decodes on its own.
+ */
+struct LogFileHeader {
+    static constexpr uint32_t MAGIC = 0x474C5049;   // "IPLG"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic;
+    uint32_t version;
+};
+
+enum class LogChunk : uint32_t {
+    SITE,       // uint32_t id, uint8_t level, int32_t line, file\0, format\0
+    RECORD,     // RecordHeader + arguments
+    DROPPED     // uint32_t thread, uint64_t records lost to a full buffer
+};
+
+struct ChunkHeader {
+    LogChunk kind;
+    uint32_t size;
+};
+
+} // namespace qnx::ipc
+
+#endif // LOG_RECORD_H
@@ -0,0 +1,504 @@
+// binary_log.cpp
+// Asynchronous binary logger - Implementation
+#include "binary_log.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __QNXNTO__
+#include <sys/slog2.h>
+#endif
+
+namespace qnx::ipc {
+
+namespace {
+    /// Records per thread ring (128 KiB with 256-byte records)
+    constexpr size_t RING_RECORDS = 512;
+
+    /// Log sites registered before the site table has to grow
+    constexpr size_t RESERVED_SITES = 1024;
+
+    /**
+     * @brief One thread's records: it writes head, the drain thread tail
+     */
+    struct ThreadRing {
+        explicit ThreadRing(uint32_t number) noexcept : thread(number) {}
+
+        std::array<std::array<uint8_t, LOG_RECORD_SIZE>, RING_RECORDS> slots{};
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};   // Owning thread has exited
+        const uint32_t thread;
+        uint64_t reported = 0;              // Drops already written (drain thread)
+    };
+
+    /**
+     * @brief Output for drained records; only the drain thread calls it
+     */
+    class LogSink {
+    public:
+        virtual ~LogSink() = default;
+        virtual void record(const LogSite& site, const RecordHeader& header,
+                            const uint8_t* args) = 0;
+        virtual void dropped(uint32_t thread, uint64_t count) = 0;
+        virtual void flush() = 0;
+    };
+
+    class ConsoleSink final : public LogSink {
+    public:
+        void record(const LogSite& site, const RecordHeader& header,
+                    const uint8_t* args) override {
+            out_ += formatMessage(site.format, args, header.size, header.arg_count);
+            out_ += '\n';
+        }
+
+        void dropped(uint32_t thread, uint64_t count) override {
+            out_ += "[log] thread " + std::to_string(thread) + " dropped " +
+                    std::to_string(count) + " records\n";
+        }
+
+        void flush() override {
+            if (!out_.empty()) {
+                std::fwrite(out_.data(), 1, out_.size(), stdout);
+                std::fflush(stdout);
+                out_.clear();
+            }
+        }
+
+    private:
+        std::string out_;
+    };
+
+    class FileSink final : public LogSink {
+    public:
+        ~FileSink() override {
+            if (file_ != nullptr) {
+                std::fclose(file_);
+            }
+        }
+
+        bool open(const std::string& path) {
+            file_ = std::fopen(path.c_str(), "wb");
+            if (file_ == nullptr) {
+                return false;
+            }
+            const LogFileHeader header{LogFileHeader::MAGIC, LogFileHeader::VERSION};
+            return std::fwrite(&header, sizeof(header), 1, file_) == 1;
+        }
+
+        void record(const LogSite& site, const RecordHeader& header,
+                    const uint8_t* args) override {
+            if (header.site >= written_.size()) {
+                written_.resize(header.site + 1, false);
+            }
+            if (!written_[header.site]) {
+                writeSite(site, header.site);
+                written_[header.site] = true;
+            }
+
+            writeChunk(LogChunk::RECORD, sizeof(header) + header.size);
+            std::fwrite(&header, sizeof(header), 1, file_);
+            std::fwrite(args, 1, header.size, file_);
+        }
+
+        void dropped(uint32_t thread, uint64_t count) override {
+            writeChunk(LogChunk::DROPPED, sizeof(thread) + sizeof(count));
+            std::fwrite(&thread, sizeof(thread), 1, file_);
+            std::fwrite(&count, sizeof(count), 1, file_);
+        }
+
+        void flush() override { std::fflush(file_); }
+
+    private:
+        void writeChunk(LogChunk kind, size_t size) {
+            const ChunkHeader chunk{kind, static_cast<uint32_t>(size)};
+            std::fwrite(&chunk, sizeof(chunk), 1, file_);
+        }
+
+        void writeSite(const LogSite& site, uint32_t id) {
+            const auto level = static_cast<uint8_t>(site.level);
+            const auto line = static_cast<int32_t>(site.line);
+            const size_t file_len = std::strlen(site.file) + 1;
+            const size_t format_len = std::strlen(site.format) + 1;
+
+            writeChunk(LogChunk::SITE, sizeof(id) + sizeof(level) + sizeof(line) +
+                                           file_len + format_len);
+            std::fwrite(&id, sizeof(id), 1, file_);
+            std::fwrite(&level, sizeof(level), 1, file_);
+            std::fwrite(&line, sizeof(line), 1, file_);
+            std::fwrite(site.file, 1, file_len, file_);
+            std::fwrite(site.format, 1, format_len, file_);
+        }
+
+        std::FILE* file_ = nullptr;
+        std::vector<bool> written_;
+    };
+
+#ifdef __QNXNTO__
+    class Slog2Sink final : public LogSink {
+    public:
+        bool open(const std::string& name) {
+            name_ = name.empty() ? "ipc" : name;
+
+            slog2_buffer_set_config_t config{};
+            config.buffer_set_name = name_.c_str();
+            config.num_buffers = 1;
+            config.verbosity_level = SLOG2_DEBUG1;
+            config.buffer_config[0].buffer_name = "log";
+            config.buffer_config[0].num_pages = 8;
+            return slog2_register(&config, &buffer_, 0) == 0;
+        }
+
+        void record(const LogSite& site, const RecordHeader& header,
+                    const uint8_t* args) override {
+            const std::string text =
+                formatMessage(site.format, args, header.size, header.arg_count);
+            slog2c(buffer_, 0, severity(site.level), text.c_str());
+        }
+
+        void dropped(uint32_t thread, uint64_t count) override {
+            slog2f(buffer_, 0, SLOG2_WARNING, "thread %u dropped %llu records",
+                   thread, static_cast<unsigned long long>(count));
+        }
+
+        void flush() override {}
+
+    private:
+        static uint8_t severity(LogLevel level) noexcept {
+            switch (level) {
+                case LogLevel::DEBUG: return SLOG2_DEBUG1;
+                case LogLevel::INFO:  return SLOG2_INFO;
+                case LogLevel::WARN:  return SLOG2_WARNING;
+                case LogLevel::ERROR: return SLOG2_ERROR;
+            }
+            return SLOG2_INFO;
+        }
+
+        std::string name_;
+        slog2_buffer_t buffer_ = nullptr;
+    };
+#endif
+
+    std::unique_ptr<LogSink> makeSink(const LogConfig& config) {
+        switch (config.output) {
+            case LogOutput::FILE: {
+                auto sink = std::make_unique<FileSink>();
+                if (!sink->open(config.path)) {
+                    std::cerr << "Error: Cannot open log file " << config.path << ": "
+                              << std::strerror(errno) << "\n";
+                    return nullptr;
+                }
+                return sink;
+            }
+            case LogOutput::SLOGGER2: {
+#ifdef __QNXNTO__
+                auto sink = std::make_unique<Slog2Sink>();
+                if (!sink->open(config.path)) {
+                    std::cerr << "Error: slog2_register failed: "
+                              << std::strerror(errno) << "\n";
+                    return nullptr;
+                }
+                return sink;
+#else
+                return std::make_unique<ConsoleSink>();
+#endif
+            }
+            case LogOutput::CONSOLE:
+                break;
+        }
+        return std::make_unique<ConsoleSink>();
+    }
+
+    /// Set once the logger is destroyed; later records are discarded
+    std::atomic<bool> closed{false};
+
+    /**
+     * @brief Owns the rings, the site table and the drain thread
+     */
+    class Logger {
+    public:
+        static Logger& instance() {
+            static Logger logger;
+            return logger;
+        }
+
+        ~Logger() {
+            closed.store(true, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_cv_.notify_one();
+            thread_.join();
+        }
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        std::shared_ptr<ThreadRing> attach() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto ring = std::make_shared<ThreadRing>(next_thread_++);
+            rings_.push_back(ring);
+            return ring;
+        }
+
+        uint32_t registerSite(LogSite& site) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // Another thread may have registered it meanwhile
+            uint32_t id = site.id.load(std::memory_order_relaxed);
+            if (id == 0) {
+                sites_.push_back(&site);
+                id = static_cast<uint32_t>(sites_.size());
+                site.id.store(id, std::memory_order_release);
+            }
+            return id;
+        }
+
+        bool start(const LogConfig& config) {
+            auto sink = makeSink(config);
+            if (!sink) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(sink_mutex_);
+                sink_->flush();
+                sink_ = std::move(sink);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            interval_ = config.drain_interval;
+            return true;
+        }
+
+        void flush() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // The next pass may already be under way; the one after is not
+            const uint64_t target = passes_ + 2;
+            wake();
+            done_cv_.wait(lock, [&] { return passes_ >= target || stopping_; });
+        }
+
+        void wake() noexcept {
+            wake_pending_.store(true, std::memory_order_relaxed);
+            wake_cv_.notify_one();
+        }
+
+        LogStats stats() const noexcept {
+            return LogStats{written_.load(std::memory_order_relaxed),
+                            dropped_.load(std::memory_order_relaxed)};
+        }
+
+    private:
+        // Registering a site, on its first record, then never allocates
+        Logger()
+            : sink_(std::make_unique<ConsoleSink>()),
+              thread_([this] { run(); }) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sites_.reserve(RESERVED_SITES);
+        }
+
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stopping_) {
+                wake_cv_.wait_for(lock, interval_, [this] {
+                    return stopping_ || wake_pending_.exchange(false, std::memory_order_relaxed);
+                });
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+        }
+
+        /// One pass over every ring, written in timestamp order
+        void drain() {
+            std::vector<std::shared_ptr<ThreadRing>> rings;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                rings = rings_;
+            }
+
+            struct Pending {
+                RecordHeader header;
+                const uint8_t* args;
+            };
+            std::vector<Pending> pending;
+            std::vector<uint64_t> heads(rings.size());
+
+            for (size_t r = 0; r < rings.size(); ++r) {
+                ThreadRing& ring = *rings[r];
+                heads[r] = ring.head.load(std::memory_order_acquire);
+                for (uint64_t i = ring.tail.load(std::memory_order_relaxed); i != heads[r]; ++i) {
+                    const uint8_t* slot = ring.slots[i % RING_RECORDS].data();
+                    Pending entry;
+                    std::memcpy(&entry.header, slot, sizeof(entry.header));
+                    entry.args = slot + sizeof(RecordHeader);
+                    pending.push_back(entry);
+                }
+            }
+
+            // Sites are registered before their first record is published
+            std::vector<const LogSite*> sites;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                sites = sites_;
+            }
+
+            std::stable_sort(pending.begin(), pending.end(),
+                             [](const Pending& a, const Pending& b) {
+                                 return a.header.timestamp_ns < b.header.timestamp_ns;
+                             });
+
+            {
+                std::lock_guard<std::mutex> lock(sink_mutex_);
+                for (const Pending& entry : pending) {
+                    const uint32_t id = entry.header.site;
+                    if (id != 0 && id <= sites.size()) {
+                        sink_->record(*sites[id - 1], entry.header, entry.args);
+                    }
+                }
+                for (auto& ring : rings) {
+                    const uint64_t lost = ring->dropped.load(std::memory_order_relaxed);
+                    if (lost != ring->reported) {
+                        sink_->dropped(ring->thread, lost - ring->reported);
+                        dropped_.fetch_add(lost - ring->reported, std::memory_order_relaxed);
+                        ring->reported = lost;
+                    }
+                }
+                sink_->flush();
+            }
+            written_.fetch_add(pending.size(), std::memory_order_relaxed);
+
+            // Slots are reusable only once their records are written
+            for (size_t r = 0; r < rings.size(); ++r) {
+                rings[r]->tail.store(heads[r], std::memory_order_release);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                            [](const std::shared_ptr<ThreadRing>& ring) {
+                                                return ring->retired.load(std::memory_order_acquire) &&
+                                                       ring->head.load(std::memory_order_acquire) ==
+                                                           ring->tail.load(std::memory_order_relaxed);
+                                            }),
+                             rings_.end());
+                ++passes_;
+            }
+            done_cv_.notify_all();
+        }
+
+        mutable std::mutex mutex_;              // rings_, sites_, passes_, stopping_
+        std::condition_variable wake_cv_;
+        std::condition_variable done_cv_;
+        std::vector<std::shared_ptr<ThreadRing>> rings_;
+        std::vector<const LogSite*> sites_;     // Index is id - 1
+        std::chrono::milliseconds interval_{LogConfig{}.drain_interval};
+        uint32_t next_thread_ = 1;
+        uint64_t passes_ = 0;
+        bool stopping_ = false;
+        std::atomic<bool> wake_pending_{false};
+        std::atomic<uint64_t> written_{0};
+        std::atomic<uint64_t> dropped_{0};
+
+        std::mutex sink_mutex_;
+        std::unique_ptr<LogSink> sink_;
+
+        std::thread thread_;                    // Last: starts once the rest exists
+    };
+
+    /**
+     * @brief The calling thread's ring; retired when the thread exits
+     */
+    struct RingHandle {
+        std::shared_ptr<ThreadRing> ring;
+
+        ~RingHandle() {
+            if (ring) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local RingHandle local_ring;
+}
+
+bool BinaryLog::start(const LogConfig& config) {
+    return Logger::instance().start(config);
+}
+
+void BinaryLog::flush() {
+    if (!closed.load(std::memory_order_relaxed)) {
+        Logger::instance().flush();
+    }
+}
+
+LogStats BinaryLog::stats() noexcept {
+    return Logger::instance().stats();
+}
+
+uint32_t BinaryLog::registerSite(LogSite& site) noexcept {
+    if (closed.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    try {
+        return Logger::instance().registerSite(site);
+    } catch (...) {
+        return 0;
+    }
+}
+
+void BinaryLog::attachThread() noexcept {
+    // The slot is left unpublished
+    (void)reserve();
+}
+
+uint8_t* BinaryLog::reserve() noexcept {
+    if (closed.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    if (!local_ring.ring) {
+        try {
+            local_ring.ring = Logger::instance().attach();
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    ThreadRing& ring = *local_ring.ring;
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_RECORDS) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return ring.slots[head % RING_RECORDS].data();
+}
+
+void BinaryLog::commit(LogLevel level, uint32_t site, uint16_t size,
+                       uint16_t arg_count) noexcept {
+    ThreadRing& ring = *local_ring.ring;
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+    const RecordHeader header{
+        site, size, arg_count, ring.thread, 0,
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count())
+    };
+    std::memcpy(ring.slots[head % RING_RECORDS].data(), &header, sizeof(header));
+    ring.head.store(head + 1, std::memory_order_release);
+
+    if (level >= LogLevel::WARN) {
+        Logger::instance().wake();
+    }
+}
+
+} // namespace qnx::ipc
@@ -0,0 +1,101 @@
+// log_record.cpp
+// Binary log record layout and deferred formatting - Implementation
+#include "log_record.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace qnx::ipc {
+
+namespace {
+    /**
+     * @brief Decode the argument at pos and append it to out
+     * @return Bytes consumed, or 0 if the argument is truncated
+     */
+    size_t appendArg(std::string& out, const uint8_t* pos, const uint8_t* end) {
+        if (pos >= end) {
+            return 0;
+        }
+
+        const auto tag = static_cast<LogArg>(*pos);
+        const uint8_t* data = pos + 1;
+        const auto room = static_cast<size_t>(end - data);
+        char text[32];
+
+        switch (tag) {
+            case LogArg::INT: {
+                int64_t value;
+                if (room < sizeof(value)) return 0;
+                std::memcpy(&value, data, sizeof(value));
+                std::snprintf(text, sizeof(text), "%" PRId64, value);
+                out += text;
+                return 1 + sizeof(value);
+            }
+            case LogArg::UINT: {
+                uint64_t value;
+                if (room < sizeof(value)) return 0;
+                std::memcpy(&value, data, sizeof(value));
+                std::snprintf(text, sizeof(text), "%" PRIu64, value);
+                out += text;
+                return 1 + sizeof(value);
+            }
+            case LogArg::DOUBLE: {
+                double value;
+                if (room < sizeof(value)) return 0;
+                std::memcpy(&value, data, sizeof(value));
+                std::snprintf(text, sizeof(text), "%g", value);
+                out += text;
+                return 1 + sizeof(value);
+            }
+            case LogArg::STRING: {
+                uint16_t length;
+                if (room < sizeof(length)) return 0;
+                std::memcpy(&length, data, sizeof(length));
+                if (room - sizeof(length) < length) return 0;
+                out.append(reinterpret_cast<const char*>(data + sizeof(length)), length);
+                return 1 + sizeof(length) + length;
+            }
+        }
+        return 0;
+    }
+}
+
+const char* levelName(LogLevel level) noexcept {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO:  return "INFO";
+        case LogLevel::WARN:  return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+    }
+    return "?";
+}
+
+std::string formatMessage(std::string_view format, const uint8_t* args,
+                          size_t size, uint16_t arg_count) {
+    std::string out;
+    out.reserve(format.size() + size);
+
+    const uint8_t* pos = args;
+    const uint8_t* end = args + size;
+    uint16_t remaining = arg_count;
+
+    size_t start = 0;
+    for (size_t mark = format.find("{}"); mark != std::string_view::npos;
+         mark = format.find("{}", start)) {
+        out.append(format.substr(start, mark - start));
+        start = mark + 2;
+
+        const size_t used = remaining > 0 ? appendArg(out, pos, end) : 0;
+        if (used == 0) {
+            out += '?';
+            remaining = 0;
+        } else {
+            pos += used;
+            --remaining;
+        }
+    }
+    out.append(format.substr(start));
+    return out;
+}
+
+} // namespace qnx::ipc
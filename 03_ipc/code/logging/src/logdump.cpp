@@ -0,0 +1,172 @@
+// logdump.cpp
+// ipc_logdump: decode a binary log written with LogOutput::FILE
+#include "log_record.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    struct Site {
+        qnx::ipc::LogLevel level;
+        int32_t line;
+        std::string file;
+        std::string format;
+    };
+
+    void printUsage(const char* prog) {
+        std::fprintf(stderr,
+                     "Usage: %s [-s] file\n"
+                     "  -s  Also print the source file:line of each record\n",
+                     prog);
+    }
+
+    bool readSite(const std::vector<uint8_t>& chunk, std::unordered_map<uint32_t, Site>& sites) {
+        uint32_t id;
+        uint8_t level;
+        int32_t line;
+        if (chunk.size() < sizeof(id) + sizeof(level) + sizeof(line) + 2) {
+            return false;
+        }
+
+        const uint8_t* pos = chunk.data();
+        std::memcpy(&id, pos, sizeof(id));
+        pos += sizeof(id);
+        std::memcpy(&level, pos, sizeof(level));
+        pos += sizeof(level);
+        std::memcpy(&line, pos, sizeof(line));
+        pos += sizeof(line);
+
+        const auto* text = reinterpret_cast<const char*>(pos);
+        const size_t text_len = chunk.size() - static_cast<size_t>(pos - chunk.data());
+        const std::string file(text, strnlen(text, text_len));
+        if (file.size() + 1 >= text_len) {
+            return false;
+        }
+        const std::string format(text + file.size() + 1,
+                                 strnlen(text + file.size() + 1, text_len - file.size() - 1));
+
+        sites[id] = Site{static_cast<qnx::ipc::LogLevel>(level), line, file, format};
+        return true;
+    }
+
+    void printRecord(const std::vector<uint8_t>& chunk,
+                     const std::unordered_map<uint32_t, Site>& sites, bool show_source) {
+        using qnx::ipc::RecordHeader;
+
+        RecordHeader header;
+        if (chunk.size() < sizeof(header)) {
+            return;
+        }
+        std::memcpy(&header, chunk.data(), sizeof(header));
+        const size_t args = std::min<size_t>(header.size, chunk.size() - sizeof(header));
+
+        const time_t seconds = static_cast<time_t>(header.timestamp_ns / 1000000000ULL);
+        struct tm local;
+        localtime_r(&seconds, &local);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+
+        const auto it = sites.find(header.site);
+        if (it == sites.end()) {
+            std::printf("%s.%06llu T%-3u ?     <unknown site %u>\n", stamp,
+                        static_cast<unsigned long long>(header.timestamp_ns % 1000000000ULL / 1000),
+                        header.thread, header.site);
+            return;
+        }
+
+        const Site& site = it->second;
+        const std::string message = qnx::ipc::formatMessage(
+            site.format, chunk.data() + sizeof(header), args, header.arg_count);
+        std::printf("%s.%06llu T%-3u %-5s ", stamp,
+                    static_cast<unsigned long long>(header.timestamp_ns % 1000000000ULL / 1000),
+                    header.thread, qnx::ipc::levelName(site.level));
+        if (show_source) {
+            std::printf("%s:%d ", site.file.c_str(), site.line);
+        }
+        std::printf("%s\n", message.c_str());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    using namespace qnx::ipc;
+
+    bool show_source = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s")) != -1) {
+        switch (opt) {
+            case 's': show_source = true; break;
+            default:
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::FILE* file = std::fopen(argv[optind], "rb");
+    if (file == nullptr) {
+        std::perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    LogFileHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != LogFileHeader::MAGIC || header.version != LogFileHeader::VERSION) {
+        std::fprintf(stderr, "Error: %s is not a binary IPC log\n", argv[optind]);
+        std::fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    std::unordered_map<uint32_t, Site> sites;
+    std::vector<uint8_t> chunk;
+    ChunkHeader chunk_header;
+
+    while (std::fread(&chunk_header, sizeof(chunk_header), 1, file) == 1) {
+        chunk.resize(chunk_header.size);
+        if (std::fread(chunk.data(), 1, chunk.size(), file) != chunk.size()) {
+            std::fprintf(stderr, "Warning: log ends in a partial record\n");
+            break;
+        }
+
+        switch (chunk_header.kind) {
+            case LogChunk::SITE:
+                if (!readSite(chunk, sites)) {
+                    std::fprintf(stderr, "Warning: malformed site entry\n");
+                }
+                break;
+
+            case LogChunk::RECORD:
+                printRecord(chunk, sites, show_source);
+                break;
+
+            case LogChunk::DROPPED: {
+                uint32_t thread;
+                uint64_t count;
+                if (chunk.size() >= sizeof(thread) + sizeof(count)) {
+                    std::memcpy(&thread, chunk.data(), sizeof(thread));
+                    std::memcpy(&count, chunk.data() + sizeof(thread), sizeof(count));
+                    std::printf("--- T%u dropped %llu records ---\n", thread,
+                                static_cast<unsigned long long>(count));
+                }
+                break;
+            }
+
+            default:
+                // Newer chunk kinds are skipped
+                break;
+        }
+    }
+
+    std::fclose(file);
+    return EXIT_SUCCESS;
+}
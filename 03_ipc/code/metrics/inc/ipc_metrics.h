@@ -0,0 +1,204 @@
+// ipc_metrics.h
+// Hot-path IPC metrics in a shared-memory region - Header
+#ifndef IPC_METRICS_H
+#define IPC_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Event counters kept per thread
+ *
+ * Receivers and senders share the enum; each fills in what applies.
+ */
+enum class Counter : uint32_t {
+    MESSAGES,               // Handled (receiver) or replied to (sender)
+    PAYLOAD_BYTES,
+    PULSES,
+    REPLY_ERRORS,           // Non-EOK reply status or MsgError()
+    PROTOCOL_ERRORS,        // Malformed header, size or framing
+    SECURITY_VIOLATIONS,    // MsgReceive() refused by secpol
+    SEND_ERRORS,            // MsgSend()/MsgSendPulse() failed
+    PULSE_OVERFLOWS,        // MsgSendPulse() EAGAIN
+    UNTRACKED_TYPES,        // Type/subtype table full; counted here only
+    BUFFER_EXHAUSTED,       // No receive buffer within the pool's cap
+    CREDIT_WAITS,           // Request waited for a flow-control credit
+    CREDIT_REFUSED,         // Would block for lack of credit (try* calls, pulses)
+    CREDIT_OVERRUNS,        // Request beyond the connection's hard credit cap
+    QUOTA_EXCEEDED,         // Request over its client's message rate
+    HOT_PATH_ALLOCS,        // Heap allocations while handling a message (realtime mode)
+    DEADLINE_EXPIRED,       // Request's deadline passed before it was handled
+    SEND_TIMEOUTS,          // Request gave up at its deadline (ETIMEDOUT)
+    REPLY_BYTES,            // Reply payload bytes sent (receiver) or received (sender)
+    SHM_PAYLOADS,           // Messages whose payload was in a shared-memory segment
+    SHM_SEGMENTS,           // Segments mapped (receiver) or handed over (sender)
+    COUNT
+};
+
+constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+
+/// Name of each counter, for tools
+const char* counterName(Counter counter) noexcept;
+
+/// Per-thread slots in one region; extra threads share the last slot
+constexpr size_t METRICS_SLOTS = 64;
+
+/// Distinct type/subtype pairs tracked per slot
+constexpr size_t METRICS_TYPE_ENTRIES = 64;
+
+/**
+ * @brief Log-linear latency buckets: 8 per power of two (12.5% wide)
+ *
+ * Values below 8 ns get a bucket each; the top bucket holds 2^40 ns
+ * (about 18 minutes) and everything above.
+ */
+constexpr size_t LATENCY_BUCKETS = 320;
+
+constexpr size_t latencyBucket(uint64_t value_ns) noexcept {
+    if (value_ns < 8) {
+        return static_cast<size_t>(value_ns);
+    }
+    unsigned magnitude = 63;
+    while ((value_ns >> magnitude) == 0) {
+        --magnitude;
+    }
+    const size_t sub = static_cast<size_t>((value_ns >> (magnitude - 3)) & 7);
+    const size_t index = (magnitude - 2) * 8 + sub;
+    return index < LATENCY_BUCKETS ? index : LATENCY_BUCKETS - 1;
+}
+
+/// Lowest value that falls into a bucket
+constexpr uint64_t latencyBucketFloor(size_t bucket) noexcept {
+    if (bucket < 8) {
+        return bucket;
+    }
+    const unsigned magnitude = static_cast<unsigned>(bucket / 8 + 2);
+    return (8 + uint64_t{bucket % 8}) << (magnitude - 3);
+}
+
+/**
+ * @brief One thread's counters, each group on its own cache lines
+ *
+ * Lives in shared memory; readers sum all slots. Updates are relaxed
+ * atomic adds on lines no other thread writes, so they never contend.
+ */
+struct alignas(64) MetricsSlot {
+    enum EntryState : uint32_t { ENTRY_FREE, ENTRY_CLAIMED, ENTRY_READY };
+
+    struct TypeEntry {
+        std::atomic<uint32_t> state;    // EntryState; key is valid once READY
+        std::atomic<uint32_t> key;      // type << 16 | subtype
+        std::atomic<uint64_t> count;
+    };
+
+    std::atomic<uint32_t> owned;
+    alignas(64) std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters;
+    alignas(64) std::array<TypeEntry, METRICS_TYPE_ENTRIES> types;
+    alignas(64) std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> latency;
+};
+
+/**
+ * @brief Fixed header of the shared region, followed by the slots
+ */
+struct MetricsRegion {
+    static constexpr uint32_t MAGIC = 0x49504D53;   // "IPMS"
+    static constexpr uint32_t VERSION = 8;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    int32_t pid;
+    char name[48];
+    alignas(64) std::array<MetricsSlot, METRICS_SLOTS> slots;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "metrics counters must be lock-free to live in shared memory");
+
+/**
+ * @brief Writer side: a named region this process updates
+ *
+ * The region is a POSIX shared memory object (see shmName()) that tools
+ * such as ipc_stats map read-only, so reading never touches the hot path.
+ * Each thread claims a slot on first use and gives it back on exit; the
+ * counts stay, so totals survive worker pool threads coming and going.
+ */
+class IpcMetrics {
+public:
+    /**
+     * @brief Create (or replace) the region for name
+     * @return nullptr if the shared memory object cannot be created
+     */
+    static std::shared_ptr<IpcMetrics> create(std::string_view name);
+
+    // Prevent copying and moving (threads hold leases on the mapping)
+    IpcMetrics(const IpcMetrics&) = delete;
+    IpcMetrics& operator=(const IpcMetrics&) = delete;
+
+    ~IpcMetrics();
+
+    void add(Counter counter, uint64_t amount = 1) noexcept;
+    void countMessage(uint16_t type, uint16_t subtype) noexcept;
+    void recordLatency(uint64_t value_ns) noexcept;
+
+    /**
+     * @brief Shared memory object name for a metrics name
+     */
+    static std::string shmName(std::string_view name);
+
+private:
+    class Mapping;
+
+    explicit IpcMetrics(std::shared_ptr<Mapping> mapping, std::string shm_name) noexcept;
+
+    std::shared_ptr<Mapping> mapping_;
+    std::string shm_name_;
+
+    MetricsSlot& local() noexcept;
+};
+
+/**
+ * @brief Reader side: totals across all slots of a region
+ */
+struct MetricsSnapshot {
+    struct TypeCount {
+        uint16_t type;
+        uint16_t subtype;
+        uint64_t count;
+    };
+
+    std::string name;
+    int32_t pid;
+    std::array<uint64_t, COUNTER_COUNT> counters;
+    std::vector<TypeCount> types;                   // Most frequent first
+    std::array<uint64_t, LATENCY_BUCKETS> latency;
+
+    /**
+     * @brief Map the region read-only and sum it
+     * @return std::nullopt if it does not exist or is not a metrics region
+     */
+    static std::optional<MetricsSnapshot> read(std::string_view name);
+
+    [[nodiscard]] uint64_t counter(Counter which) const noexcept {
+        return counters[static_cast<size_t>(which)];
+    }
+    [[nodiscard]] uint64_t latencyCount() const noexcept;
+
+    /**
+     * @brief Upper edge of the bucket holding the percentile, in ns
+     */
+    [[nodiscard]] uint64_t latencyPercentile(double percent) const noexcept;
+};
+
+} // namespace qnx::ipc
+
+#endif // IPC_METRICS_H
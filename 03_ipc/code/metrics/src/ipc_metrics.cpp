@@ -0,0 +1,299 @@
+// ipc_metrics.cpp
+// Hot-path IPC metrics - Implementation
+#include "ipc_metrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace qnx::ipc {
+
+namespace {
+    constexpr const char* SHM_PREFIX = "/ipc_stats.";
+
+    // Probes before a type/subtype pair is counted as untracked
+    constexpr size_t TYPE_PROBES = 8;
+
+    constexpr std::array<const char*, COUNTER_COUNT> COUNTER_NAMES = {
+        "messages",
+        "payload_bytes",
+        "pulses",
+        "reply_errors",
+        "protocol_errors",
+        "security_violations",
+        "send_errors",
+        "pulse_overflows",
+        "untracked_types",
+        "buffer_exhausted",
+        "credit_waits",
+        "credit_refused",
+        "credit_overruns",
+        "quota_exceeded",
+        "hot_path_allocs",
+        "deadline_expired",
+        "send_timeouts",
+        "reply_bytes",
+        "shm_payloads",
+        "shm_segments",
+    };
+
+    size_t typeHash(uint32_t key) noexcept {
+        return (key * 2654435761u) % METRICS_TYPE_ENTRIES;
+    }
+
+    /**
+     * @brief The calling thread's claim on a slot
+     *
+     * Holds the mapping so a thread that outlives the IpcMetrics object
+     * can still release its slot safely.
+     */
+    struct SlotLease {
+        std::shared_ptr<const void> mapping;
+        MetricsSlot* slot = nullptr;
+        bool exclusive = false;
+
+        ~SlotLease() { release(); }
+
+        void release() noexcept {
+            if (slot != nullptr && exclusive) {
+                slot->owned.store(0, std::memory_order_release);
+            }
+            slot = nullptr;
+            exclusive = false;
+            mapping.reset();
+        }
+    };
+
+    thread_local SlotLease lease;
+}
+
+/**
+ * @brief Owns the mmap() of the region
+ */
+class IpcMetrics::Mapping {
+public:
+    explicit Mapping(MetricsRegion* region) noexcept : region_(region) {}
+    ~Mapping() { munmap(region_, sizeof(MetricsRegion)); }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    [[nodiscard]] MetricsRegion& region() const noexcept { return *region_; }
+
+private:
+    MetricsRegion* region_;
+};
+
+const char* counterName(Counter counter) noexcept {
+    const auto index = static_cast<size_t>(counter);
+    return index < COUNTER_COUNT ? COUNTER_NAMES[index] : "unknown";
+}
+
+std::string IpcMetrics::shmName(std::string_view name) {
+    std::string shm_name = SHM_PREFIX + std::string(name);
+    std::replace(shm_name.begin() + 1, shm_name.end(), '/', '_');
+    return shm_name;
+}
+
+std::shared_ptr<IpcMetrics> IpcMetrics::create(std::string_view name) {
+    const std::string shm_name = shmName(name);
+
+    // A previous run's region would hold stale totals
+    shm_unlink(shm_name.c_str());
+
+    const int fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd == -1) {
+        std::cerr << "Error: metrics shm_open failed: " << std::strerror(errno) << "\n";
+        return nullptr;
+    }
+
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, sizeof(MetricsRegion)) == 0) {
+        base = mmap(nullptr, sizeof(MetricsRegion), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Error: metrics mapping failed: " << std::strerror(errno) << "\n";
+        shm_unlink(shm_name.c_str());
+        return nullptr;
+    }
+
+    // The object starts zero-filled: every counter and slot is already clear
+    auto* region = static_cast<MetricsRegion*>(base);
+    region->version = MetricsRegion::VERSION;
+    region->slot_count = METRICS_SLOTS;
+    region->pid = static_cast<int32_t>(getpid());
+    std::strncpy(region->name, std::string(name).c_str(), sizeof(region->name) - 1);
+    std::atomic_thread_fence(std::memory_order_release);
+    region->magic = MetricsRegion::MAGIC;
+
+    return std::shared_ptr<IpcMetrics>(
+        new IpcMetrics(std::make_shared<Mapping>(region), shm_name));
+}
+
+IpcMetrics::IpcMetrics(std::shared_ptr<Mapping> mapping, std::string shm_name) noexcept
+    : mapping_(std::move(mapping)),
+      shm_name_(std::move(shm_name)) {}
+
+IpcMetrics::~IpcMetrics() {
+    shm_unlink(shm_name_.c_str());
+}
+
+MetricsSlot& IpcMetrics::local() noexcept {
+    if (lease.mapping.get() == mapping_.get()) {
+        return *lease.slot;
+    }
+
+    lease.release();
+    auto& slots = mapping_->region().slots;
+
+    // The last slot is shared by threads that find no free one
+    lease.slot = &slots.back();
+    for (size_t i = 0; i + 1 < slots.size(); ++i) {
+        uint32_t expected = 0;
+        if (slots[i].owned.compare_exchange_strong(expected, 1,
+                                                   std::memory_order_acquire)) {
+            lease.slot = &slots[i];
+            lease.exclusive = true;
+            break;
+        }
+    }
+    lease.mapping = mapping_;
+    return *lease.slot;
+}
+
+void IpcMetrics::add(Counter counter, uint64_t amount) noexcept {
+    local().counters[static_cast<size_t>(counter)].fetch_add(
+        amount, std::memory_order_relaxed);
+}
+
+void IpcMetrics::countMessage(uint16_t type, uint16_t subtype) noexcept {
+    MetricsSlot& slot = local();
+    const uint32_t key = (uint32_t{type} << 16) | subtype;
+
+    size_t index = typeHash(key);
+    for (size_t probe = 0; probe < TYPE_PROBES; ++probe) {
+        auto& entry = slot.types[index];
+        uint32_t state = entry.state.load(std::memory_order_acquire);
+
+        if (state == MetricsSlot::ENTRY_FREE &&
+            entry.state.compare_exchange_strong(state, MetricsSlot::ENTRY_CLAIMED,
+                                                std::memory_order_acquire)) {
+            entry.key.store(key, std::memory_order_relaxed);
+            entry.count.fetch_add(1, std::memory_order_relaxed);
+            entry.state.store(MetricsSlot::ENTRY_READY, std::memory_order_release);
+            return;
+        }
+        if (state == MetricsSlot::ENTRY_READY &&
+            entry.key.load(std::memory_order_relaxed) == key) {
+            entry.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        index = (index + 1) % METRICS_TYPE_ENTRIES;
+    }
+
+    add(Counter::UNTRACKED_TYPES);
+}
+
+void IpcMetrics::recordLatency(uint64_t value_ns) noexcept {
+    local().latency[latencyBucket(value_ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::optional<MetricsSnapshot> MetricsSnapshot::read(std::string_view name) {
+    const std::string shm_name = IpcMetrics::shmName(name);
+    const int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+
+    struct stat info;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &info) == 0 &&
+        static_cast<size_t>(info.st_size) >= sizeof(MetricsRegion)) {
+        base = mmap(nullptr, sizeof(MetricsRegion), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    const auto& region = *static_cast<const MetricsRegion*>(base);
+    std::optional<MetricsSnapshot> snapshot;
+
+    if (region.magic == MetricsRegion::MAGIC &&
+        region.version == MetricsRegion::VERSION &&
+        region.slot_count == METRICS_SLOTS) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        MetricsSnapshot totals{};
+        totals.name = std::string(region.name, strnlen(region.name, sizeof(region.name)));
+        totals.pid = region.pid;
+
+        std::unordered_map<uint32_t, uint64_t> types;
+        for (const auto& slot : region.slots) {
+            for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+                totals.counters[i] += slot.counters[i].load(std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+                totals.latency[i] += slot.latency[i].load(std::memory_order_relaxed);
+            }
+            for (const auto& entry : slot.types) {
+                if (entry.state.load(std::memory_order_acquire) == MetricsSlot::ENTRY_READY) {
+                    types[entry.key.load(std::memory_order_relaxed)] +=
+                        entry.count.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        for (const auto& [key, count] : types) {
+            totals.types.push_back(TypeCount{static_cast<uint16_t>(key >> 16),
+                                             static_cast<uint16_t>(key), count});
+        }
+        std::sort(totals.types.begin(), totals.types.end(),
+                  [](const TypeCount& a, const TypeCount& b) { return a.count > b.count; });
+
+        snapshot = std::move(totals);
+    }
+
+    munmap(base, sizeof(MetricsRegion));
+    return snapshot;
+}
+
+uint64_t MetricsSnapshot::latencyCount() const noexcept {
+    uint64_t total = 0;
+    for (const uint64_t count : latency) {
+        total += count;
+    }
+    return total;
+}
+
+uint64_t MetricsSnapshot::latencyPercentile(double percent) const noexcept {
+    const uint64_t total = latencyCount();
+    if (total == 0) {
+        return 0;
+    }
+
+    const double clamped = std::clamp(percent, 0.0, 100.0);
+    const uint64_t target = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * total)));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+        seen += latency[i];
+        if (seen >= target) {
+            return i + 1 < LATENCY_BUCKETS ? latencyBucketFloor(i + 1) - 1
+                                           : latencyBucketFloor(i);
+        }
+    }
+    return latencyBucketFloor(LATENCY_BUCKETS - 1);
+}
+
+} // namespace qnx::ipc
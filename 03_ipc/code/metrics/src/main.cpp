@@ -0,0 +1,109 @@
+// main.cpp
+// ipc_stats: print the metrics region of a receiver or sender
+#include "ipc_metrics.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    constexpr const char* DEFAULT_NAME = "qnx_receiver_secure";
+    constexpr size_t TOP_TYPES = 10;
+
+    void printUsage(const char* prog) {
+        std::fprintf(stderr,
+                     "Usage: %s [-j] [-w seconds] [name]\n"
+                     "  name  Receiver name or sender id (default %s)\n"
+                     "  -j    Print JSON instead of a table\n"
+                     "  -w    Repeat every N seconds\n",
+                     prog, DEFAULT_NAME);
+    }
+
+    void printTable(const qnx::ipc::MetricsSnapshot& s) {
+        using qnx::ipc::Counter;
+
+        std::printf("%s (pid %d)\n", s.name.c_str(), s.pid);
+        for (size_t i = 0; i < qnx::ipc::COUNTER_COUNT; ++i) {
+            std::printf("  %-20s %llu\n", qnx::ipc::counterName(static_cast<Counter>(i)),
+                        static_cast<unsigned long long>(s.counters[i]));
+        }
+
+        std::printf("  latency ns           n=%llu p50=%llu p90=%llu p99=%llu p99.9=%llu\n",
+                    static_cast<unsigned long long>(s.latencyCount()),
+                    static_cast<unsigned long long>(s.latencyPercentile(50.0)),
+                    static_cast<unsigned long long>(s.latencyPercentile(90.0)),
+                    static_cast<unsigned long long>(s.latencyPercentile(99.0)),
+                    static_cast<unsigned long long>(s.latencyPercentile(99.9)));
+
+        std::printf("  %-8s %-8s %s\n", "type", "subtype", "messages");
+        for (size_t i = 0; i < s.types.size() && i < TOP_TYPES; ++i) {
+            std::printf("  %-8u %-8u %llu\n", s.types[i].type, s.types[i].subtype,
+                        static_cast<unsigned long long>(s.types[i].count));
+        }
+    }
+
+    void printJson(const qnx::ipc::MetricsSnapshot& s) {
+        using qnx::ipc::Counter;
+
+        std::printf("{\"name\": \"%s\", \"pid\": %d, \"counters\": {", s.name.c_str(), s.pid);
+        for (size_t i = 0; i < qnx::ipc::COUNTER_COUNT; ++i) {
+            std::printf("%s\"%s\": %llu", i ? ", " : "",
+                        qnx::ipc::counterName(static_cast<Counter>(i)),
+                        static_cast<unsigned long long>(s.counters[i]));
+        }
+        std::printf("}, \"latency_ns\": {\"count\": %llu, \"p50\": %llu, \"p90\": %llu, "
+                    "\"p99\": %llu, \"p99_9\": %llu}, \"types\": [",
+                    static_cast<unsigned long long>(s.latencyCount()),
+                    static_cast<unsigned long long>(s.latencyPercentile(50.0)),
+                    static_cast<unsigned long long>(s.latencyPercentile(90.0)),
+                    static_cast<unsigned long long>(s.latencyPercentile(99.0)),
+                    static_cast<unsigned long long>(s.latencyPercentile(99.9)));
+        for (size_t i = 0; i < s.types.size(); ++i) {
+            std::printf("%s{\"type\": %u, \"subtype\": %u, \"count\": %llu}", i ? ", " : "",
+                        s.types[i].type, s.types[i].subtype,
+                        static_cast<unsigned long long>(s.types[i].count));
+        }
+        std::printf("]}\n");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    int interval = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "jw:")) != -1) {
+        switch (opt) {
+            case 'j': json = true; break;
+            case 'w': interval = std::atoi(optarg); break;
+            default:
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    const std::string name = optind < argc ? argv[optind] : DEFAULT_NAME;
+
+    while (true) {
+        const auto snapshot = qnx::ipc::MetricsSnapshot::read(name);
+        if (!snapshot) {
+            std::fprintf(stderr, "Error: No metrics for '%s' (%s)\n", name.c_str(),
+                         qnx::ipc::IpcMetrics::shmName(name).c_str());
+            return EXIT_FAILURE;
+        }
+
+        if (json) {
+            printJson(*snapshot);
+        } else {
+            printTable(*snapshot);
+        }
+        std::fflush(stdout);
+
+        if (interval <= 0) {
+            return EXIT_SUCCESS;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(interval));
+    }
+}
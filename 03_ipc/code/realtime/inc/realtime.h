@@ -0,0 +1,134 @@
+// realtime.h
+// Realtime startup: memory locking, prefaulting, CPU pinning - Header
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <sched.h>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Settings of the realtime mode (receiver/sender -R)
+ *
+ * In realtime mode the process locks its memory, every realtime thread
+ * touches its stack up front and runs with a fixed policy and priority,
+ * optionally pinned to a CPU, and allocations on the hot path after
+ * startup are counted and reported.
+ */
+struct RealtimeConfig {
+    bool enabled = false;
+    int policy = SCHED_FIFO;            // SCHED_FIFO, SCHED_RR or SCHED_OTHER
+    int priority = 0;                   // 0 keeps the thread's priority
+    std::vector<int> cpus;              // Threads go round-robin over these; empty: no pinning
+    size_t stack_bytes = 64 * 1024;     // Stack each realtime thread touches up front
+};
+
+/**
+ * @brief Parse "policy[:priority][@cpu,cpu...]", e.g. "fifo:40@2,3"
+ *
+ * policy is fifo, rr or other; the result has enabled set.
+ * @return std::nullopt if spec is malformed
+ */
+[[nodiscard]] std::optional<RealtimeConfig> parseRealtimeSpec(std::string_view spec);
+
+/**
+ * @brief "fifo", "rr" or "other"
+ */
+[[nodiscard]] const char* policyName(int policy) noexcept;
+
+/**
+ * @brief Lock all current and future memory of the process (mlockall())
+ *
+ * Needs PROCMGR_AID_MEM_LOCK on QNX, CAP_IPC_LOCK or a large enough
+ * RLIMIT_MEMLOCK on Linux.
+ * @return false with errno set on failure
+ */
+bool lockMemory() noexcept;
+
+/**
+ * @brief Touch bytes of the calling thread's stack so it is mapped now
+ */
+void prefaultStack(size_t bytes) noexcept;
+
+/**
+ * @brief Make the calling thread a realtime thread
+ *
+ * Sets the policy and priority, pins the thread to the next of cpus in
+ * turn (a runmask on QNX, the affinity mask on Linux) and prefaults its
+ * stack.
+ * @param priority Overrides config.priority when non-zero (lane priority)
+ * @return false if the policy, priority or CPU could not be set; the
+ *         thread keeps running with whatever did apply
+ */
+bool enterRealtimeThread(const RealtimeConfig& config, int priority = 0) noexcept;
+
+/**
+ * @brief Allocations made on the hot path since armHotPathWatch()
+ */
+struct HotPathStats {
+    uint64_t allocations;
+    uint64_t bytes;
+    size_t largest;
+};
+
+/**
+ * @brief Marks the calling thread as on the hot path while it exists
+ *
+ * Nests. Costs a thread-local increment; allocations are only counted
+ * when the allocation_hook library is linked and the watch is armed.
+ */
+class HotPathScope {
+public:
+    HotPathScope() noexcept;
+    ~HotPathScope();
+
+    HotPathScope(const HotPathScope&) = delete;
+    HotPathScope& operator=(const HotPathScope&) = delete;
+};
+
+/**
+ * @brief Exempts one-off setup inside a HotPathScope (a connection's
+ *        first message) from the count
+ */
+class HotPathExempt {
+public:
+    HotPathExempt() noexcept;
+    ~HotPathExempt();
+
+    HotPathExempt(const HotPathExempt&) = delete;
+    HotPathExempt& operator=(const HotPathExempt&) = delete;
+
+private:
+    int saved_;
+};
+
+/**
+ * @brief Start counting hot-path allocations; call once startup is done
+ */
+void armHotPathWatch() noexcept;
+
+/**
+ * @brief Whether allocations can be seen at all (allocation_hook linked)
+ */
+[[nodiscard]] bool hotPathWatchAvailable() noexcept;
+
+[[nodiscard]] HotPathStats hotPathStats() noexcept;
+
+/**
+ * @brief Called by allocation_hook for every operator new
+ */
+void noteAllocation(size_t bytes) noexcept;
+
+/**
+ * @brief Called once by allocation_hook when it is linked in
+ */
+void markAllocationHook() noexcept;
+
+} // namespace qnx::ipc
+
+#endif // REALTIME_H
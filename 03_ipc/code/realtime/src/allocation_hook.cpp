@@ -0,0 +1,84 @@
+// allocation_hook.cpp
+// Global operator new/delete that report hot-path allocations - Implementation
+//
+// Every form is replaced, so no pointer from one allocator is ever freed
+// by another. Allocation itself is left to malloc().
+#include "realtime.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    void* allocate(size_t size) {
+        qnx::ipc::noteAllocation(size);
+        void* p = std::malloc(size == 0 ? 1 : size);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    void* allocate(size_t size, std::align_val_t align) {
+        qnx::ipc::noteAllocation(size);
+        void* p = nullptr;
+        const size_t alignment = std::max(static_cast<size_t>(align), sizeof(void*));
+        if (posix_memalign(&p, alignment, size == 0 ? 1 : size) != 0) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    struct Installed {
+        Installed() noexcept { qnx::ipc::markAllocationHook(); }
+    } installed;
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t align) { return allocate(size, align); }
+void* operator new[](size_t size, std::align_val_t align) { return allocate(size, align); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
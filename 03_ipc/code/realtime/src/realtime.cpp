@@ -0,0 +1,209 @@
+// realtime.cpp
+// Realtime startup: memory locking, prefaulting, CPU pinning - Implementation
+#include "realtime.h"
+
+#include <algorithm>
+#include <alloca.h>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __QNXNTO__
+#include <sys/neutrino.h>
+#endif
+
+namespace qnx::ipc {
+
+namespace {
+    // Depth of HotPathScope on this thread; trivially initialised, so the
+    // allocation hook may read it at any time
+    thread_local int t_hot_path = 0;
+
+    std::atomic<unsigned> g_next_cpu{0};
+    std::atomic<bool> g_hooked{false};
+    std::atomic<bool> g_armed{false};
+    std::atomic<uint64_t> g_allocations{0};
+    std::atomic<uint64_t> g_bytes{0};
+    std::atomic<size_t> g_largest{0};
+
+    std::optional<int> parsePolicy(std::string_view name) {
+        if (name == "fifo") {
+            return SCHED_FIFO;
+        }
+        if (name == "rr") {
+            return SCHED_RR;
+        }
+        if (name == "other") {
+            return SCHED_OTHER;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<int> parseNumber(std::string_view text) {
+        int value = 0;
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc() || end != text.data() + text.size() || value < 0) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    bool pinToCpu(int cpu) noexcept {
+#ifdef __QNXNTO__
+        // The runmask is one bit per CPU
+        if (cpu >= 32) {
+            errno = EINVAL;
+            return false;
+        }
+        return ThreadCtl(_NTO_TCTL_RUNMASK,
+                         reinterpret_cast<void*>(static_cast<uintptr_t>(1u << cpu))) != -1;
+#else
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        errno = error;
+        return error == 0;
+#endif
+    }
+
+    bool setScheduling(int policy, int priority) noexcept {
+        int current_policy;
+        sched_param param{};
+        if (pthread_getschedparam(pthread_self(), &current_policy, &param) != 0) {
+            return false;
+        }
+        // A SCHED_OTHER thread on Linux reports priority 0, which FIFO and RR
+        // do not accept: keep the priority within the new policy's range
+        if (priority != 0) {
+            param.sched_priority = priority;
+        }
+        param.sched_priority = std::clamp(param.sched_priority,
+                                          sched_get_priority_min(policy),
+                                          sched_get_priority_max(policy));
+        const int error = pthread_setschedparam(pthread_self(), policy, &param);
+        errno = error;
+        return error == 0;
+    }
+}
+
+std::optional<RealtimeConfig> parseRealtimeSpec(std::string_view spec) {
+    RealtimeConfig config;
+    config.enabled = true;
+
+    const size_t at = spec.find('@');
+    std::string_view scheduling = spec.substr(0, at);
+    if (at != std::string_view::npos) {
+        std::string_view cpus = spec.substr(at + 1);
+        while (!cpus.empty()) {
+            const size_t comma = cpus.find(',');
+            const auto cpu = parseNumber(cpus.substr(0, comma));
+            if (!cpu) {
+                return std::nullopt;
+            }
+            config.cpus.push_back(*cpu);
+            cpus = (comma == std::string_view::npos) ? std::string_view() : cpus.substr(comma + 1);
+        }
+        if (config.cpus.empty()) {
+            return std::nullopt;
+        }
+    }
+
+    const size_t colon = scheduling.find(':');
+    const auto policy = parsePolicy(scheduling.substr(0, colon));
+    if (!policy) {
+        return std::nullopt;
+    }
+    config.policy = *policy;
+    if (colon != std::string_view::npos) {
+        const auto priority = parseNumber(scheduling.substr(colon + 1));
+        if (!priority) {
+            return std::nullopt;
+        }
+        config.priority = *priority;
+    }
+    return config;
+}
+
+const char* policyName(int policy) noexcept {
+    switch (policy) {
+        case SCHED_FIFO: return "fifo";
+        case SCHED_RR: return "rr";
+        default: return "other";
+    }
+}
+
+bool lockMemory() noexcept {
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
+
+void prefaultStack(size_t bytes) noexcept {
+    const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto* stack = static_cast<volatile char*>(alloca(bytes));
+    for (size_t offset = 0; offset < bytes; offset += page) {
+        stack[offset] = 0;
+    }
+}
+
+bool enterRealtimeThread(const RealtimeConfig& config, int priority) noexcept {
+    bool ok = setScheduling(config.policy, priority != 0 ? priority : config.priority);
+    if (!config.cpus.empty()) {
+        const unsigned index = g_next_cpu.fetch_add(1, std::memory_order_relaxed);
+        ok = pinToCpu(config.cpus[index % config.cpus.size()]) && ok;
+    }
+    prefaultStack(config.stack_bytes);
+    return ok;
+}
+
+HotPathScope::HotPathScope() noexcept {
+    ++t_hot_path;
+}
+
+HotPathScope::~HotPathScope() {
+    --t_hot_path;
+}
+
+HotPathExempt::HotPathExempt() noexcept : saved_(t_hot_path) {
+    t_hot_path = 0;
+}
+
+HotPathExempt::~HotPathExempt() {
+    t_hot_path = saved_;
+}
+
+void armHotPathWatch() noexcept {
+    g_armed.store(true, std::memory_order_release);
+}
+
+bool hotPathWatchAvailable() noexcept {
+    return g_hooked.load(std::memory_order_acquire);
+}
+
+HotPathStats hotPathStats() noexcept {
+    return HotPathStats{
+        g_allocations.load(std::memory_order_relaxed),
+        g_bytes.load(std::memory_order_relaxed),
+        g_largest.load(std::memory_order_relaxed)
+    };
+}
+
+void noteAllocation(size_t bytes) noexcept {
+    if (t_hot_path == 0 || !g_armed.load(std::memory_order_relaxed)) {
+        return;
+    }
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    size_t largest = g_largest.load(std::memory_order_relaxed);
+    while (bytes > largest &&
+           !g_largest.compare_exchange_weak(largest, bytes, std::memory_order_relaxed)) {
+    }
+}
+
+void markAllocationHook() noexcept {
+    g_hooked.store(true, std::memory_order_release);
+}
+
+} // namespace qnx::ipc
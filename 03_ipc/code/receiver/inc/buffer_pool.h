@@ -0,0 +1,187 @@
+// buffer_pool.h
+// Size-classed receive buffer pool with per-thread free lists - Header
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace qnx::ipc {
+
+/// Smallest and largest buffer handed out (power-of-two size classes)
+constexpr size_t BUFFER_MIN_SIZE = 1024;
+constexpr size_t BUFFER_MAX_SIZE = 8 * 1024 * 1024;
+constexpr size_t BUFFER_CLASS_COUNT = 14;    // 1 KB .. 8 MB
+
+static_assert((BUFFER_MIN_SIZE << (BUFFER_CLASS_COUNT - 1)) == BUFFER_MAX_SIZE,
+              "size classes must span BUFFER_MIN_SIZE..BUFFER_MAX_SIZE");
+
+/**
+ * @brief What happens when a buffer is needed and the cap is reached
+ */
+enum class ExhaustionPolicy {
+    BLOCK,      // Wait up to block_timeout for a buffer, then reject
+    REJECT,     // Fail at once; the receiver replies EAGAIN
+    DROP        // Fail at once; the receiver discards the message and replies EOK
+};
+
+/**
+ * @brief Buffer pool limits and behaviour
+ */
+struct BufferPoolConfig {
+    size_t max_bytes = 64 * 1024 * 1024;    // Hard cap on slab memory
+    ExhaustionPolicy policy = ExhaustionPolicy::BLOCK;
+    std::chrono::milliseconds block_timeout{100};
+    bool prefill = true;    // Allocate one slab per small class up front
+};
+
+/**
+ * @brief Buffer pool counters since the pool was created
+ */
+struct BufferPoolStats {
+    uint64_t acquired;          // Buffers handed out
+    uint64_t cache_hits;        // ... straight from the thread's free list
+    uint64_t blocked;           // Acquires that had to wait (BLOCK)
+    uint64_t exhausted;         // Acquires refused at the cap
+    size_t reserved_bytes;      // Slab memory allocated, at most max_bytes
+    size_t in_use_bytes;        // Held by handles right now
+    size_t high_water_bytes;    // Peak of in_use_bytes
+
+    [[nodiscard]] double hitRate() const noexcept {
+        return acquired ? static_cast<double>(cache_hits) / acquired : 0.0;
+    }
+};
+
+class BufferPool;
+class BufferCache;
+
+/**
+ * @brief Move-only ownership of one pooled buffer
+ *
+ * Returns the buffer to the pool when destroyed or reset(). A handler
+ * that needs the payload after it returns moves the handle away; the
+ * buffer then goes back to its thread's free list from wherever it is
+ * released. Must not outlive the pool.
+ */
+class BufferHandle {
+public:
+    BufferHandle() noexcept = default;
+    BufferHandle(BufferHandle&& other) noexcept;
+    BufferHandle& operator=(BufferHandle&& other) noexcept;
+    BufferHandle(const BufferHandle&) = delete;
+    BufferHandle& operator=(const BufferHandle&) = delete;
+    ~BufferHandle() { reset(); }
+
+    void reset() noexcept;
+
+    [[nodiscard]] char* data() const noexcept { return data_; }
+    [[nodiscard]] size_t capacity() const noexcept {
+        return data_ ? BUFFER_MIN_SIZE << size_class_ : 0;
+    }
+    explicit operator bool() const noexcept { return data_ != nullptr; }
+
+private:
+    friend class BufferPool;
+
+    BufferHandle(BufferCache* cache, char* data, uint8_t size_class) noexcept
+        : cache_(cache), data_(data), size_class_(size_class) {}
+
+    BufferCache* cache_ = nullptr;
+    char* data_ = nullptr;
+    uint8_t size_class_ = 0;
+};
+
+/**
+ * @brief Pool of receive buffers for payloads too large to receive inline
+ *
+ * Buffers come in power-of-two size classes carved from slabs. Slabs are
+ * pre-faulted (every page touched) when allocated, so copying a message
+ * into a fresh buffer takes no page faults, and are kept until the pool
+ * is destroyed; their total never exceeds max_bytes.
+ *
+ * Each receive thread attaches a BufferCache: per-class free lists only
+ * that thread touches, so acquiring and releasing there takes no lock.
+ * A buffer released on another thread is pushed onto the owner's
+ * lock-free return list and collected on its next miss. Only refills
+ * from the shared lists and new slabs take the pool mutex; caches hold at
+ * most CACHE_BYTES per class before spilling back.
+ */
+class BufferPool {
+public:
+    /// Free bytes per class a thread keeps before returning buffers to the pool
+    static constexpr size_t CACHE_BYTES = 256 * 1024;
+
+    explicit BufferPool(const BufferPoolConfig& config = {});
+
+    // Prevent copying and moving (caches and handles point at the pool)
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    ~BufferPool();
+
+    /**
+     * @brief Claim a cache for the calling thread
+     */
+    [[nodiscard]] BufferCache* attach();
+
+    /**
+     * @brief Give a thread's cache back; its free buffers return to the pool
+     */
+    void detach(BufferCache* cache) noexcept;
+
+    /**
+     * @brief Get a buffer of at least size bytes
+     * @param cache The calling thread's cache, from attach()
+     * @return Empty handle if size exceeds BUFFER_MAX_SIZE or the pool is
+     *         exhausted (after waiting, with ExhaustionPolicy::BLOCK)
+     */
+    [[nodiscard]] BufferHandle acquire(BufferCache& cache, size_t size);
+
+    /**
+     * @brief Stock a cache with buffers of every class up to max_size
+     *
+     * For realtime threads, so their first large message takes no slab
+     * allocation. Waits like acquire() when the cap is reached.
+     * @return false if the pool could not supply every class
+     */
+    bool warm(BufferCache& cache, size_t max_size);
+
+    [[nodiscard]] const BufferPoolConfig& config() const noexcept { return config_; }
+    [[nodiscard]] BufferPoolStats stats() const;
+
+private:
+    friend class BufferHandle;
+    friend class BufferCache;
+
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    BufferPoolConfig config_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::array<FreeNode*, BUFFER_CLASS_COUNT> free_{};     // Shared lists (mutex_)
+    std::vector<void*> slabs_;                              // mutex_
+    std::vector<std::unique_ptr<BufferCache>> caches_;      // mutex_
+    size_t reserved_bytes_ = 0;                             // mutex_
+    std::atomic<size_t> in_use_bytes_{0};
+    std::atomic<size_t> high_water_bytes_{0};
+    std::atomic<unsigned> waiters_{0};
+
+    [[nodiscard]] bool refill(BufferCache& cache, size_t size_class);
+    [[nodiscard]] bool addSlab(size_t size_class);
+    void release(BufferCache& cache, char* data, size_t size_class) noexcept;
+    void spill(BufferCache& cache, size_t size_class, size_t keep) noexcept;
+    void pushShared(FreeNode* node, size_t size_class) noexcept;
+};
+
+} // namespace qnx::ipc
+
+#endif // BUFFER_POOL_H
@@ -0,0 +1,186 @@
+// client_table.h
+// Per-connection client identity cache and accounting - Header
+#ifndef CLIENT_TABLE_H
+#define CLIENT_TABLE_H
+
+#include "shm_segment.h"
+#include "transport.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Who is behind one connection, looked up once when it is first seen
+ */
+struct ClientIdentity {
+    int scoid;
+    ClientCredentials credentials;
+    std::string program;        // Executable name, empty if unknown
+};
+
+/**
+ * @brief Decides once per connection whether its messages are handled
+ *
+ * secpol has already let the client connect; this narrows it further
+ * (e.g. by user id). Runs on a receiving thread, so it must not block.
+ */
+using ClientAuthorizer = std::function<bool(const ClientIdentity& client)>;
+
+/**
+ * @brief What every connection is held to
+ */
+struct ClientPolicy {
+    ClientAuthorizer authorize;     // nullptr: every connection is authorized
+    uint32_t max_rate = 0;          // Messages/sec per connection; 0 = unlimited
+    uint32_t burst = 16;            // Messages allowed at once above max_rate
+};
+
+/**
+ * @brief Counters of one connection
+ */
+struct ClientStats {
+    ClientIdentity identity;
+    bool authorized;
+    uint64_t messages;          // Handled requests (batch envelopes count once)
+    uint64_t bytes;             // Their payload bytes
+    uint64_t pulses;            // Telemetry and application pulses
+    uint64_t denied;            // Refused with EPERM: not authorized
+    uint64_t throttled;         // Refused with EAGAIN: over max_rate
+    uint64_t expired;           // Refused with ETIMEDOUT: deadline passed on arrival
+};
+
+/**
+ * @brief One connection's cached identity and counters
+ *
+ * Shared between the table and the workers handling its messages, so a
+ * disconnect can drop the entry while a message is still being handled.
+ * Counters are relaxed atomics; the rate limit is a lock-free GCRA
+ * (virtual scheduling) on one timestamp. The shared-memory segments the
+ * client sends payloads in stay mapped as long as the entry.
+ */
+class ClientEntry {
+public:
+    ClientEntry(ClientIdentity identity, bool authorized) noexcept
+        : identity_(std::move(identity)), authorized_(authorized) {}
+
+    [[nodiscard]] const ClientIdentity& identity() const noexcept { return identity_; }
+    [[nodiscard]] bool authorized() const noexcept { return authorized_; }
+
+    /**
+     * @brief Take one message from the connection's rate allowance
+     * @param interval_ns 1e9 / max_rate
+     * @param tolerance_ns How far ahead of schedule a burst may run
+     * @return false if over the rate (the message should be refused)
+     */
+    [[nodiscard]] bool admit(int64_t now_ns, int64_t interval_ns, int64_t tolerance_ns) noexcept;
+
+    void countMessage(size_t bytes) noexcept {
+        messages_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    void countPulse() noexcept { pulses_.fetch_add(1, std::memory_order_relaxed); }
+    void countDenied() noexcept { denied_.fetch_add(1, std::memory_order_relaxed); }
+    void countThrottled() noexcept { throttled_.fetch_add(1, std::memory_order_relaxed); }
+    void countExpired() noexcept { expired_.fetch_add(1, std::memory_order_relaxed); }
+
+    [[nodiscard]] ShmSegmentMap& segments() noexcept { return segments_; }
+
+    [[nodiscard]] ClientStats stats() const;
+
+private:
+    ClientIdentity identity_;
+    bool authorized_;
+    ShmSegmentMap segments_;
+    std::atomic<int64_t> next_ns_{0};   // GCRA theoretical arrival time
+    std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> pulses_{0};
+    std::atomic<uint64_t> denied_{0};
+    std::atomic<uint64_t> throttled_{0};
+    std::atomic<uint64_t> expired_{0};
+};
+
+/**
+ * @brief Client identities of one channel, keyed by server connection id
+ *
+ * The first message or pulse of a connection pays for the kernel lookup
+ * (ServerChannel::clientInfo()), the program name and the authorization
+ * decision; every later one is a probe of a flat open-addressing table
+ * under a shared lock. remove() on the disconnect pulse invalidates the
+ * entry, and an entry whose pid does not match the message (a reused
+ * scoid seen before the old disconnect) is looked up again. A first
+ * lookup that overlaps a remove() checks the connection once more after
+ * inserting, so a disconnect that found nothing yet leaves no entry behind.
+ */
+class ClientTable {
+public:
+    explicit ClientTable(ClientPolicy policy);
+
+    // Prevent copying and moving (workers share one table)
+    ClientTable(const ClientTable&) = delete;
+    ClientTable& operator=(const ClientTable&) = delete;
+
+    /**
+     * @brief The cached entry for a connection, looking it up on first use
+     * @param pid Sender pid from the receive, or 0 if not known (pulses)
+     * @return nullptr if the connection is already gone
+     */
+    [[nodiscard]] std::shared_ptr<ClientEntry> lookup(ServerChannel& channel, int scoid,
+                                                      pid_t pid);
+
+    /**
+     * @brief The cached entry for a connection, without looking it up
+     */
+    [[nodiscard]] std::shared_ptr<ClientEntry> find(int scoid) const;
+
+    /**
+     * @brief Drop a connection that went away
+     * @return Its entry, if it had one, for final accounting
+     */
+    std::shared_ptr<ClientEntry> remove(int scoid);
+
+    /**
+     * @brief Check one message against the policy's rate limit
+     */
+    [[nodiscard]] bool admit(ClientEntry& entry) const noexcept;
+
+    [[nodiscard]] std::vector<ClientStats> stats() const;
+    [[nodiscard]] uint64_t lookups() const noexcept {
+        return lookups_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        int scoid = EMPTY;
+        std::shared_ptr<ClientEntry> entry;
+    };
+
+    static constexpr int EMPTY = -1;
+
+    ClientPolicy policy_;
+    int64_t interval_ns_;
+    int64_t tolerance_ns_;
+
+    mutable std::shared_mutex mutex_;
+    std::vector<Slot> slots_;           // Power-of-two size, at most half full
+    size_t used_ = 0;
+    uint64_t removals_ = 0;             // remove() calls, found or not
+    std::atomic<uint64_t> lookups_{0};
+
+    [[nodiscard]] size_t probeLocked(int scoid) const noexcept;
+    void insertLocked(int scoid, std::shared_ptr<ClientEntry> entry);
+    std::shared_ptr<ClientEntry> eraseLocked(size_t hole);
+    void growLocked();
+};
+
+} // namespace qnx::ipc
+
+#endif // CLIENT_TABLE_H
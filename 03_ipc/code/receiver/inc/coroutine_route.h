@@ -0,0 +1,144 @@
+// coroutine_route.h
+// Coroutine message handlers for MessageDispatcher (C++20) - Header
+#ifndef COROUTINE_ROUTE_H
+#define COROUTINE_ROUTE_H
+
+#include "buffer_pool.h"
+#include "message_dispatcher.h"
+#include "shm_segment.h"
+#include "task.h"
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace qnx::ipc {
+
+namespace detail {
+    /// Payload type from Task<int> (*)(const MessageContext&, Payload)
+    template <typename F>
+    struct CoroutineHandlerTraits;
+
+    template <typename P>
+    struct CoroutineHandlerTraits<Task<int> (*)(const MessageContext&, P)> {
+        using Payload = std::remove_cv_t<std::remove_reference_t<P>>;
+    };
+
+    template <typename P>
+    struct CoroutineHandlerTraits<Task<int> (*)(const MessageContext&, P) noexcept> {
+        using Payload = std::remove_cv_t<std::remove_reference_t<P>>;
+    };
+
+    static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= SCHEMA_MAX_ALIGN,
+                  "Copied payloads must keep the schema alignment");
+
+    /**
+     * @brief A payload that outlives the receive buffer it arrived in
+     *
+     * Large payloads already sit in a pooled buffer or a client's
+     * shared-memory segment, which is kept; small ones are copied out of
+     * the worker's inline buffer.
+     */
+    class OwnedPayload {
+    public:
+        OwnedPayload(const MessageContext& ctx, std::string_view payload) {
+            if (ctx.buffer != nullptr && *ctx.buffer &&
+                payload.data() == ctx.buffer->data()) {
+                pooled_ = std::move(*ctx.buffer);
+                bytes_ = payload;
+            } else if (ctx.segment != nullptr && *ctx.segment &&
+                       payload.data() == ctx.segment->mapping()->data()) {
+                segment_ = std::move(*ctx.segment);
+                bytes_ = payload;
+            } else {
+                copy_ = std::make_unique<char[]>(payload.size());
+                std::memcpy(copy_.get(), payload.data(), payload.size());
+                bytes_ = std::string_view(copy_.get(), payload.size());
+            }
+        }
+
+        [[nodiscard]] std::string_view bytes() const noexcept { return bytes_; }
+
+    private:
+        BufferHandle pooled_;
+        ShmSegmentHold segment_;
+        std::unique_ptr<char[]> copy_;
+        std::string_view bytes_;
+    };
+}
+
+/**
+ * @brief A coroutine handler bound to a type/subtype pair
+ *
+ * Handler is a function Task<int>(const MessageContext&, Payload); it
+ * co_returns the reply status and may co_await anything on the way (an
+ * EventLoop timer, a CoroSender reply) without holding a receive thread.
+ * Mixes freely with Route<> in one MessageDispatcher.
+ *
+ * The handler starts on the receive thread. If it suspends, the worker
+ * moves on to the next message and the reply is sent by whichever thread
+ * resumes the handler when it finishes, through a DeferredReply; the
+ * client stays reply-blocked until then. The payload is kept alive for
+ * the handler (a pooled buffer or shared-memory segment is kept, an
+ * inline payload copied), and the MessageContext it sees has no buffer,
+ * segment, deferral or reply payload.
+ *
+ * Batch and shared-ring records cannot be deferred: for them the worker
+ * waits until the handler finishes, so they should not await for long.
+ *
+ * @code
+ * Task<int> readSensor(const MessageContext&, SensorRequest request) {
+ *     co_await loop.sleepFor(request.settle_time);
+ *     co_return EOK;
+ * }
+ * using Dispatcher = MessageDispatcher<
+ *     Route<1, 100, handleText>,
+ *     CoroutineRoute<4, 1, readSensor>>;
+ * @endcode
+ */
+template <uint16_t Type, uint16_t Subtype, auto Handler>
+struct CoroutineRoute {
+    static_assert(Type < MSG_TYPE_CONTROL_BASE,
+                  "Control message types are handled by the receiver itself");
+
+    using Payload = typename detail::CoroutineHandlerTraits<decltype(Handler)>::Payload;
+    static constexpr uint32_t key = detail::routeKey(Type, Subtype);
+
+    static int invoke(const MessageContext& ctx, std::string_view payload) noexcept {
+        if (ctx.deferral == nullptr) {
+            const auto value = PayloadTraits<Payload>::parse(payload);
+            if (!value) {
+                return EBADMSG;
+            }
+            return syncWait(Handler(ctx, *value));
+        }
+
+        auto owned = std::make_unique<detail::OwnedPayload>(ctx, payload);
+        const auto value = PayloadTraits<Payload>::parse(owned->bytes());
+        if (!value) {
+            return EBADMSG;
+        }
+        run(ctx.deferral->defer(), std::move(owned),
+            MessageContext{ctx.rcvid, nullptr, nullptr, ctx.client, nullptr, nullptr,
+                           ctx.work, ctx.deadline},
+            *value);
+        return EOK;
+    }
+
+private:
+    // Eager: runs on the receive thread up to the handler's first suspension.
+    // owned lives in the frame for as long as value may point into it
+    static detail::Detached run(std::unique_ptr<DeferredReply> reply,
+                                [[maybe_unused]] std::unique_ptr<detail::OwnedPayload> owned,
+                                MessageContext ctx, Payload value) {
+        const int status = co_await Handler(ctx, std::move(value));
+        reply->send(status);
+    }
+};
+
+} // namespace qnx::ipc
+
+#endif // COROUTINE_ROUTE_H
@@ -0,0 +1,139 @@
+// credit_controller.h
+// Per-connection flow-control credits granted by the receiver - Header
+#ifndef CREDIT_CONTROLLER_H
+#define CREDIT_CONTROLLER_H
+
+#include "message.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Limits for the credits a receiver grants
+ */
+struct FlowControlConfig {
+    uint32_t max_window = 64;       // Requests one connection may have unreplied; 0 = off
+    uint32_t pulse_window = 1024;   // Pulses one connection may have unhandled
+    std::chrono::microseconds target_delay{2000};   // Queueing delay grants aim for
+};
+
+/**
+ * @brief Credit state of one channel (or of all lanes, summed)
+ */
+struct FlowControlStats {
+    uint32_t connections;       // Joined connections
+    uint32_t in_flight;         // Requests received and not yet replied (all clients)
+    uint64_t window_total;      // Sum of the windows last granted
+    uint64_t budget;            // Requests the workers finish within target_delay,
+                                // less the requests queued behind them
+    uint64_t service_ns;        // Smoothed receive-to-reply time (slowest lane if summed)
+    uint64_t grants;            // Grants sent, in replies and to MSG_TYPE_CREDIT
+    uint64_t overruns;          // Requests refused for exceeding max_window
+};
+
+/**
+ * @brief How a received request counts against its connection's credits
+ */
+enum class Admission {
+    UNCREDITED,     // Connection has not joined flow control
+    CREDITED,       // Within the connection's credits
+    OVERRUN         // Beyond max_window: refuse it
+};
+
+/**
+ * @brief Grants credits to the connections of one channel
+ *
+ * The window of requests all joined connections may have outstanding is
+ * sized by Little's law: the workers can finish
+ * workers * target_delay / service_time requests within target_delay, so
+ * granting that many keeps the queue in front of them (the requests
+ * waiting in the kernel plus those being handled) within the target
+ * delay. Requests already waiting beyond one per worker are taken off
+ * the budget, so a queue that builds up shrinks the next grants. The
+ * budget is shared equally between joined connections, so the windows
+ * granted are also the deepest queue they can build.
+ *
+ * Grants are absolute windows, not increments, so a lost or reordered
+ * grant never leaks credits. Connections that never join are admitted
+ * as before; their requests still count towards the queue depth.
+ */
+class CreditController {
+public:
+    /**
+     * @brief Construct a new Credit Controller
+     * @param config Grant limits
+     * @param workers Threads that can handle requests on the channel at once
+     */
+    CreditController(const FlowControlConfig& config, unsigned workers);
+
+    // Prevent copying and moving (workers share one controller)
+    CreditController(const CreditController&) = delete;
+    CreditController& operator=(const CreditController&) = delete;
+
+    [[nodiscard]] bool enabled() const noexcept { return config_.max_window > 0; }
+
+    /**
+     * @brief Count a received request; pair with complete()
+     * @param control MSG_TYPE_CREDIT requests, which are never overruns
+     */
+    [[nodiscard]] Admission admit(int scoid, bool control) noexcept;
+
+    /**
+     * @brief Count a request as replied
+     * @param service Receive-to-reply time, smoothed into the budget
+     */
+    void complete(int scoid, Admission admission, std::chrono::nanoseconds service) noexcept;
+
+    /**
+     * @brief Join scoid to flow control (if needed) and grant it credits
+     */
+    [[nodiscard]] CreditGrant join(int scoid);
+
+    /**
+     * @brief Current grant for a joined connection, sent with its reply
+     */
+    [[nodiscard]] CreditGrant grant(int scoid);
+
+    /**
+     * @brief Count a telemetry/application pulse from scoid as handled
+     */
+    void pulseHandled(int scoid) noexcept;
+
+    /**
+     * @brief Forget a connection that went away
+     */
+    void leave(int scoid) noexcept;
+
+    [[nodiscard]] FlowControlStats stats() const;
+
+private:
+    struct Connection {
+        uint32_t window = 0;
+        uint32_t in_flight = 0;
+        uint32_t pulses_handled = 0;
+    };
+
+    FlowControlConfig config_;
+    unsigned workers_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<int, Connection> connections_;   // mutex_
+    uint64_t window_total_ = 0;                         // mutex_
+    uint64_t grants_ = 0;                               // mutex_
+    std::atomic<uint32_t> joined_{0};       // connections_.size(), read without the lock
+    std::atomic<uint32_t> in_flight_{0};
+    std::atomic<uint64_t> service_ns_{0};
+    std::atomic<uint64_t> overruns_{0};
+
+    [[nodiscard]] uint64_t budgetLocked() const noexcept;
+    [[nodiscard]] CreditGrant grantLocked(Connection& connection);
+};
+
+} // namespace qnx::ipc
+
+#endif // CREDIT_CONTROLLER_H
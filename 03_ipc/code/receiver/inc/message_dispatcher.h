@@ -0,0 +1,380 @@
+// message_dispatcher.h
+// Compile-time message handler registry keyed by type/subtype - Header
+#ifndef MESSAGE_DISPATCHER_H
+#define MESSAGE_DISPATCHER_H
+
+#include "message.h"
+#include "message_schema.h"
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+namespace qnx::ipc {
+
+class BufferHandle;
+class ShmSegmentHold;
+struct ClientIdentity;
+
+/// Most parts one reply payload is gathered from
+constexpr size_t MAX_REPLY_PARTS = 8;
+
+/**
+ * @brief A reply a handler took over from the receiver
+ *
+ * The client stays reply-blocked until send() is called, from any
+ * thread. Destroying it unsent replies ECANCELED so no client is left
+ * blocked. Keeps MessageContext::client valid while it exists.
+ */
+class DeferredReply {
+public:
+    virtual ~DeferredReply() = default;
+
+    /**
+     * @brief Reply with the handler's status; later calls do nothing
+     */
+    void send(int status) noexcept { send(status, std::string_view()); }
+
+    /**
+     * @brief Reply with a status and a payload, copied by the kernel
+     *        straight from payload into the sender's reply buffer
+     */
+    virtual void send(int status, std::string_view payload) noexcept = 0;
+};
+
+/**
+ * @brief Payload a handler returns with its inline reply
+ *
+ * The reply gathers the parts with one iovec each, so the kernel copies
+ * them straight into the sender's reply buffer: no bytes are copied in
+ * between. Parts go out in the order they were added.
+ *
+ * @code
+ * int handleLookup(const MessageContext& ctx, SchemaView<LookupRequest> request) {
+ *     char* out = ctx.reply->allocate(request->length);
+ *     if (out == nullptr) {
+ *         return ENOMEM;
+ *     }
+ *     readRecords(request->first, out, request->length);
+ *     return EOK;
+ * }
+ * @endcode
+ */
+class ReplyPayload {
+public:
+    /**
+     * @brief Append a buffer of size bytes from the receive BufferPool,
+     *        for the handler to fill; it is released after the reply
+     * @return nullptr if there are MAX_REPLY_PARTS parts already, size
+     *         exceeds BUFFER_MAX_SIZE or the pool is exhausted
+     */
+    [[nodiscard]] virtual char* allocate(size_t size) = 0;
+
+    /**
+     * @brief Append bytes the handler keeps valid until the reply is sent
+     *        (static tables, a cache, the request's own payload)
+     * @return false if there are MAX_REPLY_PARTS parts already
+     */
+    virtual bool append(std::string_view bytes) noexcept = 0;
+
+    /**
+     * @brief Payload bytes added so far
+     */
+    [[nodiscard]] virtual size_t size() const noexcept = 0;
+
+protected:
+    ~ReplyPayload() = default;
+};
+
+/**
+ * @brief Lets a handler reply after it has returned
+ */
+class ReplyDeferral {
+public:
+    /**
+     * @brief Take over the reply; the handler's return value is then ignored
+     *
+     * Call at most once per message. The payload, MessageContext::buffer
+     * and MessageContext::segment belong to the receiver again once the
+     * handler returns, so copy (or move) what is needed later first.
+     */
+    [[nodiscard]] std::unique_ptr<DeferredReply> defer() {
+        deferred_ = true;
+        return takeReply();
+    }
+
+    /**
+     * @brief Whether the current message's handler called defer()
+     */
+    [[nodiscard]] bool deferred() const noexcept { return deferred_; }
+
+protected:
+    ~ReplyDeferral() = default;
+
+    virtual std::unique_ptr<DeferredReply> takeReply() = 0;
+    void resetDeferral() noexcept { deferred_ = false; }
+
+private:
+    bool deferred_ = false;
+};
+
+/**
+ * @brief Work a handler leaves for the receiver to run after it returns
+ */
+class WorkQueue {
+public:
+    /**
+     * @brief Run work on a receive thread once the current message is done
+     *
+     * Work posted before the receiver gets to it runs as one batch, woken
+     * by a single pulse, so handlers can post per message and still flush
+     * once. Safe to call from any thread.
+     * @return false once the receiver is shutting down
+     */
+    virtual bool post(std::function<void()> work) = 0;
+
+protected:
+    ~WorkQueue() = default;
+};
+
+/**
+ * @brief Where a message came from
+ */
+struct MessageContext {
+    int rcvid;              // 0 for a shared-ring record (already replied to)
+    BufferHandle* buffer;   // Pooled buffer holding a large payload, else nullptr;
+                            // move from it to keep the payload after returning
+    ShmSegmentHold* segment;        // Likewise for a payload in a client's
+                                    // shared-memory segment
+    const ClientIdentity* client;   // Sender, cached at its first message
+                                    // (see client_table.h), or nullptr
+    ReplyDeferral* deferral;        // Set for requests the handler may answer
+                                    // later; nullptr for batch and ring records
+    ReplyPayload* reply;            // Payload of the inline reply (ignored if the
+                                    // handler defers); nullptr for batch and
+                                    // ring records
+    WorkQueue* work;                // The receiver's event loop, or nullptr
+    std::chrono::steady_clock::time_point deadline;     // When the sender gives up
+                                                        // waiting, or NO_DEADLINE
+};
+
+/**
+ * @brief Signature of a whole dispatcher, as installed in a receiver
+ * @return Reply status; ENOSYS for unknown type/subtype, EBADMSG for a
+ *         payload that fails validation
+ */
+using MessageDispatch = int (*)(const MessageContext& ctx, const MessageView& msg) noexcept;
+
+/**
+ * @brief How a payload is validated and turned into a handler argument
+ *
+ * Default: a trivially copyable struct of exactly sizeof(T) bytes, copied
+ * out. Take a SchemaView<T> instead to read a versioned schema in place.
+ * Specialise for range checks or other layouts.
+ */
+template <typename T>
+struct PayloadTraits {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Payload types must be trivially copyable (or specialise PayloadTraits)");
+
+    static std::optional<T> parse(std::string_view bytes) noexcept {
+        if (bytes.size() != sizeof(T)) {
+            return std::nullopt;
+        }
+        T value{};
+        std::memcpy(&value, bytes.data(), sizeof(T));
+        return value;
+    }
+};
+
+/// Text or opaque bytes of any size, passed through
+template <>
+struct PayloadTraits<std::string_view> {
+    static std::optional<std::string_view> parse(std::string_view bytes) noexcept {
+        return bytes;
+    }
+};
+
+/// Schema payloads: validated and read in place, never copied
+template <typename T>
+struct PayloadTraits<SchemaView<T>> {
+    static std::optional<SchemaView<T>> parse(std::string_view bytes) noexcept {
+        return SchemaView<T>::from(bytes);
+    }
+};
+
+namespace detail {
+    constexpr uint32_t routeKey(uint16_t type, uint16_t subtype) noexcept {
+        return (uint32_t{type} << 16) | subtype;
+    }
+
+    /// Payload type from int (*)(const MessageContext&, Payload)
+    template <typename F>
+    struct HandlerTraits;
+
+    template <typename P>
+    struct HandlerTraits<int (*)(const MessageContext&, P)> {
+        using Payload = std::remove_cv_t<std::remove_reference_t<P>>;
+    };
+
+    template <typename P>
+    struct HandlerTraits<int (*)(const MessageContext&, P) noexcept> {
+        using Payload = std::remove_cv_t<std::remove_reference_t<P>>;
+    };
+}
+
+/**
+ * @brief One handler bound to a type/subtype pair
+ *
+ * Handler is a function int(const MessageContext&, const Payload&); the
+ * payload type is taken from its second parameter.
+ */
+template <uint16_t Type, uint16_t Subtype, auto Handler>
+struct Route {
+    static_assert(Type < MSG_TYPE_CONTROL_BASE,
+                  "Control message types are handled by the receiver itself");
+
+    using Payload = typename detail::HandlerTraits<decltype(Handler)>::Payload;
+    static constexpr uint32_t key = detail::routeKey(Type, Subtype);
+
+    static int invoke(const MessageContext& ctx, std::string_view payload) noexcept {
+        const auto value = PayloadTraits<Payload>::parse(payload);
+        if (!value) {
+            return EBADMSG;
+        }
+        return Handler(ctx, *value);
+    }
+};
+
+/**
+ * @brief Dispatch table built at compile time from a list of Routes
+ *
+ * The keys are placed with a multiplicative perfect hash found by the
+ * compiler, in a table at most half full. Dispatch is one multiply, one
+ * load, one key compare and an indirect call; nothing is allocated.
+ * Duplicate routes fail to compile.
+ *
+ * @code
+ * using Dispatcher = MessageDispatcher<
+ *     Route<1, 100, handleText>,
+ *     Route<3, 1, handleSetpoint>>;
+ * receiver.setMessageDispatch(&Dispatcher::dispatch);
+ * @endcode
+ */
+template <typename... Routes>
+class MessageDispatcher {
+public:
+    static constexpr size_t ROUTE_COUNT = sizeof...(Routes);
+
+    static int dispatch(const MessageContext& ctx, const MessageView& msg) noexcept {
+        const uint32_t key = detail::routeKey(msg.type, msg.subtype);
+        const Slot& slot = TABLE[slotOf(key, HASH.multiplier, HASH.bits)];
+        if (slot.invoke == nullptr || slot.key != key) {
+            return ENOSYS;
+        }
+        return slot.invoke(ctx, msg.payload);
+    }
+
+    static constexpr bool handles(uint16_t type, uint16_t subtype) noexcept {
+        const uint32_t key = detail::routeKey(type, subtype);
+        const Slot& slot = TABLE[slotOf(key, HASH.multiplier, HASH.bits)];
+        return slot.invoke != nullptr && slot.key == key;
+    }
+
+private:
+    using Invoke = int (*)(const MessageContext&, std::string_view) noexcept;
+
+    struct Slot {
+        uint32_t key;
+        Invoke invoke;
+    };
+
+    struct Hash {
+        uint32_t multiplier;
+        unsigned bits;
+    };
+
+    static constexpr std::array<uint32_t, ROUTE_COUNT> KEYS{Routes::key...};
+
+    // Up to 16 extra bits (table growth) before giving up
+    static constexpr unsigned MAX_EXTRA_BITS = 4;
+    static constexpr uint32_t MULTIPLIER_TRIES = 4096;
+    static constexpr size_t MAX_TABLE_SIZE = size_t{1} << 12;
+
+    static constexpr size_t slotOf(uint32_t key, uint32_t multiplier, unsigned bits) noexcept {
+        return static_cast<size_t>(static_cast<uint32_t>(key * multiplier) >> (32 - bits));
+    }
+
+    static constexpr unsigned minBits() noexcept {
+        unsigned bits = 1;
+        while ((size_t{1} << bits) < 2 * ROUTE_COUNT) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    static constexpr bool distinct() noexcept {
+        for (size_t i = 0; i < ROUTE_COUNT; ++i) {
+            for (size_t j = i + 1; j < ROUTE_COUNT; ++j) {
+                if (KEYS[i] == KEYS[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static constexpr bool collisionFree(uint32_t multiplier, unsigned bits) noexcept {
+        std::array<bool, MAX_TABLE_SIZE> used{};
+        for (const uint32_t key : KEYS) {
+            const size_t slot = slotOf(key, multiplier, bits);
+            if (used[slot]) {
+                return false;
+            }
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    static constexpr Hash findHash() noexcept {
+        for (unsigned bits = minBits(); bits <= minBits() + MAX_EXTRA_BITS; ++bits) {
+            uint32_t multiplier = 0x9E3779B1u;   // Odd, golden ratio
+            for (uint32_t attempt = 0; attempt < MULTIPLIER_TRIES; ++attempt) {
+                if (collisionFree(multiplier, bits)) {
+                    return Hash{multiplier, bits};
+                }
+                multiplier += 0x6A09E668u;       // Keeps it odd
+            }
+        }
+        return Hash{0, 0};
+    }
+
+    static_assert(distinct(), "Each type/subtype pair may be routed only once");
+    static_assert(minBits() + MAX_EXTRA_BITS <= 12, "Too many routes for one dispatcher");
+
+    static constexpr Hash HASH = findHash();
+    static_assert(HASH.bits != 0, "No perfect hash found for these routes");
+
+    static constexpr auto buildTable() noexcept {
+        std::array<Slot, size_t{1} << HASH.bits> table{};
+        const std::array<Slot, ROUTE_COUNT> routes{Slot{Routes::key, &Routes::invoke}...};
+        for (const Slot& route : routes) {
+            table[slotOf(route.key, HASH.multiplier, HASH.bits)] = route;
+        }
+        return table;
+    }
+
+    static constexpr auto TABLE = buildTable();
+};
+
+} // namespace qnx::ipc
+
+#endif // MESSAGE_DISPATCHER_H
@@ -0,0 +1,158 @@
+// message_schema.h
+// Fixed-layout, versioned message payloads read in place - Header
+#ifndef MESSAGE_SCHEMA_H
+#define MESSAGE_SCHEMA_H
+
+#include "message.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Largest alignment a schema may require
+ *
+ * The receiver's buffers, MSG_TYPE_BATCH records, shared-ring records and
+ * capture files all start payloads on this boundary, so a schema can be
+ * read where it was received.
+ */
+constexpr size_t SCHEMA_MAX_ALIGN = 8;
+
+/**
+ * @brief First member of every schema payload
+ */
+struct SchemaHeader {
+    uint16_t version;   // The schema's VERSION when it was written
+    uint16_t size;      // sizeof the schema struct
+    uint32_t reserved;
+};
+
+static_assert(sizeof(SchemaHeader) == 8, "SchemaHeader is a wire format");
+
+/**
+ * @brief Compile-time checks every schema struct must pass
+ *
+ * A schema is a standard-layout, trivially copyable struct that starts
+ * with a SchemaHeader named `schema` and declares
+ * `static constexpr uint16_t VERSION`. Bump VERSION whenever the layout
+ * changes; a payload of another version is rejected, not misread.
+ */
+template <typename T>
+struct SchemaTraits {
+    static_assert(std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T>,
+                  "Schemas must be plain fixed-layout structs");
+    static_assert(std::is_same_v<decltype(T::schema), SchemaHeader> && offsetof(T, schema) == 0,
+                  "Schemas must start with `SchemaHeader schema`");
+    static_assert(std::is_same_v<std::remove_cv_t<decltype(T::VERSION)>, uint16_t>,
+                  "Schemas must declare static constexpr uint16_t VERSION");
+    static_assert(alignof(T) <= SCHEMA_MAX_ALIGN, "Schema alignment exceeds SCHEMA_MAX_ALIGN");
+    static_assert(sizeof(T) <= UINT16_MAX && sizeof(T) <= INLINE_PAYLOAD_SIZE,
+                  "Schemas must fit in the inline receive buffer");
+
+    static constexpr SchemaHeader header() noexcept {
+        return SchemaHeader{T::VERSION, static_cast<uint16_t>(sizeof(T)), 0};
+    }
+};
+
+/**
+ * @brief Read-only view of a schema payload, in the buffer it arrived in
+ *
+ * Validation checks size, alignment and version once; after that fields
+ * are plain member reads with no parsing, copying or allocation. Valid
+ * only as long as the receive buffer it points into. A shared-ring record
+ * stays writable by its producer, so range-check fields before using them
+ * as indexes.
+ */
+template <typename T>
+class SchemaView {
+public:
+    /**
+     * @brief Validate bytes as a T
+     * @return std::nullopt if the size, alignment or version is wrong
+     */
+    static std::optional<SchemaView> from(std::string_view bytes) noexcept {
+        (void)SchemaTraits<T>{};
+        if (bytes.size() != sizeof(T) ||
+            reinterpret_cast<uintptr_t>(bytes.data()) % alignof(T) != 0) {
+            return std::nullopt;
+        }
+        const auto* value = reinterpret_cast<const T*>(bytes.data());
+        if (value->schema.version != T::VERSION || value->schema.size != sizeof(T)) {
+            return std::nullopt;
+        }
+        return SchemaView(value);
+    }
+
+    const T& operator*() const noexcept { return *value_; }
+    const T* operator->() const noexcept { return value_; }
+
+private:
+    explicit SchemaView(const T* value) noexcept : value_(value) {}
+
+    const T* value_;
+};
+
+/**
+ * @brief Send buffer holding one schema payload, filled in place
+ *
+ * The schema header is written on construction and every other field is
+ * zeroed; the sender assigns fields directly and passes view() to any
+ * MessageSender call, which gathers it straight from here.
+ *
+ * @code
+ * SchemaMessage<Greeting> msg(1, 100);
+ * msg.body.sequence = 7;
+ * sender.sendMessage(msg.view(), status);
+ * @endcode
+ */
+template <typename T>
+struct SchemaMessage {
+    SchemaMessage(uint16_t msg_type, uint16_t msg_subtype) noexcept
+        : type(msg_type), subtype(msg_subtype), body{} {
+        body.schema = SchemaTraits<T>::header();
+    }
+
+    [[nodiscard]] MessageView view() const noexcept {
+        return MessageView{type, subtype,
+                           std::string_view(reinterpret_cast<const char*>(&body), sizeof(T))};
+    }
+
+    uint16_t type;
+    uint16_t subtype;
+    T body;
+};
+
+/// Application schemas
+
+/**
+ * @brief Greeting sent by sender_a (1/100) and sender_b (2/200)
+ */
+struct Greeting {
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t SENDER_ID_SIZE = 16;
+
+    SchemaHeader schema;
+    uint64_t sent_ns;                   // Sender's steady clock
+    uint32_t sequence;                  // 1 for the first message
+    int32_t pid;                        // Sending process
+    char sender_id[SENDER_ID_SIZE];     // NUL-padded, not always terminated
+
+    [[nodiscard]] std::string_view senderId() const noexcept {
+        return std::string_view(sender_id, strnlen(sender_id, SENDER_ID_SIZE));
+    }
+};
+
+static_assert(offsetof(Greeting, sent_ns) == 8 && offsetof(Greeting, sequence) == 16 &&
+              offsetof(Greeting, pid) == 20 && offsetof(Greeting, sender_id) == 24 &&
+              sizeof(Greeting) == 40,
+              "Greeting is a wire format");
+static_assert(sizeof(SchemaTraits<Greeting>) > 0, "Greeting must be a valid schema");
+
+} // namespace qnx::ipc
+
+#endif // MESSAGE_SCHEMA_H
@@ -3,29 +3,74 @@
 #ifndef SECURE_MESSAGE_RECEIVER_H
 #define SECURE_MESSAGE_RECEIVER_H
 
+#include "buffer_pool.h"
+#include "capture_file.h"
+#include "client_table.h"
+#include "credit_controller.h"
+#include "ipc_metrics.h"
 #include "message.h"
+#include "message_dispatcher.h"
+#include "realtime.h"
+#include "thread_pool.h"
+#include "transport.h"
 
 #include <string>
 #include <string_view>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
-
-// Forward declaration for QNX types
-struct _name_attach;
-typedef struct _name_attach name_attach_t;
+#include <vector>
 
 namespace qnx::ipc {
 
 /**
- * @brief Custom deleter for name_attach_t resource
+ * @brief Handler for PULSE_CODE_TELEMETRY samples of one telemetry type
  *
- * Implements RAII for QNX name attachment using unique_ptr
+ * Runs on the receiving thread, so it must be short and must not block.
+ */
+using TelemetryHandler = std::function<void(const TelemetrySample& sample, int scoid)>;
+
+/**
+ * @brief Handler for one application pulse code (PULSE_CODE_USER_MIN..MAX)
+ */
+using PulseHandler = std::function<void(int code, int value, int scoid)>;
+
+/**
+ * @brief Pulse dispatch counters since the receiver was created
  */
-struct NameAttachDeleter {
-    void operator()(name_attach_t* attach) const noexcept;
+struct PulseStats {
+    uint64_t received;      // Telemetry and application pulses
+    uint64_t dispatched;    // Handed to a registered handler
+    uint64_t unhandled;     // Dropped: no handler for the type or code
 };
 
-using NameAttachPtr = std::unique_ptr<name_attach_t, NameAttachDeleter>;
+/**
+ * @brief Event loop counters since the receiver was created
+ */
+struct EventStats {
+    uint64_t work_posted;       // post() calls accepted
+    uint64_t work_batches;      // Wake-ups that ran posted work
+    uint64_t timer_runs;        // Timer callbacks run
+    uint64_t timer_overruns;    // Timer pulses skipped: the previous run was still busy
+    uint64_t replies_cancelled; // Deferred replies still pending at the drain deadline
+};
+
+/**
+ * @brief An extra channel, "<name>.<suffix>", with its own workers
+ *
+ * Clients pick a lane by the name they open. A lane's workers idle at
+ * priority; on receive they run at the sending thread's priority (QNX
+ * channels inherit it by default), so handlers execute at the client's
+ * priority and control traffic on one lane never queues behind bulk
+ * traffic on another.
+ */
+struct LaneConfig {
+    std::string suffix;                     // e.g. "hi", "lo"
+    int priority = 0;                       // Idle worker priority; 0 keeps the creator's
+    std::optional<ThreadPoolConfig> pool;   // std::nullopt: one thread
+};
 
 /**
  * @brief Secure message receiver with security policy enforcement
@@ -34,24 +79,40 @@ using NameAttachPtr = std::unique_ptr<name_attach_t, NameAttachDeleter>;
  * - std::unique_ptr for resource management
  * - std::optional for safer return values
  * - std::string_view for efficient string passing
+ *
+ * Serves a named channel (QNX message passing on the target, its
+ * Unix-socket equivalent on a Linux host) and any lanes added with
+ * addLane(), each with one receive thread or a worker pool. Messages
+ * from authorized clients go to the installed MessageDispatch; pulses,
+ * timers and posted work arrive on the same channel. The README
+ * describes each feature.
  */
 class SecureMessageReceiver {
 public:
     /**
      * @brief Construct a new Secure Message Receiver
      * @param name Channel name to attach to
+     * @param pool_config Worker pool settings, std::nullopt for one thread
      */
-    explicit SecureMessageReceiver(std::string_view name);
+    explicit SecureMessageReceiver(
+        std::string_view name,
+        std::optional<ThreadPoolConfig> pool_config = std::nullopt);
 
     // Prevent copying
     SecureMessageReceiver(const SecureMessageReceiver&) = delete;
     SecureMessageReceiver& operator=(const SecureMessageReceiver&) = delete;
 
     // Allow moving
-    SecureMessageReceiver(SecureMessageReceiver&&) noexcept = default;
-    SecureMessageReceiver& operator=(SecureMessageReceiver&&) noexcept = default;
+    SecureMessageReceiver(SecureMessageReceiver&&) noexcept;
+    SecureMessageReceiver& operator=(SecureMessageReceiver&&) noexcept;
+
+    ~SecureMessageReceiver();
 
-    ~SecureMessageReceiver() = default;
+    /**
+     * @brief Add a priority lane; call before initialize()
+     * @return false if the suffix is empty or already used
+     */
+    bool addLane(LaneConfig lane);
 
     /**
      * @brief Initialize the receiver and create the channel
@@ -61,21 +122,231 @@ public:
 
     /**
      * @brief Run the receiver main loop
+     *
+     * Extra lanes are served from their own threads; returns after
+     * requestStop() (or a receive error) once every lane has stopped,
+     * deferred replies are drained and queued work has run.
      */
     void run();
 
     /**
-     * @brief Get the channel ID
+     * @brief Make run() return; async-signal-safe
+     *
+     * Each lane's workers finish the message in hand and stop receiving.
+     * run() then waits up to the drain timeout for deferred replies,
+     * answers any still pending with ETIMEDOUT, runs the work still
+     * queued and returns. Clients whose messages were never received
+     * get an error when the channel closes.
+     */
+    void requestStop() noexcept;
+
+    /**
+     * @brief How long run() waits for deferred replies when stopping
+     */
+    void setDrainTimeout(std::chrono::milliseconds timeout) noexcept;
+
+    /**
+     * @brief Run work every period on a worker of the main channel
+     *
+     * Call before run(). A timer pulse that arrives while the previous
+     * run is still busy is skipped, so a slow callback never piles up.
+     * @return false if period is not positive
+     */
+    bool addTimer(std::chrono::milliseconds period, std::function<void()> work);
+
+    /**
+     * @brief Queue work for a worker of the main channel (WorkQueue::post())
+     *
+     * For code outside handlers; handlers use MessageContext::work. With
+     * a worker pool, batches posted from different threads may run at
+     * the same time.
+     * @return false once the receiver is shutting down
+     */
+    bool post(std::function<void()> work);
+
+    /**
+     * @brief Snapshot of the timer, posted work and drain counters
+     */
+    [[nodiscard]] EventStats eventStats() const noexcept;
+
+    /**
+     * @brief Hand application messages to a type/subtype dispatcher
+     *
+     * Set before run(). Typically &MessageDispatcher<Route<...>...>::dispatch;
+     * its return value is the reply status. Through MessageContext a
+     * handler may also return data, defer its reply or read the sender's
+     * deadline (see message_dispatcher.h).
+     * @param dispatch nullptr accepts every message with EOK
+     */
+    void setMessageDispatch(MessageDispatch dispatch) noexcept;
+
+    /**
+     * @brief Route telemetry samples of one type to a handler
+     *
+     * Register handlers before run(); the table is not locked.
+     * @param type Telemetry type (TelemetrySample::type)
+     * @param handler Replaces any handler already registered for type
+     */
+    void registerTelemetryHandler(uint8_t type, TelemetryHandler handler);
+
+    /**
+     * @brief Route an application pulse code to a handler
+     *
+     * Register handlers before run(); the table is not locked.
+     * @param code Pulse code in PULSE_CODE_USER_MIN..PULSE_CODE_USER_MAX
+     * @param handler Replaces any handler already registered for code
+     * @return false if code is outside the application range
+     */
+    bool registerPulseHandler(int code, PulseHandler handler);
+
+    /**
+     * @brief Set the receive buffer pool's cap and exhaustion policy
+     *
+     * Call before initialize(), which creates the pool.
+     */
+    void configureBuffers(const BufferPoolConfig& config) noexcept;
+
+    /**
+     * @brief Snapshot of the receive buffer pool (hit rate, high-water mark)
+     */
+    [[nodiscard]] BufferPoolStats bufferStats() const;
+
+    /**
+     * @brief Set the credit limits granted to senders that join flow control
+     *
+     * Call before initialize(). max_window 0 turns flow control off:
+     * MSG_TYPE_CREDIT is then answered with ENOSYS.
+     */
+    void configureFlowControl(const FlowControlConfig& config) noexcept;
+
+    /**
+     * @brief Run the receive threads in realtime mode
+     *
+     * Call before initialize(), which then locks the process's memory
+     * and fails if it cannot. Pools keep maximum workers from the start
+     * instead of growing; each receive thread takes config's policy (a
+     * lane's own priority wins), the next CPU of config.cpus and touches
+     * its stack before its first receive. Once run() starts, heap
+     * allocations made while handling a message are counted (with the
+     * allocation_hook library linked) and reported each second as
+     * hot_path_allocs. A connection's first message, timers and posted
+     * work are not counted.
+     */
+    void configureRealtime(const RealtimeConfig& config);
+
+    /**
+     * @brief Snapshot of the credit state, summed over all lanes
+     */
+    [[nodiscard]] FlowControlStats creditStats() const;
+
+    /**
+     * @brief Set the authorization check and rate limit applied per client
+     *
+     * Call before initialize(). Clients refused by policy.authorize get
+     * EPERM; requests over policy.max_rate get EAGAIN.
+     */
+    void configureClients(ClientPolicy policy);
+
+    /**
+     * @brief Counters of every connected client, on all lanes
+     */
+    [[nodiscard]] std::vector<ClientStats> clientStats() const;
+
+    /**
+     * @brief Client lookups done so far (one per connection)
+     */
+    [[nodiscard]] uint64_t clientLookups() const noexcept;
+
+    /**
+     * @brief Record all received traffic to a capture file
+     *
+     * Call before run(). Recording costs a memcpy per message on the
+     * receiving thread; it stops (counting drops) when the file is full.
+     * @return false if the file cannot be created
+     */
+    bool startCapture(const std::string& path, size_t max_bytes = DEFAULT_CAPTURE_BYTES);
+
+    /**
+     * @brief Snapshot of the pulse dispatch counters
+     */
+    [[nodiscard]] PulseStats pulseStats() const noexcept;
+
+    /**
+     * @brief Get the main channel's ID
      * @return Channel ID if initialized, std::nullopt otherwise
      */
     [[nodiscard]] std::optional<int> getChannelId() const noexcept;
 
 private:
+    class ReceiveWorker;
+    class PendingReply;
+    class PendingTable;
+    class EventQueue;
+    class RingTable;
+    class PulseRouter;
+    class OwnConnections;
+    struct Lane;
+
     std::string name_;
-    NameAttachPtr attach_;
+    std::vector<std::unique_ptr<Lane>> lanes_;  // Main channel first
+    std::unique_ptr<RingTable> rings_;
+    std::unique_ptr<PulseRouter> pulses_;
+    std::unique_ptr<PendingTable> pending_;
+    std::unique_ptr<EventQueue> events_;
+    std::chrono::milliseconds drain_timeout_;
+    std::shared_ptr<IpcMetrics> metrics_;
+    MessageDispatch dispatch_;
+    std::unique_ptr<CaptureWriter> capture_;
+    BufferPoolConfig buffer_config_;
+    std::unique_ptr<BufferPool> buffers_;
+    FlowControlConfig flow_config_;
+    ClientPolicy client_policy_;
+    RealtimeConfig realtime_;
+    uint64_t hot_path_reported_ = 0;    // Allocations already logged
 
     void displayStartupInfo() const;
-    void handleAuthorizedMessage(int rcvid, const Message& msg);
+    [[nodiscard]] bool attachLane(Lane& lane);
+    void runLane(Lane& lane);
+    void drainDeferred();
+    void reportHotPath();
+    void count(Counter counter, uint64_t amount = 1) const noexcept {
+        if (metrics_) {
+            metrics_->add(counter, amount);
+        }
+    }
+    // Receive-to-reply time, including the handler
+    void recordLatency(std::chrono::steady_clock::duration elapsed) const noexcept {
+        if (metrics_) {
+            metrics_->recordLatency(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+    void capture(CaptureKind kind, int pid, int scoid, const MessageView& msg) noexcept {
+        if (capture_) {
+            capture_->append(kind, pid, scoid, msg);
+        }
+    }
+    [[nodiscard]] int dispatchMessage(int rcvid, const MessageView& msg,
+                                      const ClientIdentity* client,
+                                      BufferHandle* buffer = nullptr,
+                                      ShmSegmentHold* segment = nullptr,
+                                      ReplyDeferral* deferral = nullptr,
+                                      ReplyPayload* reply = nullptr,
+                                      std::chrono::steady_clock::time_point deadline =
+                                          NO_DEADLINE);
+    [[nodiscard]] bool admitClient(ServerChannel& channel, int rcvid, ClientEntry& client,
+                                   const Lane& lane);
+    [[nodiscard]] int handleAuthorizedMessage(const MessageContext& ctx, const MessageView& msg);
+    // True if the message is to be dropped; otherwise it is refused here
+    [[nodiscard]] bool handleBuffersExhausted(ServerChannel& channel, int rcvid);
+    void handlePulse(const Pulse& pulse, const Lane& lane);
+    void handleRingSetup(ServerChannel& channel, int rcvid, const ReceiveInfo& info,
+                         const MessageView& msg);
+    void handleCreditRequest(ServerChannel& channel, int rcvid, const ReceiveInfo& info,
+                             const MessageView& msg, const Lane& lane);
+    void handleBatch(ServerChannel& channel, int rcvid, const MessageView& envelope,
+                     const ClientIdentity* client, const CreditGrant* grant);
+    void drainRing(uint32_t ring_id, int scoid, const Lane& lane);
     void handleSecurityViolation(int error_code);
     [[nodiscard]] bool isSecurityError(int error_code) const noexcept;
 };
@@ -0,0 +1,129 @@
+// thread_pool.h
+// Dynamic worker pool modelled on the QNX dispatch thread_pool - Header
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Pool sizing, mirroring the fields of QNX thread_pool_attr_t
+ *
+ * The pool keeps between lo_water and hi_water threads blocked waiting
+ * for work. When a worker leaves the blocked state and fewer than lo_water
+ * remain, increment new threads are created (never more than maximum in
+ * total). When a worker finishes its work while hi_water threads are
+ * already blocked, it exits instead of blocking again.
+ *
+ * New threads are created by a worker, which on QNX may be running at an
+ * inherited client priority; a non-zero priority resets each worker to a
+ * fixed base instead of inheriting that.
+ */
+struct ThreadPoolConfig {
+    unsigned lo_water = 2;
+    unsigned increment = 1;
+    unsigned hi_water = 4;
+    unsigned maximum = 16;
+    int priority = 0;       // Worker scheduling priority; 0 keeps the creator's
+};
+
+/**
+ * @brief Set the calling thread's priority, keeping its policy
+ * @return false if the policy has no such priority or it is not permitted
+ */
+bool setThreadPriority(int priority) noexcept;
+
+/**
+ * @brief Snapshot of pool occupancy
+ */
+struct ThreadPoolStats {
+    unsigned threads;
+    unsigned blocked;
+    unsigned peak_threads;
+    uint64_t created;
+};
+
+/**
+ * @brief Per-thread worker driven by the pool
+ *
+ * block() waits for work (e.g. MsgReceive) and handle() processes it,
+ * like the block_func/handler_func pair of a QNX thread pool. Returning
+ * false from block() reports an unrecoverable error and stops the pool.
+ */
+class PoolWorker {
+public:
+    virtual ~PoolWorker() = default;
+    virtual bool block() = 0;
+    virtual void handle() = 0;
+};
+
+/**
+ * @brief Worker pool that grows and shrinks between watermarks
+ *
+ * Portable C++17 (no QNX headers), so it builds and runs on the host.
+ */
+class ThreadPool {
+public:
+    using WorkerFactory = std::function<std::unique_ptr<PoolWorker>()>;
+    using UnblockFunc = std::function<void()>;
+
+    /**
+     * @brief Construct a new Thread Pool
+     * @param config Watermarks and limits
+     * @param factory Creates the per-thread worker state
+     * @param unblock Called once per blocked worker on stop() to wake it
+     */
+    ThreadPool(const ThreadPoolConfig& config, WorkerFactory factory,
+               UnblockFunc unblock = {});
+
+    // Prevent copying and moving (worker threads reference the pool)
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    /**
+     * @brief Create the initial lo_water workers
+     */
+    void start();
+
+    /**
+     * @brief Ask all workers to exit after their current work item
+     */
+    void stop();
+
+    /**
+     * @brief Block until every worker has exited
+     */
+    void wait();
+
+    [[nodiscard]] ThreadPoolStats stats() const noexcept;
+
+private:
+    ThreadPoolConfig config_;
+    WorkerFactory factory_;
+    UnblockFunc unblock_;
+
+    std::atomic<unsigned> threads_{0};
+    std::atomic<unsigned> blocked_{0};
+    std::atomic<unsigned> peak_threads_{0};
+    std::atomic<uint64_t> created_{0};
+    std::atomic<bool> stopping_{false};
+
+    std::mutex exit_mutex_;
+    std::condition_variable exit_cv_;
+
+    void spawn(unsigned count);
+    void workerLoop();
+    void retire();
+};
+
+} // namespace qnx::ipc
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,334 @@
+// buffer_pool.cpp
+// Size-classed receive buffer pool - Implementation
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <new>
+
+namespace qnx::ipc {
+
+namespace {
+    // Small classes share slabs of this size; larger ones get a slab each
+    constexpr size_t SLAB_BYTES = 256 * 1024;
+    constexpr size_t PAGE_BYTES = 4096;
+
+    // Bytes moved from the shared lists to a thread's cache per refill
+    constexpr size_t REFILL_BYTES = 64 * 1024;
+
+    constexpr size_t classSize(size_t size_class) noexcept {
+        return BUFFER_MIN_SIZE << size_class;
+    }
+
+    constexpr size_t slabSize(size_t size_class) noexcept {
+        return std::max(classSize(size_class), SLAB_BYTES);
+    }
+
+    constexpr size_t cacheLimit(size_t size_class) noexcept {
+        return std::max<size_t>(1, BufferPool::CACHE_BYTES / classSize(size_class));
+    }
+
+    size_t classOf(size_t size) noexcept {
+        size_t size_class = 0;
+        while (classSize(size_class) < size) {
+            ++size_class;
+        }
+        return size_class;
+    }
+
+    // Non-zero id of the calling thread, cheaper to compare than std::thread::id
+    uint64_t threadToken() noexcept {
+        static std::atomic<uint64_t> next{1};
+        thread_local const uint64_t token = next.fetch_add(1, std::memory_order_relaxed);
+        return token;
+    }
+}
+
+/**
+ * @brief One thread's free lists and counters
+ *
+ * local/count are touched only by the owning thread. Other threads push
+ * released buffers onto `returned`, which the owner takes whole with one
+ * exchange, so the list never needs ABA protection.
+ */
+class BufferCache {
+public:
+    using FreeNode = BufferPool::FreeNode;
+
+    explicit BufferCache(BufferPool& owner_pool) noexcept : pool(owner_pool) {}
+
+    BufferPool& pool;
+    std::atomic<uint64_t> owner{0};     // threadToken() of the attached thread, 0 if none
+    std::array<FreeNode*, BUFFER_CLASS_COUNT> local{};
+    std::array<size_t, BUFFER_CLASS_COUNT> count{};
+    std::array<std::atomic<FreeNode*>, BUFFER_CLASS_COUNT> returned{};
+
+    // Written by the owner only; relaxed so stats() can read them
+    std::atomic<uint64_t> acquired{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> blocked{0};
+    std::atomic<uint64_t> exhausted{0};
+
+    void bump(std::atomic<uint64_t>& counter) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+// BufferHandle implementation
+BufferHandle::BufferHandle(BufferHandle&& other) noexcept
+    : cache_(other.cache_), data_(other.data_), size_class_(other.size_class_) {
+    other.cache_ = nullptr;
+    other.data_ = nullptr;
+}
+
+BufferHandle& BufferHandle::operator=(BufferHandle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        cache_ = other.cache_;
+        data_ = other.data_;
+        size_class_ = other.size_class_;
+        other.cache_ = nullptr;
+        other.data_ = nullptr;
+    }
+    return *this;
+}
+
+void BufferHandle::reset() noexcept {
+    if (data_ != nullptr) {
+        cache_->pool.release(*cache_, data_, size_class_);
+        cache_ = nullptr;
+        data_ = nullptr;
+    }
+}
+
+// BufferPool implementation
+BufferPool::BufferPool(const BufferPoolConfig& config) : config_(config) {
+    if (config_.prefill) {
+        for (size_t size_class = 0;
+             size_class < BUFFER_CLASS_COUNT && classSize(size_class) <= SLAB_BYTES;
+             ++size_class) {
+            if (!addSlab(size_class)) {
+                break;
+            }
+        }
+    }
+}
+
+BufferPool::~BufferPool() {
+    for (void* slab : slabs_) {
+        ::operator delete(slab, std::align_val_t{PAGE_BYTES});
+    }
+}
+
+BufferCache* BufferPool::attach() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    BufferCache* cache = nullptr;
+    for (const auto& candidate : caches_) {
+        if (candidate->owner.load(std::memory_order_relaxed) == 0) {
+            cache = candidate.get();
+            break;
+        }
+    }
+    if (cache == nullptr) {
+        caches_.push_back(std::make_unique<BufferCache>(*this));
+        cache = caches_.back().get();
+    }
+    cache->owner.store(threadToken(), std::memory_order_relaxed);
+    return cache;
+}
+
+void BufferPool::detach(BufferCache* cache) noexcept {
+    if (cache == nullptr) {
+        return;
+    }
+    cache->owner.store(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t size_class = 0; size_class < BUFFER_CLASS_COUNT; ++size_class) {
+        FreeNode* lists[2] = {
+            cache->local[size_class],
+            cache->returned[size_class].exchange(nullptr, std::memory_order_acquire)
+        };
+        for (FreeNode* node : lists) {
+            while (node != nullptr) {
+                FreeNode* next = node->next;
+                node->next = free_[size_class];
+                free_[size_class] = node;
+                node = next;
+            }
+        }
+        cache->local[size_class] = nullptr;
+        cache->count[size_class] = 0;
+    }
+    available_.notify_all();
+}
+
+BufferHandle BufferPool::acquire(BufferCache& cache, size_t size) {
+    if (size > BUFFER_MAX_SIZE) {
+        return {};
+    }
+    const size_t size_class = classOf(size);
+
+    if (cache.local[size_class] == nullptr) {
+        // Collect everything other threads handed back, in one exchange
+        FreeNode* node = cache.returned[size_class].exchange(nullptr, std::memory_order_acquire);
+        cache.local[size_class] = node;
+        for (; node != nullptr; node = node->next) {
+            ++cache.count[size_class];
+        }
+    }
+
+    if (cache.local[size_class] != nullptr) {
+        cache.bump(cache.hits);
+    } else if (!refill(cache, size_class)) {
+        cache.bump(cache.exhausted);
+        return {};
+    }
+
+    FreeNode* node = cache.local[size_class];
+    cache.local[size_class] = node->next;
+    --cache.count[size_class];
+    cache.bump(cache.acquired);
+
+    const size_t bytes = classSize(size_class);
+    const size_t in_use = in_use_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = high_water_bytes_.load(std::memory_order_relaxed);
+    while (in_use > peak &&
+           !high_water_bytes_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+
+    return BufferHandle(&cache, reinterpret_cast<char*>(node),
+                        static_cast<uint8_t>(size_class));
+}
+
+bool BufferPool::warm(BufferCache& cache, size_t max_size) {
+    for (size_t size_class = 0;
+         size_class < BUFFER_CLASS_COUNT && classSize(size_class) <= max_size;
+         ++size_class) {
+        if (cache.local[size_class] == nullptr && !refill(cache, size_class)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BufferPool::refill(BufferCache& cache, size_t size_class) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (free_[size_class] == nullptr && !addSlab(size_class)) {
+        if (config_.policy != ExhaustionPolicy::BLOCK) {
+            return false;
+        }
+
+        // Releases go to the shared lists while anyone waits here
+        cache.bump(cache.blocked);
+        waiters_.fetch_add(1, std::memory_order_acq_rel);
+        available_.wait_for(lock, config_.block_timeout,
+                            [this, size_class] { return free_[size_class] != nullptr; });
+        waiters_.fetch_sub(1, std::memory_order_acq_rel);
+        if (free_[size_class] == nullptr) {
+            return false;
+        }
+    }
+
+    const size_t batch = std::max<size_t>(1, REFILL_BYTES / classSize(size_class));
+    for (size_t i = 0; i < batch && free_[size_class] != nullptr; ++i) {
+        FreeNode* node = free_[size_class];
+        free_[size_class] = node->next;
+        node->next = cache.local[size_class];
+        cache.local[size_class] = node;
+        ++cache.count[size_class];
+    }
+    return true;
+}
+
+bool BufferPool::addSlab(size_t size_class) {
+    const size_t bytes = slabSize(size_class);
+    if (reserved_bytes_ + bytes > config_.max_bytes) {
+        return false;
+    }
+
+    auto* slab = static_cast<char*>(
+        ::operator new(bytes, std::align_val_t{PAGE_BYTES}, std::nothrow));
+    if (slab == nullptr) {
+        return false;
+    }
+
+    // Pre-fault: touch every page now rather than while copying a message
+    for (size_t offset = 0; offset < bytes; offset += PAGE_BYTES) {
+        slab[offset] = 0;
+    }
+
+    slabs_.push_back(slab);
+    reserved_bytes_ += bytes;
+
+    const size_t size = classSize(size_class);
+    for (size_t offset = bytes; offset >= size; offset -= size) {
+        auto* node = reinterpret_cast<FreeNode*>(slab + offset - size);
+        node->next = free_[size_class];
+        free_[size_class] = node;
+    }
+    return true;
+}
+
+void BufferPool::release(BufferCache& cache, char* data, size_t size_class) noexcept {
+    in_use_bytes_.fetch_sub(classSize(size_class), std::memory_order_relaxed);
+    auto* node = reinterpret_cast<FreeNode*>(data);
+
+    if (waiters_.load(std::memory_order_acquire) > 0) {
+        pushShared(node, size_class);
+        return;
+    }
+
+    const uint64_t owner = cache.owner.load(std::memory_order_relaxed);
+    if (owner == threadToken()) {
+        node->next = cache.local[size_class];
+        cache.local[size_class] = node;
+        if (++cache.count[size_class] > cacheLimit(size_class)) {
+            spill(cache, size_class, cacheLimit(size_class) / 2);
+        }
+    } else if (owner == 0) {
+        pushShared(node, size_class);
+    } else {
+        FreeNode* head = cache.returned[size_class].load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!cache.returned[size_class].compare_exchange_weak(
+                     head, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+}
+
+void BufferPool::spill(BufferCache& cache, size_t size_class, size_t keep) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (cache.count[size_class] > keep) {
+        FreeNode* node = cache.local[size_class];
+        cache.local[size_class] = node->next;
+        --cache.count[size_class];
+        node->next = free_[size_class];
+        free_[size_class] = node;
+    }
+}
+
+void BufferPool::pushShared(FreeNode* node, size_t size_class) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    node->next = free_[size_class];
+    free_[size_class] = node;
+    available_.notify_all();
+}
+
+BufferPoolStats BufferPool::stats() const {
+    BufferPoolStats stats{};
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& cache : caches_) {
+        stats.acquired += cache->acquired.load(std::memory_order_relaxed);
+        stats.cache_hits += cache->hits.load(std::memory_order_relaxed);
+        stats.blocked += cache->blocked.load(std::memory_order_relaxed);
+        stats.exhausted += cache->exhausted.load(std::memory_order_relaxed);
+    }
+    stats.reserved_bytes = reserved_bytes_;
+    stats.in_use_bytes = in_use_bytes_.load(std::memory_order_relaxed);
+    stats.high_water_bytes = high_water_bytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace qnx::ipc
@@ -0,0 +1,220 @@
+// client_table.cpp
+// Per-connection client identity cache and accounting - Implementation
+#include "client_table.h"
+#include "binary_log.h"
+#include "realtime.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+
+namespace qnx::ipc {
+
+namespace {
+    constexpr size_t INITIAL_SLOTS = 64;
+
+    size_t slotHash(int scoid) noexcept {
+        return static_cast<uint32_t>(scoid) * 2654435761u;
+    }
+
+    int64_t nowNs() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Executable name for logs; empty if the process is already gone
+    std::string programName(pid_t pid) {
+#ifdef __QNXNTO__
+        std::ifstream file("/proc/" + std::to_string(pid) + "/exefile");
+#else
+        std::ifstream file("/proc/" + std::to_string(pid) + "/comm");
+#endif
+        std::string name;
+        std::getline(file, name);
+        const size_t slash = name.rfind('/');
+        return (slash == std::string::npos) ? name : name.substr(slash + 1);
+    }
+}
+
+bool ClientEntry::admit(int64_t now_ns, int64_t interval_ns, int64_t tolerance_ns) noexcept {
+    int64_t next = next_ns_.load(std::memory_order_relaxed);
+    while (true) {
+        const int64_t start = std::max(next, now_ns);
+        if (start - now_ns > tolerance_ns) {
+            return false;
+        }
+        if (next_ns_.compare_exchange_weak(next, start + interval_ns,
+                                           std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+ClientStats ClientEntry::stats() const {
+    return ClientStats{
+        identity_,
+        authorized_,
+        messages_.load(std::memory_order_relaxed),
+        bytes_.load(std::memory_order_relaxed),
+        pulses_.load(std::memory_order_relaxed),
+        denied_.load(std::memory_order_relaxed),
+        throttled_.load(std::memory_order_relaxed),
+        expired_.load(std::memory_order_relaxed)
+    };
+}
+
+ClientTable::ClientTable(ClientPolicy policy)
+    : policy_(std::move(policy)),
+      interval_ns_(policy_.max_rate > 0 ? 1'000'000'000 / policy_.max_rate : 0),
+      tolerance_ns_(interval_ns_ * (std::max(policy_.burst, 1u) - 1)),
+      slots_(INITIAL_SLOTS) {}
+
+std::shared_ptr<ClientEntry> ClientTable::lookup(ServerChannel& channel, int scoid, pid_t pid) {
+    uint64_t removals = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const Slot& slot = slots_[probeLocked(scoid)];
+        if (slot.scoid == scoid &&
+            (pid == 0 || slot.entry->identity().credentials.pid == pid)) {
+            return slot.entry;
+        }
+        removals = removals_;
+    }
+
+    // First sight of this connection: one kernel call, outside the lock,
+    // and one-off allocations that realtime mode does not count
+    const HotPathExempt setup;
+    ClientIdentity identity{scoid, ClientCredentials{}, std::string()};
+    if (channel.clientInfo(scoid, identity.credentials) == -1) {
+        return nullptr;
+    }
+    identity.program = programName(identity.credentials.pid);
+    const bool authorized = !policy_.authorize || policy_.authorize(identity);
+    lookups_.fetch_add(1, std::memory_order_relaxed);
+
+    auto entry = std::make_shared<ClientEntry>(std::move(identity), authorized);
+    const ClientCredentials& credentials = entry->identity().credentials;
+    bool raced = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Slot& slot = slots_[probeLocked(scoid)];
+        if (slot.scoid == scoid) {
+            // Another worker got there first, or the scoid was reused
+            if (slot.entry->identity().credentials.pid == credentials.pid) {
+                return slot.entry;
+            }
+            slot.entry = entry;
+        } else {
+            insertLocked(scoid, entry);
+        }
+        raced = (removals_ != removals);
+    }
+
+    // A disconnect handled since the first probe may have been this
+    // connection's, finding nothing to remove. The transport releases the
+    // connection before delivering that pulse, so ask again: if it is gone
+    // (or the scoid now belongs to another process) drop what was inserted
+    ClientCredentials current{};
+    if (raced && (channel.clientInfo(scoid, current) == -1 || current.pid != credentials.pid)) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        const size_t index = probeLocked(scoid);
+        if (slots_[index].entry == entry) {
+            eraseLocked(index);
+        }
+        return nullptr;
+    }
+
+    if (authorized) {
+        IPC_LOG_INFO("Client {} (pid {}, uid {}, gid {}) connected as scoid {}",
+                     entry->identity().program, credentials.pid, credentials.euid,
+                     credentials.egid, scoid);
+    } else {
+        IPC_LOG_WARN("Client {} (pid {}, uid {}, gid {}) is not authorized,"
+                     " refusing its messages", entry->identity().program, credentials.pid,
+                     credentials.euid, credentials.egid);
+    }
+    return entry;
+}
+
+std::shared_ptr<ClientEntry> ClientTable::find(int scoid) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Slot& slot = slots_[probeLocked(scoid)];
+    return (slot.scoid == scoid) ? slot.entry : nullptr;
+}
+
+std::shared_ptr<ClientEntry> ClientTable::remove(int scoid) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    ++removals_;
+    const size_t index = probeLocked(scoid);
+    if (slots_[index].scoid != scoid) {
+        return nullptr;
+    }
+    return eraseLocked(index);
+}
+
+bool ClientTable::admit(ClientEntry& entry) const noexcept {
+    return policy_.max_rate == 0 || entry.admit(nowNs(), interval_ns_, tolerance_ns_);
+}
+
+std::vector<ClientStats> ClientTable::stats() const {
+    std::vector<ClientStats> clients;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const Slot& slot : slots_) {
+        if (slot.scoid != EMPTY) {
+            clients.push_back(slot.entry->stats());
+        }
+    }
+    return clients;
+}
+
+size_t ClientTable::probeLocked(int scoid) const noexcept {
+    const size_t mask = slots_.size() - 1;
+    size_t index = slotHash(scoid) & mask;
+    while (slots_[index].scoid != EMPTY && slots_[index].scoid != scoid) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void ClientTable::insertLocked(int scoid, std::shared_ptr<ClientEntry> entry) {
+    if ((used_ + 1) * 2 > slots_.size()) {
+        growLocked();
+    }
+    slots_[probeLocked(scoid)] = Slot{scoid, std::move(entry)};
+    ++used_;
+}
+
+std::shared_ptr<ClientEntry> ClientTable::eraseLocked(size_t hole) {
+    std::shared_ptr<ClientEntry> entry = std::move(slots_[hole].entry);
+    slots_[hole] = Slot{};
+    --used_;
+
+    // Backward-shift deletion: pull later entries of the probe run into
+    // the hole so lookups never need tombstones
+    const size_t mask = slots_.size() - 1;
+    for (size_t next = (hole + 1) & mask; slots_[next].scoid != EMPTY;
+         next = (next + 1) & mask) {
+        const size_t home = slotHash(slots_[next].scoid) & mask;
+        const bool reachable = (hole <= next) ? (hole < home && home <= next)
+                                              : (hole < home || home <= next);
+        if (!reachable) {
+            slots_[hole] = std::move(slots_[next]);
+            slots_[next] = Slot{};
+            hole = next;
+        }
+    }
+    return entry;
+}
+
+void ClientTable::growLocked() {
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    for (Slot& slot : old) {
+        if (slot.scoid != EMPTY) {
+            slots_[probeLocked(slot.scoid)] = std::move(slot);
+        }
+    }
+}
+
+} // namespace qnx::ipc
@@ -0,0 +1,140 @@
+// credit_controller.cpp
+// Per-connection flow-control credits - Implementation
+#include "credit_controller.h"
+
+#include <algorithm>
+
+namespace qnx::ipc {
+
+namespace {
+    // Floor for the smoothed service time, so an idle receiver's first
+    // grants are large but finite
+    constexpr uint64_t MIN_SERVICE_NS = 1000;
+}
+
+CreditController::CreditController(const FlowControlConfig& config, unsigned workers)
+    : config_(config), workers_(std::max(1u, workers)) {}
+
+Admission CreditController::admit(int scoid, bool control) noexcept {
+    in_flight_.fetch_add(1, std::memory_order_relaxed);
+    if (joined_.load(std::memory_order_relaxed) == 0) {
+        return Admission::UNCREDITED;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = connections_.find(scoid);
+    if (it == connections_.end()) {
+        return Admission::UNCREDITED;
+    }
+
+    // A shrinking window does not recall requests already sent, so only
+    // the hard cap is enforced
+    if (++it->second.in_flight > config_.max_window && !control) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        return Admission::OVERRUN;
+    }
+    return Admission::CREDITED;
+}
+
+void CreditController::complete(int scoid, Admission admission,
+                                std::chrono::nanoseconds service) noexcept {
+    in_flight_.fetch_sub(1, std::memory_order_relaxed);
+
+    // Moving average with weight 1/8; racing workers may drop a sample
+    const auto sample = static_cast<uint64_t>(std::max<int64_t>(service.count(), 0));
+    const uint64_t average = service_ns_.load(std::memory_order_relaxed);
+    service_ns_.store(average == 0 ? sample : average - average / 8 + sample / 8,
+                      std::memory_order_relaxed);
+
+    if (admission == Admission::UNCREDITED) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = connections_.find(scoid);
+    if (it != connections_.end() && it->second.in_flight > 0) {
+        --it->second.in_flight;
+    }
+}
+
+CreditGrant CreditController::join(int scoid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto [it, joined] = connections_.try_emplace(scoid);
+    if (joined) {
+        joined_.store(static_cast<uint32_t>(connections_.size()), std::memory_order_relaxed);
+    }
+    return grantLocked(it->second);
+}
+
+CreditGrant CreditController::grant(int scoid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = connections_.find(scoid);
+    if (it == connections_.end()) {
+        // Left while this request was handled; nobody will read the grant
+        return CreditGrant{1, config_.pulse_window, 0, 0};
+    }
+    return grantLocked(it->second);
+}
+
+void CreditController::pulseHandled(int scoid) noexcept {
+    if (joined_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = connections_.find(scoid);
+    if (it != connections_.end()) {
+        ++it->second.pulses_handled;
+    }
+}
+
+void CreditController::leave(int scoid) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = connections_.find(scoid);
+    if (it == connections_.end()) {
+        return;
+    }
+    window_total_ -= it->second.window;
+    connections_.erase(it);
+    joined_.store(static_cast<uint32_t>(connections_.size()), std::memory_order_relaxed);
+}
+
+FlowControlStats CreditController::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return FlowControlStats{
+        static_cast<uint32_t>(connections_.size()),
+        in_flight_.load(std::memory_order_relaxed),
+        window_total_,
+        budgetLocked(),
+        service_ns_.load(std::memory_order_relaxed),
+        grants_,
+        overruns_.load(std::memory_order_relaxed)
+    };
+}
+
+uint64_t CreditController::budgetLocked() const noexcept {
+    const uint64_t service =
+        std::max(service_ns_.load(std::memory_order_relaxed), MIN_SERVICE_NS);
+    const auto target = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(config_.target_delay).count());
+    const uint64_t capacity = workers_ * target / service;
+
+    // Requests already queued behind the workers come out of the budget,
+    // so a growing queue shrinks the grants until it drains
+    const uint64_t in_flight = in_flight_.load(std::memory_order_relaxed);
+    const uint64_t backlog = in_flight > workers_ ? in_flight - workers_ : 0;
+    return capacity > backlog ? capacity - backlog : 1;
+}
+
+CreditGrant CreditController::grantLocked(Connection& connection) {
+    const uint64_t share = budgetLocked() / std::max<size_t>(1, connections_.size());
+    const auto window = static_cast<uint32_t>(
+        std::clamp<uint64_t>(share, 1, config_.max_window));
+
+    window_total_ = window_total_ - connection.window + window;
+    connection.window = window;
+    ++grants_;
+    return CreditGrant{window, config_.pulse_window, connection.pulses_handled, 0};
+}
+
+} // namespace qnx::ipc
@@ -1,23 +1,282 @@
 // main.cpp
 // Entry point for Secure Message Receiver
 #include "secure_message_receiver.h"
+#include "binary_log.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
 #include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
 
 namespace {
     constexpr const char* RECEIVER_NAME = "qnx_receiver_secure";
+
+    // SIGINT/SIGTERM stop the receiver through its own channel
+    qnx::ipc::SecureMessageReceiver* g_receiver = nullptr;
+
+    extern "C" void onStopSignal(int) {
+        if (g_receiver != nullptr) {
+            g_receiver->requestStop();
+        }
+    }
+
+    // Greetings sent by sender_a (1/100) and sender_b (2/200), read in
+    // place from the receive buffer
+    int handleGreeting(const qnx::ipc::MessageContext&,
+                       qnx::ipc::SchemaView<qnx::ipc::Greeting> greeting) {
+        if (greeting->sequence == 0) {
+            return EINVAL;
+        }
+        IPC_LOG_DEBUG("Greeting #{} from {} (pid {})", greeting->sequence,
+                      greeting->senderId(), greeting->pid);
+        return EOK;
+    }
+
+    // Opaque payloads of any size (load_gen, ipc_replay)
+    int handleData(const qnx::ipc::MessageContext&, std::string_view) {
+        return EOK;
+    }
+
+    // Anything else is answered with ENOSYS
+    using Dispatcher = qnx::ipc::MessageDispatcher<
+        qnx::ipc::Route<1, 1, &handleData>,
+        qnx::ipc::Route<1, 100, &handleGreeting>,
+        qnx::ipc::Route<2, 200, &handleGreeting>>;
+
+    void printUsage(const char* prog) {
+        std::cerr << "Usage: " << prog
+                  << " [-p] [-l lo_water] [-H hi_water] [-i increment]"
+                     " [-m maximum] [-L slog2|file] [-a suffix:priority]..."
+                     " [-C capture_file] [-B buffer_mb] [-X block|reject|drop]"
+                     " [-F window] [-D delay_us] [-S shard] [-Q rate] [-U uid]..."
+                     " [-T stats_ms] [-W drain_ms] [-R policy[:priority][@cpu,...]]\n"
+                  << "  -p  Receive with a worker pool instead of one thread\n"
+                  << "  -S  Run as shard N: register " << RECEIVER_NAME << ".<N>\n"
+                  << "  -a  Add a lane " << RECEIVER_NAME << ".<suffix> whose workers"
+                     " idle at priority\n"
+                  << "  -C  Record received traffic for ipc_replay\n"
+                  << "  -B  Cap on receive buffer memory for large payloads (MB)\n"
+                  << "  -X  When the cap is reached: wait, reply EAGAIN or drop\n"
+                  << "  -F  Most requests a flow-controlled sender may have in flight"
+                     " (default 64, 0 = no flow control)\n"
+                  << "  -D  Queueing delay the flow-control credits aim for (us, default 2000)\n"
+                  << "  -Q  Most messages per second from one connection (default unlimited)\n"
+                  << "  -U  Only handle messages from this user id (repeatable)\n"
+                  << "  -T  Log statistics every stats_ms milliseconds\n"
+                  << "  -W  On SIGINT/SIGTERM, wait this long for deferred replies"
+                     " (ms, default 2000)\n"
+                  << "  -R  Realtime mode: lock memory, fixed workers with policy fifo, rr"
+                     " or other pinned to the CPUs, report hot-path allocations\n"
+                  << "  -L  Log to slogger2 or a binary file (default: console)\n";
+    }
 }
 
-int main() {
-    qnx::ipc::SecureMessageReceiver receiver(RECEIVER_NAME);
+int main(int argc, char* argv[]) {
+    qnx::ipc::ThreadPoolConfig config{};
+    qnx::ipc::LogConfig log_config{};
+    qnx::ipc::BufferPoolConfig buffer_config{};
+    qnx::ipc::FlowControlConfig flow_config{};
+    qnx::ipc::ClientPolicy client_policy{};
+    std::vector<uid_t> allowed_uids;
+    std::vector<qnx::ipc::LaneConfig> lanes;
+    std::string capture_path;
+    std::string receiver_name = RECEIVER_NAME;
+    std::optional<std::chrono::milliseconds> stats_period;
+    std::optional<std::chrono::milliseconds> drain_timeout;
+    qnx::ipc::RealtimeConfig realtime{};
+    bool use_pool = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "pl:H:i:m:L:a:C:B:X:F:D:S:Q:U:T:W:R:")) != -1) {
+        switch (opt) {
+            case 'p': use_pool = true; break;
+            case 'l': config.lo_water = std::strtoul(optarg, nullptr, 0); break;
+            case 'H': config.hi_water = std::strtoul(optarg, nullptr, 0); break;
+            case 'i': config.increment = std::strtoul(optarg, nullptr, 0); break;
+            case 'm': config.maximum = std::strtoul(optarg, nullptr, 0); break;
+            case 'a': {
+                const std::string_view arg(optarg);
+                const size_t colon = arg.find(':');
+                if (colon == 0 || colon == std::string_view::npos) {
+                    printUsage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                lanes.push_back(qnx::ipc::LaneConfig{
+                    std::string(arg.substr(0, colon)),
+                    std::atoi(optarg + colon + 1),
+                    std::nullopt});
+                break;
+            }
+            case 'C': capture_path = optarg; break;
+            case 'B':
+                buffer_config.max_bytes = std::strtoul(optarg, nullptr, 0) * 1024 * 1024;
+                break;
+            case 'X': {
+                const std::string_view policy(optarg);
+                if (policy == "block") {
+                    buffer_config.policy = qnx::ipc::ExhaustionPolicy::BLOCK;
+                } else if (policy == "reject") {
+                    buffer_config.policy = qnx::ipc::ExhaustionPolicy::REJECT;
+                } else if (policy == "drop") {
+                    buffer_config.policy = qnx::ipc::ExhaustionPolicy::DROP;
+                } else {
+                    printUsage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+            case 'F': flow_config.max_window = std::strtoul(optarg, nullptr, 0); break;
+            case 'D':
+                flow_config.target_delay = std::chrono::microseconds(
+                    std::strtoul(optarg, nullptr, 0));
+                break;
+            case 'Q': client_policy.max_rate = std::strtoul(optarg, nullptr, 0); break;
+            case 'U':
+                allowed_uids.push_back(static_cast<uid_t>(std::strtoul(optarg, nullptr, 0)));
+                break;
+            case 'T':
+                stats_period = std::chrono::milliseconds(std::strtoul(optarg, nullptr, 0));
+                break;
+            case 'W':
+                drain_timeout = std::chrono::milliseconds(std::strtoul(optarg, nullptr, 0));
+                break;
+            case 'R': {
+                const auto spec = qnx::ipc::parseRealtimeSpec(optarg);
+                if (!spec) {
+                    printUsage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                realtime = *spec;
+                break;
+            }
+            case 'S': {
+                char* end = nullptr;
+                const unsigned long shard = std::strtoul(optarg, &end, 10);
+                if (end == optarg || *end != '\0') {
+                    printUsage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                receiver_name = std::string(RECEIVER_NAME) + "." + std::to_string(shard);
+                break;
+            }
+            case 'L':
+                if (std::string_view(optarg) == "slog2") {
+                    log_config.output = qnx::ipc::LogOutput::SLOGGER2;
+                } else {
+                    log_config.output = qnx::ipc::LogOutput::FILE;
+                    log_config.path = optarg;
+                }
+                break;
+            default:
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (log_config.output == qnx::ipc::LogOutput::SLOGGER2) {
+        log_config.path = receiver_name;
+    }
+    if (!qnx::ipc::BinaryLog::start(log_config)) {
+        return EXIT_FAILURE;
+    }
+
+    qnx::ipc::SecureMessageReceiver receiver(
+        receiver_name,
+        use_pool ? std::optional(config) : std::nullopt);
+
+    receiver.setMessageDispatch(&Dispatcher::dispatch);
+    receiver.configureBuffers(buffer_config);
+    receiver.configureFlowControl(flow_config);
+    if (!allowed_uids.empty()) {
+        client_policy.authorize = [allowed_uids](const qnx::ipc::ClientIdentity& client) {
+            return std::find(allowed_uids.begin(), allowed_uids.end(),
+                             client.credentials.euid) != allowed_uids.end();
+        };
+    }
+    receiver.configureClients(std::move(client_policy));
+    receiver.configureRealtime(realtime);
+
+    for (auto& lane : lanes) {
+        if (use_pool) {
+            lane.pool = config;
+        }
+        if (!receiver.addLane(std::move(lane))) {
+            std::cerr << "Error: Duplicate lane\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!capture_path.empty() && !receiver.startCapture(capture_path)) {
+        return EXIT_FAILURE;
+    }
+
+    if (drain_timeout) {
+        receiver.setDrainTimeout(*drain_timeout);
+    }
+    if (stats_period && !receiver.addTimer(*stats_period, [&receiver] {
+            const qnx::ipc::PulseStats pulses = receiver.pulseStats();
+            const qnx::ipc::FlowControlStats credits = receiver.creditStats();
+            IPC_LOG_INFO("Stats: {} pulses, {} requests in flight, {} credit overruns,"
+                         " {} clients", pulses.received, credits.in_flight,
+                         credits.overruns, receiver.clientStats().size());
+        })) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
 
     if (!receiver.initialize()) {
         return EXIT_FAILURE;
     }
 
+    g_receiver = &receiver;
+    struct sigaction action{};
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
     receiver.run();
 
-    std::cout << "Secure receiver shutting down\n";
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    g_receiver = nullptr;
+
+    const qnx::ipc::BufferPoolStats buffers = receiver.bufferStats();
+    IPC_LOG_INFO("Receive buffers: {} acquired, {}% from thread caches, {} exhausted,"
+                 " peak {} KB of {} KB reserved",
+                 buffers.acquired, std::lround(100.0 * buffers.hitRate()), buffers.exhausted,
+                 buffers.high_water_bytes / 1024, buffers.reserved_bytes / 1024);
+    const qnx::ipc::FlowControlStats credits = receiver.creditStats();
+    IPC_LOG_INFO("Flow control: {} grants, {} overruns, {} connections holding {} credits,"
+                 " budget {} at {} us per request",
+                 credits.grants, credits.overruns, credits.connections, credits.window_total,
+                 credits.budget, credits.service_ns / 1000);
+    const qnx::ipc::EventStats events = receiver.eventStats();
+    IPC_LOG_INFO("Event loop: {} timer runs ({} skipped), {} work items in {} batches,"
+                 " {} deferred replies cancelled at shutdown",
+                 events.timer_runs, events.timer_overruns, events.work_posted,
+                 events.work_batches, events.replies_cancelled);
+    if (realtime.enabled) {
+        const qnx::ipc::HotPathStats hot_path = qnx::ipc::hotPathStats();
+        IPC_LOG_INFO("Realtime: {} heap allocations on the message path ({} bytes)",
+                     hot_path.allocations, hot_path.bytes);
+    }
+    IPC_LOG_INFO("Clients: {} looked up", receiver.clientLookups());
+    for (const qnx::ipc::ClientStats& client : receiver.clientStats()) {
+        IPC_LOG_INFO("  {} (pid {}, uid {}): {} messages, {} bytes, {} pulses,"
+                     " {} denied, {} throttled, {} expired", client.identity.program,
+                     client.identity.credentials.pid, client.identity.credentials.euid,
+                     client.messages, client.bytes, client.pulses, client.denied,
+                     client.throttled, client.expired);
+    }
+    IPC_LOG_INFO("Secure receiver shutting down");
     return EXIT_SUCCESS;
 }
@@ -1,120 +1,1764 @@
 // secure_message_receiver.cpp
 // Secure Message Receiver - Implementation
 #include "secure_message_receiver.h"
+#include "shared_ring_channel.h"
+#include "shm_segment.h"
+#include "binary_log.h"
 
 #include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
 #include <cstring>
 #include <cerrno>
 #include <unistd.h>
-#include <sys/neutrino.h>
-#include <sys/dispatch.h>
 
 namespace qnx::ipc {
 
-// NameAttachDeleter implementation
-void NameAttachDeleter::operator()(name_attach_t* attach) const noexcept {
-    if (attach != nullptr) {
-        name_detach(attach, 0);
+namespace {
+    // Private pulses, from the top of the range (see message.h)
+    constexpr int PULSE_CODE_WAKE_WORKER = TRANSPORT_PULSE_CODE_MAXAVAIL;
+    constexpr int PULSE_CODE_RING_REDRAIN = TRANSPORT_PULSE_CODE_MAXAVAIL - 1;
+    constexpr int PULSE_CODE_SHUTDOWN = TRANSPORT_PULSE_CODE_MAXAVAIL - 2;
+    constexpr int PULSE_CODE_TIMER = TRANSPORT_PULSE_CODE_MAXAVAIL - 3;
+    constexpr int PULSE_CODE_RUN_WORK = TRANSPORT_PULSE_CODE_MAXAVAIL - 4;
+
+    // Codes honoured only from the receiver's own connections and timers
+    constexpr bool isPrivatePulse(int code) noexcept {
+        return code >= PULSE_CODE_RUN_WORK && code <= TRANSPORT_PULSE_CODE_MAXAVAIL;
+    }
+
+    constexpr std::chrono::milliseconds DEFAULT_DRAIN_TIMEOUT{2000};
+
+    // How often realtime mode reports hot-path allocations
+    constexpr std::chrono::milliseconds HOT_PATH_REPORT_PERIOD{1000};
+
+    // Realtime workers stock their buffer cache for payloads up to this
+    constexpr size_t REALTIME_WARM_BYTES = 256 * 1024;
+
+    // Ring lookup that skips the owner check, for internal re-drains
+    constexpr int ANY_OWNER = -1;
+
+    // Shared ring limits and per-doorbell drain budget (fairness)
+    constexpr size_t MAX_RINGS = 64;
+    constexpr size_t MAX_RINGS_PER_CLIENT = 4;
+    constexpr size_t RING_DRAIN_BUDGET = 256;
+}
+
+/**
+ * @brief Shared rings set up by clients, indexed by ring id
+ *
+ * Entries are shared_ptr so a worker draining a ring keeps it alive
+ * while another worker handles the owner's disconnect.
+ */
+class SecureMessageReceiver::RingTable {
+public:
+    struct Entry {
+        explicit Entry(SharedRingChannel channel, int owner) noexcept
+            : ring(std::move(channel)), scoid(owner) {}
+
+        SharedRingChannel ring;
+        int scoid;
+        std::atomic<bool> draining{false};
+    };
+
+    std::optional<uint32_t> add(SharedRingChannel ring, int scoid) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        size_t owned = 0;
+        for (const auto& entry : entries_) {
+            if (entry && entry->scoid == scoid) {
+                ++owned;
+            }
+        }
+        if (owned >= MAX_RINGS_PER_CLIENT) {
+            return std::nullopt;
+        }
+
+        auto entry = std::make_shared<Entry>(std::move(ring), scoid);
+        for (size_t id = 0; id < entries_.size(); ++id) {
+            if (!entries_[id]) {
+                entries_[id] = std::move(entry);
+                return static_cast<uint32_t>(id);
+            }
+        }
+        if (entries_.size() >= MAX_RINGS) {
+            return std::nullopt;
+        }
+        entries_.push_back(std::move(entry));
+        return static_cast<uint32_t>(entries_.size() - 1);
+    }
+
+    // Only the owning connection may ring a ring's doorbell
+    std::shared_ptr<Entry> find(uint32_t id, int scoid) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (id < entries_.size() && entries_[id] &&
+            (scoid == ANY_OWNER || entries_[id]->scoid == scoid)) {
+            return entries_[id];
+        }
+        return nullptr;
+    }
+
+    void remove(uint32_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (id < entries_.size()) {
+            entries_[id].reset();
+        }
+    }
+
+    void removeClient(int scoid) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : entries_) {
+            if (entry && entry->scoid == scoid) {
+                entry.reset();
+            }
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<Entry>> entries_;
+};
+
+/**
+ * @brief Handler tables for telemetry types and application pulse codes
+ *
+ * Tables are indexed directly (256 types, 96 codes), so routing a pulse
+ * is one lookup with no locking. Counters are relaxed atomics since
+ * pool workers dispatch concurrently.
+ */
+class SecureMessageReceiver::PulseRouter {
+public:
+    void setTelemetry(uint8_t type, TelemetryHandler handler) {
+        telemetry_[type] = std::move(handler);
+    }
+
+    void setUser(int code, PulseHandler handler) {
+        user_[code - PULSE_CODE_USER_MIN] = std::move(handler);
+    }
+
+    void dispatchTelemetry(uint32_t value, int scoid) {
+        const TelemetrySample sample = decodeTelemetry(value);
+        received_.fetch_add(1, std::memory_order_relaxed);
+        if (const auto& handler = telemetry_[sample.type]) {
+            dispatched_.fetch_add(1, std::memory_order_relaxed);
+            handler(sample, scoid);
+        } else {
+            unhandled_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void dispatchUser(int code, int value, int scoid) {
+        received_.fetch_add(1, std::memory_order_relaxed);
+        if (const auto& handler = user_[code - PULSE_CODE_USER_MIN]) {
+            dispatched_.fetch_add(1, std::memory_order_relaxed);
+            handler(code, value, scoid);
+        } else {
+            unhandled_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    PulseStats stats() const noexcept {
+        return PulseStats{
+            received_.load(std::memory_order_relaxed),
+            dispatched_.load(std::memory_order_relaxed),
+            unhandled_.load(std::memory_order_relaxed)
+        };
+    }
+
+private:
+    std::array<TelemetryHandler, 256> telemetry_;
+    std::array<PulseHandler, PULSE_CODE_USER_MAX - PULSE_CODE_USER_MIN + 1> user_;
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> dispatched_{0};
+    std::atomic<uint64_t> unhandled_{0};
+};
+
+/**
+ * @brief Timers, posted work and the stop request of the receiver's loop
+ *
+ * Everything here is driven by pulses on the main channel. Posted work
+ * collects in one vector and only the post that finds no wake-up
+ * pending sends a pulse, so a burst of posts costs one pulse and runs
+ * as one batch. Like every private pulse code, the stop pulse is only
+ * acted on when it comes from one of the receiver's own connections
+ * (OwnConnections), so no client can stop the receiver.
+ */
+class SecureMessageReceiver::EventQueue : public WorkQueue {
+public:
+    void addTimer(std::chrono::milliseconds period, std::function<void()> work) {
+        timers_.push_back(std::make_unique<Timer>(period, std::move(work)));
+    }
+
+    // Timer pulses carry the timer's index
+    bool start(ServerChannel& channel, ClientConnection& wake) {
+        for (size_t i = 0; i < timers_.size(); ++i) {
+            Timer& timer = *timers_[i];
+            timer.timer = channel.createTimer(PULSE_CODE_TIMER, static_cast<int>(i));
+            if (!timer.timer || timer.timer->arm(timer.period, timer.period) == -1) {
+                std::cerr << "Error: Cannot start a " << timer.period.count()
+                          << " ms timer: " << std::strerror(errno) << "\n";
+                stopTimers();
+                return false;
+            }
+        }
+
+        bool pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_ = &wake;
+            pending = !work_.empty() && !pulsed_;
+            pulsed_ = pulsed_ || pending;
+        }
+        if (pending) {
+            wakeUp(wake);
+        }
+        return true;
+    }
+
+    // Timers must go before the channel they pulse
+    void stopTimers() noexcept {
+        for (auto& timer : timers_) {
+            timer->timer.reset();
+        }
+    }
+
+    bool post(std::function<void()> work) override {
+        ClientConnection* wake = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return false;
+            }
+            work_.push_back(std::move(work));
+            if (!pulsed_ && wake_ != nullptr) {
+                pulsed_ = true;
+                wake = wake_;
+            }
+        }
+        posted_.fetch_add(1, std::memory_order_relaxed);
+        if (wake != nullptr) {
+            wakeUp(*wake);
+        }
+        return true;
+    }
+
+    void runWork() {
+        std::vector<std::function<void()>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch.swap(work_);
+            pulsed_ = false;
+        }
+        if (batch.empty()) {
+            return;
+        }
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        for (auto& work : batch) {
+            work();
+        }
+    }
+
+    void runTimer(int index) {
+        if (index < 0 || static_cast<size_t>(index) >= timers_.size()) {
+            return;
+        }
+        Timer& timer = *timers_[static_cast<size_t>(index)];
+        if (timer.running.exchange(true, std::memory_order_acquire)) {
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        timer.work();
+        timer.running.store(false, std::memory_order_release);
+        runs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Refuse further posts and run what is left on the calling thread
+    void close() {
+        std::vector<std::function<void()>> rest;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            wake_ = nullptr;
+            rest.swap(work_);
+        }
+        for (auto& work : rest) {
+            work();
+        }
+    }
+
+    // Only the first caller sends the stop pulses
+    [[nodiscard]] bool claimStop() noexcept {
+        return !stop_requested_.exchange(true, std::memory_order_acq_rel);
+    }
+
+    [[nodiscard]] bool stopRequested() const noexcept {
+        return stop_requested_.load(std::memory_order_acquire);
+    }
+
+    void countCancelled(size_t replies) noexcept {
+        cancelled_.fetch_add(replies, std::memory_order_relaxed);
+    }
+
+    EventStats stats() const noexcept {
+        return EventStats{
+            posted_.load(std::memory_order_relaxed),
+            batches_.load(std::memory_order_relaxed),
+            runs_.load(std::memory_order_relaxed),
+            overruns_.load(std::memory_order_relaxed),
+            cancelled_.load(std::memory_order_relaxed)
+        };
+    }
+
+private:
+    struct Timer {
+        Timer(std::chrono::milliseconds interval, std::function<void()> callback)
+            : period(interval), work(std::move(callback)) {}
+
+        std::chrono::milliseconds period;
+        std::function<void()> work;
+        std::unique_ptr<PulseTimer> timer;
+        std::atomic<bool> running{false};
+    };
+
+    std::vector<std::unique_ptr<Timer>> timers_;    // Fixed once run() starts
+    std::atomic<bool> stop_requested_{false};
+
+    std::mutex mutex_;
+    std::vector<std::function<void()>> work_;       // mutex_
+    ClientConnection* wake_ = nullptr;              // mutex_; main lane's self
+    bool pulsed_ = false;                           // mutex_; a wake-up is queued
+    bool closed_ = false;                           // mutex_
+
+    std::atomic<uint64_t> posted_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> runs_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> cancelled_{0};
+
+    // A lost wake-up is retried by the next post(), or run at close()
+    void wakeUp(ClientConnection& wake) {
+        if (wake.sendPulse(PULSE_CODE_RUN_WORK, 0) == -1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pulsed_ = false;
+        }
+    }
+};
+
+/**
+ * @brief Deferred replies not sent yet, so shutdown can wait for them
+ *
+ * A PendingReply is listed from its creation until it has replied;
+ * cancel() answers one whose sender timed out (TRANSPORT_PULSE_UNBLOCK)
+ * and cancelAll() answers the rest itself at the drain deadline.
+ */
+class SecureMessageReceiver::PendingTable {
+public:
+    void add(PendingReply* reply) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        replies_.push_back(reply);
+    }
+
+    void remove(PendingReply* reply) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = std::find(replies_.begin(), replies_.end(), reply);
+        if (it != replies_.end()) {
+            *it = replies_.back();
+            replies_.pop_back();
+        }
+        if (replies_.empty()) {
+            drained_cv_.notify_all();
+        }
+    }
+
+    [[nodiscard]] size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return replies_.size();
+    }
+
+    [[nodiscard]] bool waitDrained(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return drained_cv_.wait_until(lock, deadline, [this] { return replies_.empty(); });
+    }
+
+    // Defined after PendingReply
+    bool cancel(int rcvid, const Lane& lane, int status);
+    size_t cancelAll(int status);
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable drained_cv_;
+    std::vector<PendingReply*> replies_;
+};
+
+/**
+ * @brief The receiver's own connections to one lane: self, stopper, timers
+ *
+ * Any client can send any pulse code, so private codes are only acted on
+ * when they arrive on one of these. A connection is recognised by its
+ * pid (one clientInfo() call) and remembered; timer pulses on a Linux
+ * host come with no connection, as scoid 0.
+ */
+class SecureMessageReceiver::OwnConnections {
+public:
+    [[nodiscard]] bool contains(ServerChannel& channel, int scoid) {
+        if (scoid == 0) {
+            return true;
+        }
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            if (std::find(scoids_.begin(), scoids_.end(), scoid) != scoids_.end()) {
+                return true;
+            }
+        }
+
+        const HotPathExempt setup;
+        ClientCredentials credentials{};
+        if (channel.clientInfo(scoid, credentials) == -1 || credentials.pid != ::getpid()) {
+            return false;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        scoids_.push_back(scoid);
+        return true;
+    }
+
+    // The scoid may be reused by a client once the connection is gone
+    void forget(int scoid) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        scoids_.erase(std::remove(scoids_.begin(), scoids_.end(), scoid), scoids_.end());
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::vector<int> scoids_;
+};
+
+/**
+ * @brief One named channel and the settings of the workers serving it
+ */
+struct SecureMessageReceiver::Lane {
+    std::string name;
+    LaneConfig config;
+    std::unique_ptr<ServerChannel> channel;
+    std::unique_ptr<ClientConnection> self;     // Internal pulses to this channel
+    std::unique_ptr<ClientConnection> stopper;  // Only requestStop() sends on it
+    std::unique_ptr<CreditController> credits;
+    std::unique_ptr<ClientTable> clients;
+    std::unique_ptr<OwnConnections> own;        // Senders of private pulses
+    ThreadPool* pool;                           // While runLane() runs a pool
+};
+
+/**
+ * @brief One receive context: buffers plus the last received rcvid
+ *
+ * Drives receive/reply either inline (single-threaded mode) or as a
+ * ThreadPool worker, so both modes share the same receive path.
+ *
+ * receive() only takes the header and the first INLINE_PAYLOAD_SIZE
+ * payload bytes. Larger payloads are pulled with a single read() into
+ * a BufferPool buffer sized from the header, taken from this thread's
+ * cache and handed back after the reply unless a handler kept it.
+ *
+ * The sender's ClientEntry is fetched from the lane's ClientTable before
+ * the payload is read, so unauthorized or over-rate clients are refused
+ * without copying it.
+ *
+ * Every request is admitted to the lane's CreditController once read
+ * and completed after its reply; replies to joined connections carry
+ * their next CreditGrant after the status. A handler that defers its
+ * reply gets a PendingReply carrying all of that instead.
+ *
+ * Handlers add a reply payload through ReplyPayload: buffers taken from
+ * the BufferPool through this thread's cache, or bytes they keep valid.
+ * The reply gathers them after the status and grant, one iovec per part,
+ * and reports the payload size as the reply's status; pooled parts go
+ * back to the cache once it is sent.
+ *
+ * A MSG_TYPE_DEADLINE envelope is unwrapped right after the read; the
+ * message it bounds is refused with ETIMEDOUT instead of handled once
+ * its deadline has passed. A MSG_TYPE_SHM_PAYLOAD message is unwrapped
+ * next: its payload is read in place from a segment the client shared,
+ * mapped read-only once and held until the reply (by the worker, or by
+ * a handler that keeps it through MessageContext::segment).
+ *
+ * In realtime mode handle() is the hot path watched for allocations;
+ * one-off work on it (a new connection's lookup) is exempted.
+ *
+ * The stop pulse ends the worker: block() then returns false, which
+ * ends the single-thread loop, and a pool is stopped outright so that
+ * no worker is left blocked on the channel.
+ */
+class SecureMessageReceiver::ReceiveWorker : public PoolWorker, private ReplyDeferral,
+                                             private ReplyPayload {
+public:
+    // Constructed on the thread that runs it, which then owns the cache
+    // and, in realtime mode, gets its policy, CPU, prefaulted stack, log
+    // ring and a stocked cache
+    ReceiveWorker(SecureMessageReceiver& receiver, const Lane& lane)
+        : receiver_(receiver), lane_(lane), cache_(receiver.buffers_->attach()) {
+        const RealtimeConfig& realtime = receiver_.realtime_;
+        if (!realtime.enabled) {
+            return;
+        }
+        BinaryLog::attachThread();
+        if (!enterRealtimeThread(realtime, lane_.config.priority)) {
+            IPC_LOG_WARN("Receive thread of {} not fully realtime: {}", lane_.name,
+                         std::strerror(errno));
+        }
+        if (!receiver_.buffers_->warm(*cache_, REALTIME_WARM_BYTES)) {
+            IPC_LOG_WARN("Receive thread of {}: buffer cap reached before its cache was"
+                         " stocked", lane_.name);
+        }
+    }
+
+    ~ReceiveWorker() override {
+        buffer_.reset();
+        segment_.reset();
+        releaseReply();
+        receiver_.buffers_->detach(cache_);
+    }
+
+    ReceiveWorker(const ReceiveWorker&) = delete;
+    ReceiveWorker& operator=(const ReceiveWorker&) = delete;
+
+    bool block() override {
+        if (stopping_) {
+            return false;
+        }
+        while (true) {
+            rcvid_ = lane_.channel->receive(recv_.data(), recv_.size(), info_);
+            if (rcvid_ != -1) {
+                received_ = std::chrono::steady_clock::now();
+                return true;
+            }
+
+            if (receiver_.isSecurityError(errno)) {
+                receiver_.handleSecurityViolation(errno);
+                continue;
+            }
+
+            IPC_LOG_ERROR("Receive on {} failed: {}", lane_.name, std::strerror(errno));
+            return false;
+        }
+    }
+
+    void handle() override {
+        const HotPathScope hot_path;
+        admission_.reset();
+        client_.reset();
+        resetDeferral();
+        shared_segment_.reset();
+        process();
+        if (admission_ && !deferred()) {
+            lane_.credits->complete(info_.scoid, *admission_,
+                                    std::chrono::steady_clock::now() - received_);
+        }
+        buffer_.reset();
+        segment_.reset();
+        releaseReply();
+    }
+
+private:
+    SecureMessageReceiver& receiver_;
+    const Lane& lane_;
+    BufferCache* cache_;
+    // Payload lands SCHEMA_MAX_ALIGN-aligned after the 8-byte header
+    alignas(SCHEMA_MAX_ALIGN)
+        std::array<char, sizeof(MessageHeader) + INLINE_PAYLOAD_SIZE> recv_{};
+    BufferHandle buffer_;
+    ShmSegmentHold segment_;                        // Holds a shared-memory payload
+    std::optional<uint32_t> shared_segment_;        // Its segment id, even if unmapped
+    std::array<iovec, MAX_REPLY_PARTS> reply_parts_{};
+    std::array<BufferHandle, MAX_REPLY_PARTS> reply_buffers_;   // Pooled parts
+    size_t reply_count_ = 0;
+    size_t reply_bytes_ = 0;
+    ReceiveInfo info_{};
+    MessageView msg_{};
+    std::optional<Admission> admission_;
+    std::shared_ptr<ClientEntry> client_;
+    CreditGrant grant_{};
+    bool credited_ = false;
+    bool stopping_ = false;
+    int rcvid_ = -1;
+    std::chrono::steady_clock::time_point received_;
+    std::chrono::steady_clock::time_point deadline_ = NO_DEADLINE;
+
+    void process() {
+        if (rcvid_ == 0) {
+            if (info_.pulse.code == PULSE_CODE_SHUTDOWN &&
+                lane_.own->contains(*lane_.channel, info_.pulse.scoid)) {
+                stopping_ = true;
+                if (lane_.pool != nullptr) {
+                    lane_.pool->stop();
+                }
+                return;
+            }
+            receiver_.count(Counter::PULSES);
+            receiver_.handlePulse(info_.pulse, lane_);
+            return;
+        }
+
+        ServerChannel& channel = *lane_.channel;
+        client_ = lane_.clients->lookup(channel, info_.scoid, info_.pid);
+        if (!client_) {
+            channel.error(rcvid_, ESRCH);
+            return;
+        }
+        if (!receiver_.admitClient(channel, rcvid_, *client_, lane_)) {
+            return;
+        }
+
+        int error = readMessage();
+        if (error == ENOBUFS) {
+            if (receiver_.handleBuffersExhausted(channel, rcvid_)) {
+                dropMessage();
+            }
+            return;
+        }
+        if (error == EOK) {
+            error = unwrapDeadline();
+        }
+        if (error == EOK) {
+            error = unwrapShared();
+        }
+        if (error != EOK) {
+            receiver_.count(Counter::PROTOCOL_ERRORS);
+            forgetSegment();
+            channel.error(rcvid_, error);
+            return;
+        }
+        client_->countMessage(msg_.payload.size());
+        receiver_.capture(CaptureKind::MESSAGE, info_.pid, info_.scoid, msg_);
+
+        admission_ = lane_.credits->admit(info_.scoid, msg_.type == MSG_TYPE_CREDIT);
+        if (*admission_ == Admission::OVERRUN) {
+            receiver_.count(Counter::CREDIT_OVERRUNS);
+            forgetSegment();
+            channel.error(rcvid_, EAGAIN);
+            return;
+        }
+        if (deadline_ != NO_DEADLINE && std::chrono::steady_clock::now() >= deadline_) {
+            // The sender has given up or is about to: skip the work
+            receiver_.count(Counter::DEADLINE_EXPIRED);
+            client_->countExpired();
+            forgetSegment();
+            channel.error(rcvid_, ETIMEDOUT);
+            return;
+        }
+
+        if (msg_.type == MSG_TYPE_RING_SETUP) {
+            receiver_.handleRingSetup(channel, rcvid_, info_, msg_);
+            return;
+        }
+        if (msg_.type == MSG_TYPE_CREDIT) {
+            receiver_.handleCreditRequest(channel, rcvid_, info_, msg_, lane_);
+            return;
+        }
+
+        credited_ = (*admission_ == Admission::CREDITED);
+        if (credited_) {
+            grant_ = lane_.credits->grant(info_.scoid);
+        }
+
+        if (msg_.type == MSG_TYPE_BATCH) {
+            receiver_.handleBatch(channel, rcvid_, msg_, &client_->identity(),
+                                  credited_ ? &grant_ : nullptr);
+            receiver_.recordLatency(std::chrono::steady_clock::now() - received_);
+            return;
+        }
+
+        // Message successfully received from authorized sender
+        const int status = receiver_.dispatchMessage(rcvid_, msg_, &client_->identity(),
+                                                     &buffer_, &segment_, this, this,
+                                                     deadline_);
+        if (deferred()) {
+            return;     // The PendingReply answers, accounts and completes
+        }
+        sendReply(status);
+    }
+
+    // DROP policy: the payload is never read, but the sender is released
+    // as if accepted and a joined connection still gets its grant
+    void dropMessage() {
+        admission_ = lane_.credits->admit(info_.scoid, false);
+        if (*admission_ == Admission::OVERRUN) {
+            receiver_.count(Counter::CREDIT_OVERRUNS);
+            lane_.channel->error(rcvid_, EAGAIN);
+            return;
+        }
+        credited_ = (*admission_ == Admission::CREDITED);
+        if (credited_) {
+            grant_ = lane_.credits->grant(info_.scoid);
+        }
+        sendReply(EOK);
+    }
+
+    void sendReply(int status) {
+        ServerChannel& channel = *lane_.channel;
+        if (status != EOK) {
+            forgetSegment();
+        }
+
+        // Status, a joined connection's grant, then the payload parts
+        std::array<iovec, 2 + MAX_REPLY_PARTS> reply;
+        size_t parts = 0;
+        reply[parts++] = iovec{const_cast<int*>(&status), sizeof(status)};
+        if (credited_) {
+            reply[parts++] = iovec{&grant_, sizeof(grant_)};
+        }
+        std::copy_n(reply_parts_.begin(), reply_count_, reply.begin() + parts);
+        parts += reply_count_;
+        channel.reply(rcvid_, static_cast<int>(reply_bytes_), reply.data(),
+                      static_cast<int>(parts));
+        if (reply_bytes_ > 0) {
+            receiver_.count(Counter::REPLY_BYTES, reply_bytes_);
+        }
+        receiver_.recordLatency(std::chrono::steady_clock::now() - received_);
+    }
+
+    std::unique_ptr<DeferredReply> takeReply() override;
+
+    // The sender destroys a segment whose message is not answered with
+    // EOK, so its mapping goes too (once the message no longer holds it)
+    void forgetSegment() noexcept {
+        if (shared_segment_) {
+            client_->segments().release(*shared_segment_);
+        }
+    }
+
+    char* allocate(size_t size) override {
+        if (reply_count_ == MAX_REPLY_PARTS) {
+            return nullptr;
+        }
+        BufferHandle buffer = receiver_.buffers_->acquire(*cache_, size);
+        if (!buffer) {
+            return nullptr;
+        }
+        char* const data = buffer.data();
+        reply_buffers_[reply_count_] = std::move(buffer);
+        reply_parts_[reply_count_++] = iovec{data, size};
+        reply_bytes_ += size;
+        return data;
+    }
+
+    bool append(std::string_view bytes) noexcept override {
+        if (reply_count_ == MAX_REPLY_PARTS) {
+            return false;
+        }
+        reply_parts_[reply_count_++] = iovec{const_cast<char*>(bytes.data()), bytes.size()};
+        reply_bytes_ += bytes.size();
+        return true;
+    }
+
+    size_t size() const noexcept override { return reply_bytes_; }
+
+    // Also drops parts added by a handler that then deferred
+    void releaseReply() noexcept {
+        for (size_t i = 0; i < reply_count_; ++i) {
+            reply_buffers_[i].reset();
+        }
+        reply_count_ = 0;
+        reply_bytes_ = 0;
+    }
+
+    /**
+     * @brief Validate the header and make the whole payload available
+     * @return EOK, ENOBUFS if no pool buffer is available, or the errno
+     *         to return to the sender
+     */
+    int readMessage() {
+        if (info_.msglen < sizeof(MessageHeader)) {
+            return EBADMSG;
+        }
+
+        MessageHeader header;
+        std::memcpy(&header, recv_.data(), sizeof(header));
+
+        if (header.size > MAX_PAYLOAD_SIZE) {
+            return EMSGSIZE;
+        }
+        if (sizeof(header) + header.size != info_.srcmsglen) {
+            return EBADMSG;
+        }
+
+        const size_t have = info_.msglen - sizeof(header);
+        const char* payload = recv_.data() + sizeof(header);
+
+        if (header.size > have) {
+            buffer_ = receiver_.buffers_->acquire(*cache_, header.size);
+            if (!buffer_) {
+                return ENOBUFS;
+            }
+            std::memcpy(buffer_.data(), payload, have);
+
+            // One kernel call copies the rest straight from the sender
+            const size_t rest = header.size - have;
+            if (lane_.channel->read(rcvid_, buffer_.data() + have, rest,
+                                    sizeof(header) + have) != static_cast<ssize_t>(rest)) {
+                return EFAULT;
+            }
+            payload = buffer_.data();
+        }
+
+        msg_ = MessageView{
+            header.type,
+            header.subtype,
+            std::string_view(payload, header.size)
+        };
+        return EOK;
+    }
+
+    /**
+     * @brief Replace a MSG_TYPE_DEADLINE envelope by the message it bounds
+     *        and set deadline_
+     * @return EOK, or EBADMSG for a malformed envelope or one around a
+     *         control message
+     */
+    int unwrapDeadline() {
+        deadline_ = NO_DEADLINE;
+        if (msg_.type != MSG_TYPE_DEADLINE) {
+            return EOK;
+        }
+
+        DeadlineHeader bound;
+        MessageHeader inner;
+        if (msg_.payload.size() < sizeof(bound) + sizeof(inner)) {
+            return EBADMSG;
+        }
+        std::memcpy(&bound, msg_.payload.data(), sizeof(bound));
+        std::memcpy(&inner, msg_.payload.data() + sizeof(bound), sizeof(inner));
+        const std::string_view payload = msg_.payload.substr(sizeof(bound) + sizeof(inner));
+        if (inner.size != payload.size() ||
+            (inner.type >= MSG_TYPE_CONTROL_BASE && inner.type != MSG_TYPE_SHM_PAYLOAD)) {
+            return EBADMSG;
+        }
+
+        // The budget runs from the send, so time spent queued counts
+        const std::chrono::steady_clock::time_point sent{
+            std::chrono::nanoseconds(bound.sent_ns)};
+        deadline_ = std::min(sent, received_) + std::chrono::microseconds(bound.budget_us);
+        msg_ = MessageView{inner.type, inner.subtype, payload};
+        return EOK;
+    }
+
+    /**
+     * @brief Replace a MSG_TYPE_SHM_PAYLOAD message by the one it carries,
+     *        whose payload stays in the client's segment
+     * @return EOK, EBADMSG for a malformed header or one around a control
+     *         message, or the error of ShmSegmentMap::resolve()
+     */
+    int unwrapShared() {
+        if (msg_.type != MSG_TYPE_SHM_PAYLOAD) {
+            return EOK;
+        }
+
+        ShmPayloadHeader shared;
+        if (msg_.payload.size() != sizeof(shared)) {
+            return EBADMSG;
+        }
+        std::memcpy(&shared, msg_.payload.data(), sizeof(shared));
+        if (shared.type >= MSG_TYPE_CONTROL_BASE) {
+            return EBADMSG;
+        }
+
+        // Mapping a new segment is one-off setup, like a connection's lookup
+        std::optional<HotPathExempt> setup;
+        if ((shared.flags & SHM_SEGMENT_NEW) != 0) {
+            setup.emplace();
+        }
+        shared_segment_ = shared.segment;
+        bool mapped = false;
+        std::shared_ptr<const ShmMapping> mapping;
+        const int error = client_->segments().resolve(shared, mapping, mapped);
+
+        // Held (and released, if the sender asked) even if it failed to map;
+        // the map lives as long as the client entry
+        std::optional<uint32_t> release;
+        if ((shared.flags & SHM_SEGMENT_RELEASE) != 0) {
+            release = shared.segment;
+        }
+        segment_ = ShmSegmentHold(std::move(mapping),
+                                  std::shared_ptr<ShmSegmentMap>(client_, &client_->segments()),
+                                  release);
+        if (error != EOK) {
+            return error;
+        }
+        if (mapped) {
+            receiver_.count(Counter::SHM_SEGMENTS);
+        }
+        receiver_.count(Counter::SHM_PAYLOADS);
+        msg_ = MessageView{shared.type, shared.subtype,
+                           std::string_view(segment_.mapping()->data(), shared.size)};
+        return EOK;
+    }
+};
+
+/**
+ * @brief The reply to a request whose handler returned without answering
+ *
+ * Holds what the ReceiveWorker would have replied with (rcvid, credit
+ * grant, admission, receive time, shared-memory segment) and the client
+ * entry, so a late reply is accounted exactly like an inline one.
+ * Handlers on QNX run at the client's priority only while on the worker;
+ * finishing later, they run at the priority of whichever thread calls
+ * send().
+ */
+class SecureMessageReceiver::PendingReply : public DeferredReply {
+public:
+    PendingReply(SecureMessageReceiver& receiver, const Lane& lane, int rcvid, int scoid,
+                 std::optional<Admission> admission, std::optional<CreditGrant> grant,
+                 std::chrono::steady_clock::time_point received,
+                 std::shared_ptr<ClientEntry> client,
+                 std::optional<uint32_t> segment) noexcept
+        : receiver_(receiver), lane_(lane), rcvid_(rcvid), scoid_(scoid),
+          admission_(admission), grant_(grant), received_(received),
+          client_(std::move(client)), segment_(segment) {}
+
+    ~PendingReply() override {
+        send(ECANCELED, std::string_view());
+    }
+
+    PendingReply(const PendingReply&) = delete;
+    PendingReply& operator=(const PendingReply&) = delete;
+
+    using DeferredReply::send;
+
+    void send(int status, std::string_view payload) noexcept override {
+        if (sent_.exchange(true, std::memory_order_acq_rel)) {
+            return;     // Already sent, or cancelled
+        }
+        finish(status, payload);
+        receiver_.pending_->remove(this);
+    }
+
+    [[nodiscard]] bool answers(int rcvid, const Lane& lane) const noexcept {
+        return rcvid_ == rcvid && &lane_ == &lane;
+    }
+
+    // Called by PendingTable::cancel()/cancelAll() with its lock held
+    [[nodiscard]] bool cancel(int status) noexcept {
+        if (sent_.exchange(true, std::memory_order_acq_rel)) {
+            return false;
+        }
+        finish(status, std::string_view());
+        return true;
+    }
+
+private:
+    SecureMessageReceiver& receiver_;
+    const Lane& lane_;
+    int rcvid_;
+    int scoid_;
+    std::optional<Admission> admission_;
+    std::optional<CreditGrant> grant_;
+    std::chrono::steady_clock::time_point received_;
+    std::shared_ptr<ClientEntry> client_;   // Keeps MessageContext::client alive
+    std::optional<uint32_t> segment_;       // Shared-memory payload's segment
+    std::atomic<bool> sent_{false};
+
+    void finish(int status, std::string_view payload) noexcept {
+        if (status != EOK) {
+            receiver_.count(Counter::REPLY_ERRORS);
+            if (segment_) {
+                client_->segments().release(*segment_);     // As ReceiveWorker does
+            }
+        }
+
+        std::array<iovec, 3> reply;
+        int parts = 0;
+        reply[parts++] = iovec{&status, sizeof(status)};
+        if (grant_) {
+            reply[parts++] = iovec{&*grant_, sizeof(CreditGrant)};
+        }
+        reply[parts++] = iovec{const_cast<char*>(payload.data()), payload.size()};
+        lane_.channel->reply(rcvid_, static_cast<int>(payload.size()), reply.data(), parts);
+        if (!payload.empty()) {
+            receiver_.count(Counter::REPLY_BYTES, payload.size());
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - received_;
+        if (admission_) {
+            lane_.credits->complete(scoid_, *admission_, elapsed);
+        }
+        receiver_.recordLatency(elapsed);
     }
+};
+
+std::unique_ptr<DeferredReply> SecureMessageReceiver::ReceiveWorker::takeReply() {
+    auto reply = std::make_unique<PendingReply>(
+        receiver_, lane_, rcvid_, info_.scoid, admission_,
+        credited_ ? std::optional<CreditGrant>(grant_) : std::nullopt, received_, client_,
+        shared_segment_);
+    receiver_.pending_->add(reply.get());
+    return reply;
+}
+
+bool SecureMessageReceiver::PendingTable::cancel(int rcvid, const Lane& lane, int status) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = std::find_if(replies_.begin(), replies_.end(),
+                                 [&](const PendingReply* reply) {
+                                     return reply->answers(rcvid, lane);
+                                 });
+    // Not listed, or replying on another thread right now
+    if (it == replies_.end() || !(*it)->cancel(status)) {
+        return false;
+    }
+    *it = replies_.back();
+    replies_.pop_back();
+    if (replies_.empty()) {
+        drained_cv_.notify_all();
+    }
+    return true;
+}
+
+size_t SecureMessageReceiver::PendingTable::cancelAll(int status) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t cancelled = 0;
+    for (size_t i = 0; i < replies_.size();) {
+        if (replies_[i]->cancel(status)) {
+            replies_[i] = replies_.back();
+            replies_.pop_back();
+            ++cancelled;
+        } else {
+            ++i;
+        }
+    }
+    // The rest are replying on other threads right now; that is quick
+    drained_cv_.wait(lock, [this] { return replies_.empty(); });
+    return cancelled;
 }
 
 // SecureMessageReceiver implementation
-SecureMessageReceiver::SecureMessageReceiver(std::string_view name)
-    : name_(name), attach_(nullptr) {}
+SecureMessageReceiver::SecureMessageReceiver(
+    std::string_view name, std::optional<ThreadPoolConfig> pool_config)
+    : name_(name),
+      rings_(std::make_unique<RingTable>()),
+      pulses_(std::make_unique<PulseRouter>()),
+      pending_(std::make_unique<PendingTable>()),
+      events_(std::make_unique<EventQueue>()),
+      drain_timeout_(DEFAULT_DRAIN_TIMEOUT),
+      dispatch_(nullptr) {
+    lanes_.push_back(std::make_unique<Lane>(
+        Lane{name_, LaneConfig{"", 0, pool_config},
+             nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr}));
+}
+
+SecureMessageReceiver::SecureMessageReceiver(SecureMessageReceiver&&) noexcept = default;
+SecureMessageReceiver& SecureMessageReceiver::operator=(SecureMessageReceiver&&) noexcept = default;
+SecureMessageReceiver::~SecureMessageReceiver() = default;
+
+bool SecureMessageReceiver::addLane(LaneConfig lane) {
+    if (lane.suffix.empty()) {
+        return false;
+    }
+    for (const auto& existing : lanes_) {
+        if (existing->config.suffix == lane.suffix) {
+            return false;
+        }
+    }
+
+    std::string lane_name = name_ + "." + lane.suffix;
+    lanes_.push_back(std::make_unique<Lane>(
+        Lane{std::move(lane_name), std::move(lane),
+             nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr}));
+    return true;
+}
 
 bool SecureMessageReceiver::initialize() {
     displayStartupInfo();
 
-    // Use raw pointer temporarily, then wrap in unique_ptr
-    name_attach_t* raw_attach = name_attach(nullptr, name_.c_str(), 0);
-    if (raw_attach == nullptr) {
-        std::cerr << "Error: Failed to attach name: "
-                  << std::strerror(errno) << "\n";
-        return false;
+    // Locked first: pools and slabs created below are then mapped and
+    // locked as they are allocated
+    if (realtime_.enabled) {
+        if (!lockMemory()) {
+            std::cerr << "Error: Cannot lock memory for realtime mode: "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+        IPC_LOG_INFO("Realtime mode: memory locked, policy {} priority {}, {} CPUs to pin to",
+                     policyName(realtime_.policy), realtime_.priority, realtime_.cpus.size());
+        if (!hotPathWatchAvailable()) {
+            IPC_LOG_WARN("Hot-path allocations are not tracked (allocation_hook not linked)");
+        }
+    }
+
+    for (auto& lane : lanes_) {
+        if (!attachLane(*lane)) {
+            for (auto& attached : lanes_) {
+                attached->stopper.reset();
+                attached->self.reset();
+                attached->channel.reset();
+            }
+            return false;
+        }
+    }
+
+    // Counters are optional: run without them rather than fail
+    metrics_ = IpcMetrics::create(name_);
+    if (realtime_.enabled) {
+        buffer_config_.prefill = true;
     }
+    buffers_ = std::make_unique<BufferPool>(buffer_config_);
 
-    // Transfer ownership to unique_ptr
-    attach_ = NameAttachPtr(raw_attach);
+    // Credits are sized by how many requests a lane can handle at once
+    for (auto& lane : lanes_) {
+        const unsigned workers = lane->config.pool ? lane->config.pool->maximum : 1;
+        lane->credits = std::make_unique<CreditController>(flow_config_, workers);
+        lane->clients = std::make_unique<ClientTable>(client_policy_);
+        lane->own = std::make_unique<OwnConnections>();
+    }
 
-    std::cout << "Secure channel created (chid: "
-              << attach_->chid << ")\n";
-    std::cout << "Security policy active\n";
-    std::cout << "Waiting for authorized messages...\n";
-    std::cout << "===========================================\n\n";
+    for (size_t i = 1; i < lanes_.size(); ++i) {
+        IPC_LOG_INFO("Lane {} (chid: {}, priority {})", lanes_[i]->name,
+                     lanes_[i]->channel->id(), lanes_[i]->config.priority);
+    }
+    IPC_LOG_INFO("Secure channel created (chid: {}, transport: {})\n"
+                 "Security policy active\n"
+                 "Waiting for authorized messages...\n"
+                 "===========================================\n",
+                 lanes_.front()->channel->id(), transportName());
 
     return true;
 }
 
+bool SecureMessageReceiver::attachLane(Lane& lane) {
+    lane.channel = attachChannel(lane.name);
+    if (!lane.channel) {
+        std::cerr << "Error: Failed to attach name " << lane.name << ": "
+                  << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    // Connections to our own channel for internal pulses; the stop pulse
+    // has its own so a signal handler never waits on another sender
+    lane.self = lane.channel->connectSelf();
+    lane.stopper = lane.channel->connectSelf();
+    if (!lane.self || !lane.stopper) {
+        std::cerr << "Error: Cannot connect to own channel: "
+                  << std::strerror(errno) << "\n";
+        lane.self.reset();
+        lane.stopper.reset();
+        lane.channel.reset();
+        return false;
+    }
+    return true;
+}
+
 void SecureMessageReceiver::run() {
-    if (!attach_) {
+    Lane& main = *lanes_.front();
+    if (!main.channel) {
         std::cerr << "Error: Receiver not initialized\n";
         return;
     }
+    if (realtime_.enabled) {
+        events_->addTimer(HOT_PATH_REPORT_PERIOD, [this] { reportHotPath(); });
+    }
+    if (!events_->start(*main.channel, *main.self)) {
+        return;
+    }
+    if (realtime_.enabled) {
+        armHotPathWatch();
+    }
 
-    Message msg{};
-    int rcvid;
+    // A stop requested before the lanes existed sent no pulses
+    if (!events_->stopRequested()) {
+        std::vector<std::thread> lane_threads;
+        for (size_t i = 1; i < lanes_.size(); ++i) {
+            lane_threads.emplace_back([this, lane = lanes_[i].get()] { runLane(*lane); });
+        }
 
-    while (true) {
-        rcvid = MsgReceive(attach_->chid, &msg, sizeof(msg), nullptr);
+        runLane(main);
 
-        if (rcvid == -1) {
-            if (isSecurityError(errno)) {
-                handleSecurityViolation(errno);
-                continue;
-            }
+        for (auto& thread : lane_threads) {
+            thread.join();
+        }
+    }
 
-            std::cerr << "Error: MsgReceive failed: "
-                      << std::strerror(errno) << "\n";
-            break;
+    events_->stopTimers();
+    drainDeferred();
+    events_->close();
+    if (realtime_.enabled) {
+        reportHotPath();
+    }
+}
+
+void SecureMessageReceiver::reportHotPath() {
+    const HotPathStats stats = hotPathStats();
+    if (stats.allocations == hot_path_reported_) {
+        return;
+    }
+    const uint64_t fresh = stats.allocations - hot_path_reported_;
+    hot_path_reported_ = stats.allocations;
+    if (metrics_) {
+        metrics_->add(Counter::HOT_PATH_ALLOCS, fresh);
+    }
+    IPC_LOG_WARN("{} heap allocations on the message path ({} in total, {} bytes,"
+                 " largest {} bytes)", fresh, stats.allocations, stats.bytes, stats.largest);
+}
+
+void SecureMessageReceiver::drainDeferred() {
+    const size_t pending = pending_->size();
+    if (pending == 0) {
+        return;
+    }
+
+    IPC_LOG_INFO("Waiting up to {} ms for {} deferred replies", drain_timeout_.count(),
+                 pending);
+    if (pending_->waitDrained(std::chrono::steady_clock::now() + drain_timeout_)) {
+        return;
+    }
+
+    // Handlers may still finish later; their send() then does nothing
+    const size_t cancelled = pending_->cancelAll(ETIMEDOUT);
+    events_->countCancelled(cancelled);
+    IPC_LOG_WARN("{} deferred replies did not finish in time; answered ETIMEDOUT",
+                 cancelled);
+}
+
+void SecureMessageReceiver::requestStop() noexcept {
+    if (!events_->claimStop()) {
+        return;
+    }
+    for (const auto& lane : lanes_) {
+        if (lane->stopper) {
+            (void)lane->stopper->sendPulse(PULSE_CODE_SHUTDOWN, 0);
+        }
+    }
+}
+
+void SecureMessageReceiver::setDrainTimeout(std::chrono::milliseconds timeout) noexcept {
+    drain_timeout_ = timeout;
+}
+
+bool SecureMessageReceiver::addTimer(std::chrono::milliseconds period,
+                                     std::function<void()> work) {
+    if (period.count() <= 0 || !work) {
+        return false;
+    }
+    events_->addTimer(period, std::move(work));
+    return true;
+}
+
+bool SecureMessageReceiver::post(std::function<void()> work) {
+    return events_->post(std::move(work));
+}
+
+EventStats SecureMessageReceiver::eventStats() const noexcept {
+    return events_->stats();
+}
+
+void SecureMessageReceiver::runLane(Lane& lane) {
+    if (!lane.config.pool) {
+        // Realtime mode sets policy and priority together in the worker
+        if (!realtime_.enabled && lane.config.priority != 0 &&
+            !setThreadPriority(lane.config.priority)) {
+            std::cerr << "Error: Cannot set priority " << lane.config.priority
+                      << " for " << lane.name << "\n";
+        }
+        ReceiveWorker worker(*this, lane);
+        while (worker.block()) {
+            worker.handle();
         }
+        return;
+    }
+
+    ThreadPoolConfig config = *lane.config.pool;
+    if (realtime_.enabled) {
+        // Every worker exists before the first message, and none exits
+        config.lo_water = config.maximum;
+        config.hi_water = config.maximum;
+        config.priority = 0;
+    } else if (lane.config.priority != 0) {
+        config.priority = lane.config.priority;
+    }
+
+    ThreadPool pool(
+        config,
+        [this, &lane] { return std::make_unique<ReceiveWorker>(*this, lane); },
+        [&lane] {
+            lane.self->sendPulse(PULSE_CODE_WAKE_WORKER, 0);
+        });
+
+    IPC_LOG_INFO("Worker pool ({}): lo_water={} hi_water={} maximum={}", lane.name,
+                 config.lo_water, config.hi_water, config.maximum);
+
+    lane.pool = &pool;
+    pool.start();
+    pool.wait();
+    lane.pool = nullptr;
+}
+
+void SecureMessageReceiver::setMessageDispatch(MessageDispatch dispatch) noexcept {
+    dispatch_ = dispatch;
+}
+
+void SecureMessageReceiver::registerTelemetryHandler(uint8_t type,
+                                                     TelemetryHandler handler) {
+    pulses_->setTelemetry(type, std::move(handler));
+}
+
+bool SecureMessageReceiver::registerPulseHandler(int code, PulseHandler handler) {
+    if (code < PULSE_CODE_USER_MIN || code > PULSE_CODE_USER_MAX) {
+        return false;
+    }
+    pulses_->setUser(code, std::move(handler));
+    return true;
+}
+
+bool SecureMessageReceiver::startCapture(const std::string& path, size_t max_bytes) {
+    capture_ = CaptureWriter::create(path, max_bytes);
+    if (!capture_) {
+        return false;
+    }
+    IPC_LOG_INFO("Capturing received traffic to {} (limit {} bytes)", path, max_bytes);
+    return true;
+}
+
+void SecureMessageReceiver::configureBuffers(const BufferPoolConfig& config) noexcept {
+    buffer_config_ = config;
+}
+
+BufferPoolStats SecureMessageReceiver::bufferStats() const {
+    return buffers_ ? buffers_->stats() : BufferPoolStats{};
+}
+
+void SecureMessageReceiver::configureRealtime(const RealtimeConfig& config) {
+    realtime_ = config;
+}
 
-        if (rcvid == 0) {
-            // Pulse received - ignore for now
+void SecureMessageReceiver::configureFlowControl(const FlowControlConfig& config) noexcept {
+    flow_config_ = config;
+}
+
+FlowControlStats SecureMessageReceiver::creditStats() const {
+    FlowControlStats total{};
+    for (const auto& lane : lanes_) {
+        if (!lane->credits) {
             continue;
         }
+        const FlowControlStats stats = lane->credits->stats();
+        total.connections += stats.connections;
+        total.in_flight += stats.in_flight;
+        total.window_total += stats.window_total;
+        total.budget += stats.budget;
+        total.service_ns = std::max(total.service_ns, stats.service_ns);
+        total.grants += stats.grants;
+        total.overruns += stats.overruns;
+    }
+    return total;
+}
 
-        // Message successfully received from authorized sender
-        handleAuthorizedMessage(rcvid, msg);
+void SecureMessageReceiver::configureClients(ClientPolicy policy) {
+    client_policy_ = std::move(policy);
+}
+
+std::vector<ClientStats> SecureMessageReceiver::clientStats() const {
+    std::vector<ClientStats> clients;
+    for (const auto& lane : lanes_) {
+        if (lane->clients) {
+            std::vector<ClientStats> stats = lane->clients->stats();
+            clients.insert(clients.end(), stats.begin(), stats.end());
+        }
     }
+    return clients;
+}
+
+uint64_t SecureMessageReceiver::clientLookups() const noexcept {
+    uint64_t lookups = 0;
+    for (const auto& lane : lanes_) {
+        if (lane->clients) {
+            lookups += lane->clients->lookups();
+        }
+    }
+    return lookups;
+}
+
+PulseStats SecureMessageReceiver::pulseStats() const noexcept {
+    return pulses_->stats();
 }
 
 std::optional<int> SecureMessageReceiver::getChannelId() const noexcept {
-    if (attach_) {
-        return attach_->chid;
+    if (lanes_.front()->channel) {
+        return lanes_.front()->channel->id();
     }
     return std::nullopt;
 }
 
 void SecureMessageReceiver::displayStartupInfo() const {
-    std::cout << "===========================================\n"
-              << "  QNX Secure Message Receiver\n"
-              << "===========================================\n"
-              << "Process ID: " << getpid() << "\n"
-              << "Attaching name: " << name_ << "\n"
-              << "Security: ENABLED (secpol enforced)\n"
-              << "Authorized: sender1 only\n";
+    IPC_LOG_INFO("===========================================\n"
+                 "  QNX Secure Message Receiver\n"
+                 "===========================================\n"
+                 "Process ID: {}\n"
+                 "Attaching name: {}\n"
+                 "Security: ENABLED (secpol enforced)\n"
+                 "Authorized: sender1 only",
+                 getpid(), name_);
+}
+
+int SecureMessageReceiver::dispatchMessage(int rcvid, const MessageView& msg,
+                                           const ClientIdentity* client,
+                                           BufferHandle* buffer,
+                                           ShmSegmentHold* segment,
+                                           ReplyDeferral* deferral,
+                                           ReplyPayload* reply,
+                                           std::chrono::steady_clock::time_point deadline) {
+    if (metrics_) {
+        metrics_->add(Counter::MESSAGES);
+        metrics_->add(Counter::PAYLOAD_BYTES, msg.payload.size());
+        metrics_->countMessage(msg.type, msg.subtype);
+    }
+
+    const int status = handleAuthorizedMessage(
+        MessageContext{rcvid, buffer, segment, client, deferral, reply, events_.get(),
+                       deadline}, msg);
+    if (status != EOK && !(deferral && deferral->deferred())) {
+        count(Counter::REPLY_ERRORS);
+    }
+    return status;
+}
+
+int SecureMessageReceiver::handleAuthorizedMessage(const MessageContext& ctx,
+                                                   const MessageView& msg) {
+    // One record per message, formatted later by the log thread; compiled
+    // out of release builds. Payloads are binary schemas, so the handler
+    // the dispatcher picks logs their fields
+    if (ctx.rcvid == 0) {
+        IPC_LOG_DEBUG("Authorized message from shared ring: type {} subtype {} size {}",
+                      msg.type, msg.subtype, msg.payload.size());
+    } else if (ctx.client != nullptr) {
+        IPC_LOG_DEBUG("Authorized message from {} (pid {}, uid {}, rcvid {}): "
+                      "type {} subtype {} size {}",
+                      ctx.client->program, ctx.client->credentials.pid,
+                      ctx.client->credentials.euid, ctx.rcvid,
+                      msg.type, msg.subtype, msg.payload.size());
+    } else {
+        IPC_LOG_DEBUG("Authorized message from rcvid {}: type {} subtype {} size {}",
+                      ctx.rcvid, msg.type, msg.subtype, msg.payload.size());
+    }
+
+    if (dispatch_ == nullptr) {
+        return EOK;
+    }
+    return dispatch_(ctx, msg);
+}
+
+bool SecureMessageReceiver::admitClient(ServerChannel& channel, int rcvid,
+                                        ClientEntry& client, const Lane& lane) {
+    if (!client.authorized()) {
+        client.countDenied();
+        count(Counter::SECURITY_VIOLATIONS);
+        channel.error(rcvid, EPERM);
+        return false;
+    }
+    if (!lane.clients->admit(client)) {
+        client.countThrottled();
+        count(Counter::QUOTA_EXCEEDED);
+        channel.error(rcvid, EAGAIN);
+        return false;
+    }
+    return true;
+}
+
+bool SecureMessageReceiver::handleBuffersExhausted(ServerChannel& channel, int rcvid) {
+    count(Counter::BUFFER_EXHAUSTED);
+    if (buffers_->config().policy == ExhaustionPolicy::DROP) {
+        return true;    // The worker replies as if the message was handled
+    }
+    channel.error(rcvid, EAGAIN);
+    return false;
 }
 
-void SecureMessageReceiver::handleAuthorizedMessage(int rcvid, const Message& msg) {
-    std::cout << "\n--- Authorized Message Received ---\n"
-              << "From: rcvid " << rcvid << " (AUTHORIZED by secpol)\n"
-              << "Type: " << msg.type << "\n"
-              << "Subtype: " << msg.subtype << "\n"
-              << "Data: " << msg.data.data() << "\n"
-              << "-----------------------------------\n\n";
+void SecureMessageReceiver::handlePulse(const Pulse& pulse, const Lane& lane) {
+    // A client sending a private code could run timers and posted work at
+    // will, or drain another client's ring; a stop pulse only gets here
+    // from another process
+    if (isPrivatePulse(pulse.code) && !lane.own->contains(*lane.channel, pulse.scoid)) {
+        count(Counter::SECURITY_VIOLATIONS);
+        IPC_LOG_WARN("Private pulse code {} from scoid {} dropped", pulse.code, pulse.scoid);
+        return;
+    }
+
+    // Telemetry and application pulses are traffic; the rest is plumbing
+    const bool traffic = pulse.code == PULSE_CODE_TELEMETRY ||
+        (pulse.code >= PULSE_CODE_USER_MIN && pulse.code <= PULSE_CODE_USER_MAX);
+    if (traffic) {
+        // Pulses carry no pid; the entry is cached after the first one
+        const auto client = lane.clients->lookup(*lane.channel, pulse.scoid, 0);
+        if (client && !client->authorized()) {
+            client->countDenied();
+            count(Counter::SECURITY_VIOLATIONS);
+            lane.credits->pulseHandled(pulse.scoid);
+            return;
+        }
+        if (client) {
+            client->countPulse();
+        }
+
+        const int32_t value = pulse.value;
+        capture(CaptureKind::PULSE, 0, pulse.scoid,
+                MessageView{static_cast<uint16_t>(pulse.code), 0,
+                            std::string_view(reinterpret_cast<const char*>(&value),
+                                             sizeof(value))});
+    }
+
+    switch (pulse.code) {
+        case PULSE_CODE_RING_DOORBELL:
+            drainRing(static_cast<uint32_t>(pulse.value), pulse.scoid, lane);
+            break;
+
+        case PULSE_CODE_TELEMETRY:
+            pulses_->dispatchTelemetry(static_cast<uint32_t>(pulse.value), pulse.scoid);
+            break;
+
+        case PULSE_CODE_RING_REDRAIN:
+            // Posted by drainRing() itself, so the owner check is already
+            // done; draining early is harmless
+            drainRing(static_cast<uint32_t>(pulse.value), ANY_OWNER, lane);
+            break;
+
+        case PULSE_CODE_TIMER: {
+            // Timers and posted work are what handlers move off the reply
+            // path, so realtime mode does not count their allocations
+            const HotPathExempt off_path;
+            events_->runTimer(pulse.value);
+            break;
+        }
+
+        case PULSE_CODE_RUN_WORK: {
+            // A spurious wake-up finds nothing to run
+            const HotPathExempt off_path;
+            events_->runWork();
+            break;
+        }
+
+        case TRANSPORT_PULSE_UNBLOCK:
+            // A client's send() timed out while its reply was deferred;
+            // one being handled inline is answered shortly anyway
+            if (pending_->cancel(pulse.value, lane, ETIMEDOUT)) {
+                IPC_LOG_DEBUG("Deferred reply to rcvid {} cancelled: sender timed out",
+                              pulse.value);
+            }
+            break;
+
+        case TRANSPORT_PULSE_DISCONNECT: {
+            // Client went away: drop its rings, credits and identity (the
+            // transport releases the connection)
+            rings_->removeClient(pulse.scoid);
+            lane.credits->leave(pulse.scoid);
+            lane.own->forget(pulse.scoid);
+            const auto client = lane.clients->remove(pulse.scoid);
+            if (client) {
+                const ClientStats stats = client->stats();
+                IPC_LOG_INFO("Client {} (pid {}) disconnected: {} messages, {} bytes,"
+                             " {} pulses, {} denied, {} throttled, {} expired",
+                             stats.identity.program, stats.identity.credentials.pid,
+                             stats.messages, stats.bytes, stats.pulses, stats.denied,
+                             stats.throttled, stats.expired);
+            }
+            break;
+        }
 
-    // Send reply
-    constexpr int reply_status = 0;
-    MsgReply(rcvid, reply_status, &reply_status, sizeof(reply_status));
+        default:
+            if (pulse.code >= PULSE_CODE_USER_MIN && pulse.code <= PULSE_CODE_USER_MAX) {
+                pulses_->dispatchUser(pulse.code, pulse.value, pulse.scoid);
+            }
+            // Worker wake-ups and unknown pulses need no action
+            break;
+    }
+
+    // Handled pulses free the sender's pulse credits
+    if (traffic) {
+        lane.credits->pulseHandled(pulse.scoid);
+    }
+}
+
+void SecureMessageReceiver::handleRingSetup(ServerChannel& channel, int rcvid,
+                                            const ReceiveInfo& info,
+                                            const MessageView& msg) {
+    // Connection setup, not the message path
+    const HotPathExempt setup;
+    RingSetupRequest request;
+    if (msg.payload.size() != sizeof(request)) {
+        count(Counter::PROTOCOL_ERRORS);
+        channel.error(rcvid, EBADMSG);
+        return;
+    }
+    std::memcpy(&request, msg.payload.data(), sizeof(request));
+
+    const uint32_t capacity = std::min(request.capacity, MAX_RING_CAPACITY);
+
+    // The handle can only be opened by the requesting process
+    RingSetupReply reply{};
+    auto ring = SharedRingChannel::create(capacity, info.pid, reply.shm_handle);
+    if (!ring) {
+        count(Counter::REPLY_ERRORS);
+        channel.error(rcvid, ENOMEM);
+        return;
+    }
+    reply.capacity = ring->capacity();
+
+    const auto ring_id = rings_->add(std::move(*ring), info.scoid);
+    if (!ring_id) {
+        count(Counter::REPLY_ERRORS);
+        channel.error(rcvid, EAGAIN);
+        return;
+    }
+    reply.ring_id = *ring_id;
+
+    IPC_LOG_INFO("Shared ring {} set up for pid {} ({} bytes)",
+                 reply.ring_id, info.pid, reply.capacity);
+
+    const iovec reply_iov{&reply, sizeof(reply)};
+    channel.reply(rcvid, EOK, &reply_iov, 1);
+}
+
+void SecureMessageReceiver::handleCreditRequest(ServerChannel& channel, int rcvid,
+                                                const ReceiveInfo& info,
+                                                const MessageView& msg, const Lane& lane) {
+    // Once per connection, not the message path
+    const HotPathExempt setup;
+    if (!lane.credits->enabled()) {
+        channel.error(rcvid, ENOSYS);
+        return;
+    }
+    if (!msg.payload.empty()) {
+        count(Counter::PROTOCOL_ERRORS);
+        channel.error(rcvid, EBADMSG);
+        return;
+    }
+
+    const CreditGrant grant = lane.credits->join(info.scoid);
+    IPC_LOG_DEBUG("Credits for pid {} on {}: window {}, {} pulses handled",
+                  info.pid, lane.name, grant.window, grant.pulses_handled);
+
+    const iovec reply{const_cast<CreditGrant*>(&grant), sizeof(grant)};
+    channel.reply(rcvid, EOK, &reply, 1);
+}
+
+void SecureMessageReceiver::handleBatch(ServerChannel& channel, int rcvid,
+                                        const MessageView& envelope,
+                                        const ClientIdentity* client,
+                                        const CreditGrant* grant) {
+    BatchHeader batch;
+    if (envelope.payload.size() < sizeof(batch)) {
+        count(Counter::PROTOCOL_ERRORS);
+        channel.error(rcvid, EBADMSG);
+        return;
+    }
+    std::memcpy(&batch, envelope.payload.data(), sizeof(batch));
+    if (batch.count > MAX_BATCH_RECORDS) {
+        count(Counter::PROTOCOL_ERRORS);
+        channel.error(rcvid, EBADMSG);
+        return;
+    }
+
+    const std::string_view records = envelope.payload.substr(sizeof(batch));
+
+    // Walk every record: calls visit(view) and returns false on bad framing
+    const auto forEachRecord = [&](const auto& visit) {
+        size_t offset = 0;
+        for (uint32_t i = 0; i < batch.count; ++i) {
+            MessageHeader header;
+            if (offset > records.size() || records.size() - offset < sizeof(header)) {
+                return false;
+            }
+            std::memcpy(&header, records.data() + offset, sizeof(header));
+            offset += sizeof(header);
+            if (header.size > records.size() - offset) {
+                return false;
+            }
+            visit(MessageView{header.type, header.subtype,
+                              records.substr(offset, header.size)});
+            offset += header.size;
+            offset += (BATCH_RECORD_ALIGN - offset % BATCH_RECORD_ALIGN) % BATCH_RECORD_ALIGN;
+        }
+        return true;
+    };
+
+    // Validate the framing first so a bad envelope handles nothing
+    if (!forEachRecord([](const MessageView&) {})) {
+        count(Counter::PROTOCOL_ERRORS);
+        channel.error(rcvid, EBADMSG);
+        return;
+    }
+
+    std::array<int32_t, MAX_BATCH_RECORDS> statuses;
+    size_t index = 0;
+    forEachRecord([&](const MessageView& record) {
+        statuses[index++] = (record.type >= MSG_TYPE_CONTROL_BASE)
+            ? EINVAL
+            : dispatchMessage(rcvid, record, client);
+    });
+
+    // A grant for a joined connection follows the statuses
+    BatchReplyHeader reply{batch.count, 0};
+    const iovec iov[3] = {
+        {&reply, sizeof(reply)},
+        {statuses.data(), batch.count * sizeof(int32_t)},
+        {const_cast<CreditGrant*>(grant), sizeof(CreditGrant)}
+    };
+    channel.reply(rcvid, EOK, iov, grant ? 3 : 2);
+}
+
+void SecureMessageReceiver::drainRing(uint32_t ring_id, int scoid, const Lane& lane) {
+    const auto entry = rings_->find(ring_id, scoid);
+    if (!entry) {
+        return;
+    }
+
+    // One drainer at a time keeps the ring single-consumer
+    if (entry->draining.exchange(true, std::memory_order_acquire)) {
+        return;
+    }
+
+    // The ring was set up by an authorized client, so no check per record
+    const auto client = lane.clients->find(entry->scoid);
+    const ClientIdentity* identity = client ? &client->identity() : nullptr;
+    const auto handler = [this, owner = entry->scoid, identity](const MessageView& record) {
+        capture(CaptureKind::RING_RECORD, 0, owner, record);
+        (void)dispatchMessage(0, record, identity);
+    };
+
+    while (true) {
+        entry->ring.setConsumerIdle(false);
+        const size_t drained = entry->ring.drain(RING_DRAIN_BUDGET, handler);
+
+        if (entry->ring.isBroken()) {
+            count(Counter::PROTOCOL_ERRORS);
+            IPC_LOG_WARN("Shared ring {} is corrupt, closing it", ring_id);
+            rings_->remove(ring_id);
+            entry->draining.store(false, std::memory_order_release);
+            return;
+        }
+
+        if (drained == RING_DRAIN_BUDGET && !entry->ring.empty()) {
+            // Still busy: requeue behind other work instead of hogging a worker
+            entry->draining.store(false, std::memory_order_release);
+            lane.self->sendPulse(PULSE_CODE_RING_REDRAIN, static_cast<int>(ring_id));
+            return;
+        }
+
+        // Go idle, then re-check: a producer may have pushed before it saw
+        // the idle flag, in which case nobody else will be woken for it
+        entry->ring.setConsumerIdle(true);
+        entry->draining.store(false, std::memory_order_release);
+        if (entry->ring.empty() ||
+            entry->draining.exchange(true, std::memory_order_acquire)) {
+            return;
+        }
+    }
 }
 
 void SecureMessageReceiver::handleSecurityViolation(int error_code) {
-    std::cout << "\n[SECURITY POLICY VIOLATION]\n"
-              << "===========================\n"
-              << "Unauthorized access blocked by secpol!\n"
-              << "errno: " << error_code << " ("
-              << std::strerror(error_code) << ")\n"
-              << "===========================\n\n";
+    count(Counter::SECURITY_VIOLATIONS);
+    IPC_LOG_WARN("Security policy violation: access blocked by secpol: {} ({})",
+                 std::strerror(error_code), error_code);
 }
 
 bool SecureMessageReceiver::isSecurityError(int error_code) const noexcept {
@@ -0,0 +1,157 @@
+// thread_pool.cpp
+// Dynamic worker pool - Implementation
+#include "thread_pool.h"
+
+#include <iostream>
+#include <system_error>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+
+namespace qnx::ipc {
+
+bool setThreadPriority(int priority) noexcept {
+    int policy;
+    struct sched_param param;
+    if (pthread_getschedparam(pthread_self(), &policy, &param) != 0) {
+        return false;
+    }
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), policy, &param) == 0;
+}
+
+ThreadPool::ThreadPool(const ThreadPoolConfig& config, WorkerFactory factory,
+                       UnblockFunc unblock)
+    : config_(config),
+      factory_(std::move(factory)),
+      unblock_(std::move(unblock)) {
+    // Same sanity rules thread_pool_create() applies to its attributes
+    if (config_.lo_water == 0) {
+        config_.lo_water = 1;
+    }
+    if (config_.increment == 0) {
+        config_.increment = 1;
+    }
+    if (config_.hi_water < config_.lo_water) {
+        config_.hi_water = config_.lo_water;
+    }
+    if (config_.maximum < config_.hi_water) {
+        config_.maximum = config_.hi_water;
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+    wait();
+}
+
+void ThreadPool::start() {
+    stopping_ = false;
+    spawn(config_.lo_water);
+}
+
+void ThreadPool::stop() {
+    stopping_ = true;
+
+    // Workers already inside block() only notice the flag once woken
+    if (unblock_) {
+        for (unsigned n = blocked_.load(); n > 0; --n) {
+            unblock_();
+        }
+    }
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(exit_mutex_);
+    exit_cv_.wait(lock, [this] { return threads_.load() == 0; });
+}
+
+ThreadPoolStats ThreadPool::stats() const noexcept {
+    return ThreadPoolStats{
+        threads_.load(std::memory_order_relaxed),
+        blocked_.load(std::memory_order_relaxed),
+        peak_threads_.load(std::memory_order_relaxed),
+        created_.load(std::memory_order_relaxed)
+    };
+}
+
+void ThreadPool::spawn(unsigned count) {
+    for (unsigned i = 0; i < count; ++i) {
+        // Reserve a slot first so concurrent spawns never exceed maximum
+        unsigned current = threads_.load();
+        do {
+            if (current >= config_.maximum) {
+                return;
+            }
+        } while (!threads_.compare_exchange_weak(current, current + 1));
+
+        unsigned peak = peak_threads_.load();
+        while (peak < current + 1 &&
+               !peak_threads_.compare_exchange_weak(peak, current + 1)) {
+        }
+
+        try {
+            std::thread(&ThreadPool::workerLoop, this).detach();
+            created_.fetch_add(1, std::memory_order_relaxed);
+        } catch (const std::system_error& e) {
+            std::cerr << "Error: Failed to create pool thread: "
+                      << e.what() << "\n";
+            retire();
+            return;
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    if (config_.priority != 0 && !setThreadPriority(config_.priority)) {
+        std::cerr << "Error: Cannot set worker priority " << config_.priority << "\n";
+    }
+
+    std::unique_ptr<PoolWorker> worker = factory_();
+
+    while (worker && !stopping_) {
+        blocked_.fetch_add(1);
+        if (stopping_) {
+            blocked_.fetch_sub(1);
+            break;
+        }
+
+        const bool ok = worker->block();
+        const unsigned still_blocked = blocked_.fetch_sub(1) - 1;
+
+        if (!ok) {
+            stop();
+            break;
+        }
+        if (stopping_) {
+            // What woke us may be real work rather than stop()'s unblock:
+            // finish it so nothing received is left without a reply
+            worker->handle();
+            break;
+        }
+
+        // Keep enough threads waiting to pick up the next request
+        if (still_blocked < config_.lo_water) {
+            spawn(config_.increment);
+        }
+
+        worker->handle();
+
+        // Enough threads are already waiting; shrink the pool
+        if (blocked_.load() >= config_.hi_water) {
+            break;
+        }
+    }
+
+    // The worker must be gone before the pool can observe the exit
+    worker.reset();
+    retire();
+}
+
+void ThreadPool::retire() {
+    std::lock_guard<std::mutex> lock(exit_mutex_);
+    threads_.fetch_sub(1);
+    exit_cv_.notify_all();
+}
+
+} // namespace qnx::ipc
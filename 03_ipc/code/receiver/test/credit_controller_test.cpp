@@ -0,0 +1,75 @@
+// credit_controller_test.cpp
+// CreditController grants under a growing receive queue
+//
+// Usage: bazel test --config=linux-host //03_ipc/code/receiver:credit_controller_test
+#include "credit_controller.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using namespace qnx::ipc;
+
+constexpr unsigned WORKERS = 2;
+constexpr int JOINED_SCOID = 1;
+constexpr int OTHER_SCOID = 2;
+constexpr auto SERVICE_TIME = std::chrono::microseconds(100);
+
+int failures = 0;
+
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+// A deep queue lowers the window granted; draining it restores the window
+void deepQueueShrinksGrant() {
+    FlowControlConfig config{};
+    config.max_window = 64;
+    config.target_delay = std::chrono::microseconds(2000);
+    CreditController controller(config, WORKERS);
+
+    // One completed request sets the service time: 2 workers x 2 ms / 100 us
+    const Admission first = controller.admit(OTHER_SCOID, false);
+    controller.complete(OTHER_SCOID, first, SERVICE_TIME);
+
+    const uint32_t idle_window = controller.join(JOINED_SCOID).window;
+    expect(idle_window == 40, "idle grant is the Little's law budget");
+
+    // 30 requests waiting: 28 of them beyond the workers
+    std::vector<Admission> queued;
+    for (int i = 0; i < 30; ++i) {
+        queued.push_back(controller.admit(OTHER_SCOID, false));
+    }
+    const uint32_t busy_window = controller.grant(JOINED_SCOID).window;
+    expect(busy_window == 12, "queued requests come off the budget");
+    expect(controller.stats().budget == 12, "stats report the reduced budget");
+
+    // A queue deeper than the budget still leaves one credit
+    for (int i = 0; i < 40; ++i) {
+        queued.push_back(controller.admit(OTHER_SCOID, false));
+    }
+    expect(controller.grant(JOINED_SCOID).window == 1, "deepest queue grants one");
+
+    for (const Admission admission : queued) {
+        controller.complete(OTHER_SCOID, admission, SERVICE_TIME);
+    }
+    expect(controller.grant(JOINED_SCOID).window == idle_window,
+           "drained queue restores the window");
+}
+
+} // namespace
+
+int main() {
+    deepQueueShrinksGrant();
+    if (failures > 0) {
+        return EXIT_FAILURE;
+    }
+    std::printf("credit_controller_test: OK\n");
+    return EXIT_SUCCESS;
+}
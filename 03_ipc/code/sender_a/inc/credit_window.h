@@ -0,0 +1,119 @@
+// credit_window.h
+// Flow-control credits granted to one sender connection - Header
+#ifndef CREDIT_WINDOW_H
+#define CREDIT_WINDOW_H
+
+#include "message.h"
+#include "transport.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace qnx::ipc {
+
+/// Least time between MSG_TYPE_CREDIT requests made for pulse credits
+constexpr std::chrono::milliseconds PULSE_REFRESH_INTERVAL{10};
+
+/**
+ * @brief Snapshot of one connection's credits
+ */
+struct CreditState {
+    uint32_t window;            // Requests the receiver allows in flight
+    uint32_t in_flight;         // Requests sent and not yet replied
+    uint32_t pulse_window;      // Pulses allowed ahead of the receiver
+    uint32_t pulses_pending;    // Pulses sent and not yet reported handled
+};
+
+/**
+ * @brief Credits the receiver granted to one connection
+ *
+ * Every request takes a credit before it is sent and gives it back when
+ * the reply arrives, picking up the window carried in that reply, so a
+ * slow receiver shrinks the number of requests its senders queue up.
+ * Pulses are counted against their own window; when it looks used up a
+ * MSG_TYPE_CREDIT request, at most one per PULSE_REFRESH_INTERVAL,
+ * fetches how many the receiver has handled since.
+ *
+ * Shared by the pipeline threads, the batcher and the caller's thread.
+ */
+class CreditWindow {
+public:
+    /**
+     * @brief Join flow control on a connection (sends MSG_TYPE_CREDIT)
+     * @return nullptr with errno set if the request failed; ENOSYS means
+     *         the receiver does not grant credits
+     */
+    static std::unique_ptr<CreditWindow> join(ClientConnection& connection);
+
+    // Prevent copying and moving (threads wait on the window)
+    CreditWindow(const CreditWindow&) = delete;
+    CreditWindow& operator=(const CreditWindow&) = delete;
+
+    /**
+     * @brief Take a credit if one is free
+     * @return false if sending now would exceed the window (would block)
+     */
+    [[nodiscard]] bool tryAcquire();
+
+    /**
+     * @brief Take a credit, waiting for a reply to free one if needed
+     * @return true if it had to wait
+     */
+    bool acquire();
+
+    /**
+     * @brief acquire() that gives up at deadline
+     * @param waited Set to whether it had to wait
+     * @return false if no credit was freed before the deadline
+     */
+    [[nodiscard]] bool acquireUntil(std::chrono::steady_clock::time_point deadline,
+                                    bool& waited);
+
+    /**
+     * @brief Give a request's credit back
+     * @param grant Grant from the reply; window 0 (none sent, or the
+     *              request failed) keeps the current window
+     */
+    void release(const CreditGrant& grant);
+
+    /**
+     * @brief Count one pulse against the pulse window
+     *
+     * When the window looks used up, costs a MSG_TYPE_CREDIT round trip
+     * if none was made in the last PULSE_REFRESH_INTERVAL, and fails at
+     * once otherwise; replies to requests also bring the count up to date.
+     * @return false if the receiver has not caught up (would block)
+     */
+    [[nodiscard]] bool tryAcquirePulse();
+
+    /**
+     * @brief Undo tryAcquirePulse() for a pulse that could not be sent
+     */
+    void cancelPulse();
+
+    [[nodiscard]] CreditState state() const;
+
+private:
+    explicit CreditWindow(ClientConnection& connection) noexcept;
+
+    ClientConnection& connection_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable released_;
+    uint32_t window_;
+    uint32_t in_flight_;
+    uint32_t pulse_window_;
+    uint32_t pulses_sent_;
+    uint32_t pulses_handled_;
+    std::chrono::steady_clock::time_point next_pulse_refresh_{};
+
+    [[nodiscard]] bool refresh();
+    void applyLocked(const CreditGrant& grant) noexcept;
+};
+
+} // namespace qnx::ipc
+
+#endif // CREDIT_WINDOW_H
@@ -3,22 +3,182 @@
 #ifndef MESSAGE_H
 #define MESSAGE_H
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
-#include <array>
+#include <string_view>
 
 namespace qnx::ipc {
 
-constexpr size_t MAX_MESSAGE_SIZE = 256;
+/// Largest payload the receiver accepts
+constexpr size_t MAX_PAYLOAD_SIZE = 8 * 1024 * 1024;
+
+/// Payload bytes received together with the header; the rest is MsgRead()
+constexpr size_t INLINE_PAYLOAD_SIZE = 256;
 
 /**
- * @brief Message structure for inter-process communication
+ * @brief Fixed header sent in front of every message payload
+ *
+ * Types 0x100-0x1FF are reserved for QNX I/O messages (e.g. the
+ * _IO_CONNECT sent by name_open()), which share the first 16 bits.
  */
-struct Message {
+struct MessageHeader {
     uint16_t type;
     uint16_t subtype;
-    std::array<char, MAX_MESSAGE_SIZE> data;
+    uint32_t size;      // Payload bytes following the header
+};
+
+static_assert(sizeof(MessageHeader) == 8, "MessageHeader is a wire format");
+
+/// Control message types, above the range used by applications and QNX
+constexpr uint16_t MSG_TYPE_CONTROL_BASE = 0xF000;
+constexpr uint16_t MSG_TYPE_RING_SETUP = 0xF001;
+constexpr uint16_t MSG_TYPE_BATCH = 0xF002;
+constexpr uint16_t MSG_TYPE_CREDIT = 0xF003;
+constexpr uint16_t MSG_TYPE_DEADLINE = 0xF004;
+constexpr uint16_t MSG_TYPE_SHM_PAYLOAD = 0xF005;
+
+/// Deadline of a message that has none
+constexpr std::chrono::steady_clock::time_point NO_DEADLINE =
+    std::chrono::steady_clock::time_point::max();
+
+/// Records in one MSG_TYPE_BATCH envelope, and their alignment
+constexpr size_t MAX_BATCH_RECORDS = 1024;
+constexpr size_t BATCH_RECORD_ALIGN = 8;
+
+/// Pulse codes (_PULSE_CODE_MINAVAIL..MAXAVAIL); the top codes are receiver-internal
+constexpr int PULSE_CODE_RING_DOORBELL = 1;
+constexpr int PULSE_CODE_TELEMETRY = 2;
+
+/// Pulse codes free for application use (value is passed through as is)
+constexpr int PULSE_CODE_USER_MIN = 16;
+constexpr int PULSE_CODE_USER_MAX = 111;
+
+/**
+ * @brief One-way telemetry sample carried in a pulse's 32-bit value
+ */
+struct TelemetrySample {
+    uint8_t type;
+    uint8_t subtype;
+    uint16_t value;
+};
+
+constexpr uint32_t encodeTelemetry(const TelemetrySample& sample) noexcept {
+    return (uint32_t{sample.type} << 24) | (uint32_t{sample.subtype} << 16) |
+           sample.value;
+}
+
+constexpr TelemetrySample decodeTelemetry(uint32_t value) noexcept {
+    return TelemetrySample{
+        static_cast<uint8_t>(value >> 24),
+        static_cast<uint8_t>(value >> 16),
+        static_cast<uint16_t>(value)
+    };
+}
+
+/**
+ * @brief MSG_TYPE_RING_SETUP payload: ask for a shared-memory ring
+ */
+struct RingSetupRequest {
+    uint32_t capacity;  // Requested data bytes (rounded to a power of two)
+};
+
+/**
+ * @brief MSG_TYPE_RING_SETUP reply
+ */
+struct RingSetupReply {
+    uint64_t shm_handle; // shm_open_handle() handle, valid for this client only
+    uint32_t capacity;   // Granted data bytes
+    uint32_t ring_id;    // Value to send with PULSE_CODE_RING_DOORBELL
+};
+
+/**
+ * @brief Start of a MSG_TYPE_BATCH payload
+ *
+ * Followed by `count` records, each a MessageHeader plus payload padded
+ * to BATCH_RECORD_ALIGN bytes.
+ */
+struct BatchHeader {
+    uint32_t count;
+    uint32_t reserved;
+};
 
-    Message() : type(0), subtype(0), data{} {}
+/**
+ * @brief Start of a MSG_TYPE_DEADLINE payload
+ *
+ * Followed by the message it bounds: its MessageHeader and payload.
+ * budget_us is the time the sender had left when it sent; sent_ns is
+ * its steady_clock (CLOCK_MONOTONIC) time then, so a receiver on the
+ * same node also counts the time the message spent queued. A request
+ * already past its deadline when received is answered with ETIMEDOUT
+ * and not handled.
+ */
+struct DeadlineHeader {
+    uint64_t sent_ns;
+    uint32_t budget_us;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(DeadlineHeader) == 16, "DeadlineHeader is a wire format");
+
+/**
+ * @brief MSG_TYPE_SHM_PAYLOAD payload: a message whose payload is in a
+ *        shared-memory segment of the sender's
+ *
+ * The first message in a segment carries SHM_SEGMENT_NEW and a handle
+ * only the receiver's process can open, read-only; the receiver keeps it
+ * mapped and later messages name it by segment alone. The payload is the
+ * first size bytes of the segment, and the sender does not touch them
+ * until the reply. May be wrapped in MSG_TYPE_DEADLINE.
+ */
+struct ShmPayloadHeader {
+    uint64_t shm_handle;    // shm_open_handle() handle, with SHM_SEGMENT_NEW
+    uint32_t segment;       // Sender's id of the segment
+    uint32_t flags;         // SHM_SEGMENT_*
+    uint64_t capacity;      // Segment bytes
+    uint16_t type;          // The message carried
+    uint16_t subtype;
+    uint32_t size;          // Its payload bytes, at the start of the segment
+};
+
+static_assert(sizeof(ShmPayloadHeader) == 32, "ShmPayloadHeader is a wire format");
+
+/// ShmPayloadHeader::flags
+constexpr uint32_t SHM_SEGMENT_NEW = 1;         // Map shm_handle as this segment
+constexpr uint32_t SHM_SEGMENT_RELEASE = 2;     // Unmap the segment after handling
+
+/**
+ * @brief MSG_TYPE_BATCH reply, followed by one int32_t status per record
+ */
+struct BatchReplyHeader {
+    uint32_t count;
+    uint32_t reserved;
+};
+
+/**
+ * @brief Flow-control credits granted to one connection
+ *
+ * A MSG_TYPE_CREDIT request (empty payload) joins flow control and is
+ * answered with a CreditGrant. From then on every reply to an application
+ * message or MSG_TYPE_BATCH on that connection carries an up-to-date grant
+ * after its status words; senders that have not joined never see one.
+ */
+struct CreditGrant {
+    uint32_t window;            // Requests the connection may have unreplied
+    uint32_t pulse_window;      // Pulses it may have sent but not had handled
+    uint32_t pulses_handled;    // Its telemetry/application pulses handled (wraps)
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CreditGrant) == 16, "CreditGrant is a wire format");
+
+/**
+ * @brief Non-owning view of a message: header fields plus payload bytes
+ */
+struct MessageView {
+    uint16_t type;
+    uint16_t subtype;
+    std::string_view payload;
 };
 
 } // namespace qnx::ipc
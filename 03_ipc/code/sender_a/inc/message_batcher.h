@@ -0,0 +1,102 @@
+// message_batcher.h
+// Packs many small messages into MSG_TYPE_BATCH envelopes - Header
+#ifndef MESSAGE_BATCHER_H
+#define MESSAGE_BATCHER_H
+
+#include "credit_window.h"
+#include "message.h"
+#include "send_pipeline.h"
+#include "transport.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qnx::ipc {
+
+/**
+ * @brief When a batch is sent: whichever limit is reached first
+ */
+struct BatchLimits {
+    size_t max_records;
+    size_t max_bytes;                   // Envelope payload bytes
+    std::chrono::microseconds linger;   // Age of the oldest queued record
+};
+
+/**
+ * @brief Accumulates messages and sends them as one MsgSend()/MsgReply()
+ *
+ * Each record keeps its own reply callback, fed from the per-record
+ * status array in the receiver's aggregated reply. Batches are sent by
+ * the thread whose add() fills one, or by the linger thread when the
+ * oldest record has waited long enough. Callbacks run with the batcher
+ * locked and must not call back into it.
+ *
+ * With a CreditWindow each envelope takes one credit, waited for with
+ * the batcher locked, so add() blocks while the receiver withholds them.
+ */
+class MessageBatcher {
+public:
+    /**
+     * @brief Construct a new Message Batcher
+     * @param connection Connection to the receiver (must outlive the batcher)
+     * @param limits Flush thresholds
+     * @param metrics Where records are counted, or nullptr
+     * @param credits Flow-control credits for the connection, or nullptr
+     *                (must outlive the batcher)
+     */
+    MessageBatcher(ClientConnection& connection, const BatchLimits& limits,
+                   std::shared_ptr<IpcMetrics> metrics = nullptr,
+                   CreditWindow* credits = nullptr);
+
+    // Prevent copying and moving (the linger thread references the batcher)
+    MessageBatcher(const MessageBatcher&) = delete;
+    MessageBatcher& operator=(const MessageBatcher&) = delete;
+
+    /**
+     * @brief Send whatever is still queued, then stop the linger thread
+     */
+    ~MessageBatcher();
+
+    /**
+     * @brief Queue one record (payload is copied)
+     * @param msg Message to queue; type must be below MSG_TYPE_CONTROL_BASE
+     * @param on_reply Called with the record's status or the send error
+     */
+    void add(const MessageView& msg, ReplyCallback on_reply = {});
+
+    /**
+     * @brief Send the current batch now
+     */
+    void flush();
+
+    [[nodiscard]] const BatchLimits& limits() const noexcept { return limits_; }
+
+private:
+    ClientConnection& connection_;
+    BatchLimits limits_;
+    std::shared_ptr<IpcMetrics> metrics_;
+    CreditWindow* credits_;
+
+    std::mutex mutex_;
+    std::condition_variable linger_cv_;
+    std::vector<char> buffer_;               // BatchHeader + records
+    std::vector<ReplyCallback> callbacks_;
+    std::vector<int32_t> statuses_;
+    std::chrono::steady_clock::time_point oldest_;
+    bool stopping_;
+
+    std::thread linger_thread_;
+
+    void lingerLoop();
+    void flushLocked();
+    void fail(int error);
+};
+
+} // namespace qnx::ipc
+
+#endif // MESSAGE_BATCHER_H
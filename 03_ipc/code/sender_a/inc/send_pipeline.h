@@ -0,0 +1,191 @@
+// send_pipeline.h
+// Pipelined asynchronous sending over one connection - Header
+#ifndef SEND_PIPELINE_H
+#define SEND_PIPELINE_H
+
+#include "credit_window.h"
+#include "ipc_metrics.h"
+#include "message.h"
+#include "transport.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Outcome of one asynchronous send
+ */
+struct SendResult {
+    int status;     // Receiver's reply status (valid when error == 0)
+    int error;      // errno of a failed MsgSend, 0 on success
+
+    [[nodiscard]] bool ok() const noexcept { return error == 0; }
+};
+
+using ReplyCallback = std::function<void(const SendResult&)>;
+
+/**
+ * @brief Caller-owned buffer a request's reply payload is received into
+ *
+ * The kernel copies the payload from the receiver's buffers straight
+ * into data; nothing is copied on the way.
+ */
+struct ReplyBuffer {
+    char* data;
+    size_t capacity;
+    size_t size;        // Set to the payload size the receiver replied with;
+                        // above capacity only the first capacity bytes came
+};
+
+/**
+ * @brief Count one replied message and its send-to-reply time
+ */
+void recordReply(IpcMetrics& metrics, const MessageHeader& header, int status,
+                 std::chrono::steady_clock::duration elapsed) noexcept;
+
+/**
+ * @brief Send one request and wait for its reply
+ *
+ * With credits, takes a credit first (unless credited: already taken)
+ * and hands it back with the reply's grant. A request with a deadline
+ * goes out wrapped in MSG_TYPE_DEADLINE carrying the time left, and
+ * both the credit wait and the send give up at the deadline.
+ * @param metrics Where the outcome is counted, or nullptr
+ * @param reply Where the reply payload goes, or nullptr to drop it
+ * @return The reply status, or the send's errno (ETIMEDOUT: deadline
+ *         passed here or on arrival at the receiver)
+ */
+[[nodiscard]] SendResult exchangeMessage(
+    ClientConnection& connection, const MessageHeader& header, std::string_view payload,
+    CreditWindow* credits, bool credited, IpcMetrics* metrics,
+    std::chrono::steady_clock::time_point deadline = NO_DEADLINE,
+    ReplyBuffer* reply = nullptr);
+
+/**
+ * @brief Keeps up to `window` requests in flight on one connection
+ *
+ * MsgSend() blocks the calling thread until the reply, so each slot of
+ * the window is a sender thread. Requests tagged with a stream id always
+ * go to the same thread and are therefore sent and replied in order;
+ * untagged requests are taken by whichever thread is free.
+ *
+ * With a CreditWindow, each request also needs a flow-control credit:
+ * a sender thread waits for one before sending, so when the receiver
+ * shrinks the window the queue fills and submit() blocks. trySubmit()
+ * refuses instead.
+ *
+ * A request's deadline covers its time in the queue, the credit wait
+ * and the send; one that expires on the way is answered with ETIMEDOUT.
+ *
+ * Queued payloads are copied into a fixed set of slots, one per queued
+ * or in-flight request (queue_limit + window). A slot keeps its storage
+ * between requests, so once warm, submitting allocates nothing; slots
+ * grown past SLOT_KEEP_BYTES give the memory back after the send.
+ */
+class SendPipeline {
+public:
+    /**
+     * @brief Construct a new Send Pipeline
+     * @param connection Connection to the receiver (must outlive the pipeline)
+     * @param window Number of requests in flight at once
+     * @param queue_limit Queued requests before submit() blocks
+     * @param metrics Where sends are counted, or nullptr
+     * @param credits Flow-control credits for the connection, or nullptr
+     *                (must outlive the pipeline)
+     */
+    SendPipeline(ClientConnection& connection, size_t window, size_t queue_limit,
+                 std::shared_ptr<IpcMetrics> metrics = nullptr,
+                 CreditWindow* credits = nullptr);
+
+    // Prevent copying and moving (sender threads reference the pipeline)
+    SendPipeline(const SendPipeline&) = delete;
+    SendPipeline& operator=(const SendPipeline&) = delete;
+
+    /**
+     * @brief Send everything still queued, then stop the sender threads
+     */
+    ~SendPipeline();
+
+    /**
+     * @brief Queue a message; on_reply runs on a sender thread
+     * @param msg Message to send (payload is copied)
+     * @param on_reply Called with the reply or the send error
+     * @param stream Requests with the same stream id stay in order
+     * @param deadline When to give up waiting for the reply
+     */
+    void submit(const MessageView& msg, ReplyCallback on_reply,
+                std::optional<uint32_t> stream = std::nullopt,
+                std::chrono::steady_clock::time_point deadline = NO_DEADLINE);
+
+    /**
+     * @brief Queue a message only if it can go out without waiting
+     * @return false (would block) if the queue is full or no credit is
+     *         free; on_reply is not called then
+     */
+    [[nodiscard]] bool trySubmit(const MessageView& msg, ReplyCallback on_reply,
+                                 std::optional<uint32_t> stream = std::nullopt,
+                                 std::chrono::steady_clock::time_point deadline =
+                                     NO_DEADLINE);
+
+    /**
+     * @brief Block until every submitted request has been replied to
+     */
+    void flush();
+
+    [[nodiscard]] size_t window() const noexcept { return lanes_.size(); }
+    [[nodiscard]] const ClientConnection& connection() const noexcept { return connection_; }
+    [[nodiscard]] const CreditWindow* credits() const noexcept { return credits_; }
+
+private:
+    /// Payload storage a slot keeps between requests
+    static constexpr size_t SLOT_KEEP_BYTES = 64 * 1024;
+
+    struct Request {
+        MessageHeader header;
+        size_t slot;            // Index into slots_ holding the payload
+        ReplyCallback on_reply;
+        bool credited;          // Credit already taken by trySubmit()
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    ClientConnection& connection_;
+    size_t queue_limit_;
+    std::shared_ptr<IpcMetrics> metrics_;
+    CreditWindow* credits_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable space_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Request> shared_;
+    std::vector<std::deque<Request>> lanes_;
+    std::vector<std::vector<char>> slots_;
+    std::vector<size_t> free_slots_;
+    size_t queued_;             // Includes requests still being copied in
+    size_t outstanding_;
+    bool stopping_;
+
+    std::vector<std::thread> threads_;
+
+    [[nodiscard]] size_t reserveLocked();
+    void enqueue(size_t slot, const MessageView& msg, ReplyCallback on_reply,
+                 bool credited, std::optional<uint32_t> stream,
+                 std::chrono::steady_clock::time_point deadline);
+    void notifyWork(std::optional<uint32_t> stream);
+    void senderLoop(size_t lane);
+    [[nodiscard]] SendResult transmit(const Request& request) const;
+};
+
+} // namespace qnx::ipc
+
+#endif // SEND_PIPELINE_H
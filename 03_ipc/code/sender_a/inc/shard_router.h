@@ -0,0 +1,105 @@
+// shard_router.h
+// Consistent-hash routing over receiver shards - Header
+#ifndef SHARD_ROUTER_H
+#define SHARD_ROUTER_H
+
+#include "transport.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Routing key for everything of one type/subtype
+ */
+constexpr uint64_t routingKey(uint16_t type, uint16_t subtype) noexcept {
+    return (static_cast<uint64_t>(type) << 16) | subtype;
+}
+
+/**
+ * @brief Connections to receiver shards <base>.0 .. <base>.N-1, picked by key
+ *
+ * Each live shard owns VIRTUAL_NODES points on a hash ring and a key goes
+ * to the shard owning the first point at or after the key's hash. When a
+ * shard disappears only its own keys move (spread over the others), and
+ * they move back when it reappears; every other key keeps its shard.
+ *
+ * Shards that are not there are looked for again at most once per rescan
+ * interval, by the first route() call after it has passed. route() and
+ * markDown() may be called from any number of threads.
+ */
+class ShardRouter {
+public:
+    static constexpr uint32_t VIRTUAL_NODES = 64;
+
+    /**
+     * @brief Construct a router; no connection is opened until discover()
+     * @param base_name Receiver name the shard index is appended to
+     * @param shard_count Number of shard names to look for
+     * @param rescan Minimum time between looks for missing shards
+     */
+    ShardRouter(std::string_view base_name, uint32_t shard_count,
+                std::chrono::milliseconds rescan);
+
+    // Prevent copying and moving (senders hold routed connections)
+    ShardRouter(const ShardRouter&) = delete;
+    ShardRouter& operator=(const ShardRouter&) = delete;
+
+    /**
+     * @brief Open every shard that is not connected yet
+     * @return Number of live shards
+     */
+    size_t discover();
+
+    /**
+     * @brief Connection to the shard that owns a key
+     * @param key Routing key
+     * @param shard Receives the shard index
+     * @return nullptr if no shard is live
+     */
+    [[nodiscard]] std::shared_ptr<ClientConnection> route(uint64_t key, uint32_t& shard);
+
+    /**
+     * @brief Take a shard off the ring after its connection failed
+     * @param shard Shard index from route()
+     * @param connection Connection that failed; ignored if the shard has
+     *                   been reopened since
+     */
+    void markDown(uint32_t shard, const ClientConnection& connection);
+
+    [[nodiscard]] size_t liveShards() const;
+    [[nodiscard]] uint32_t shardCount() const noexcept {
+        return static_cast<uint32_t>(shards_.size());
+    }
+
+private:
+    struct Point {
+        uint64_t hash;
+        uint32_t shard;
+    };
+
+    std::string base_name_;
+    std::chrono::milliseconds rescan_;
+
+    mutable std::shared_mutex mutex_;
+    std::vector<std::shared_ptr<ClientConnection>> shards_;    // nullptr = down
+    std::vector<Point> ring_;                                   // Sorted by hash
+
+    std::mutex discover_mutex_;             // Held while looking for shards
+    std::atomic<int64_t> next_rescan_ns_;
+
+    size_t discoverLocked();
+    void rebuildLocked();
+};
+
+} // namespace qnx::ipc
+
+#endif // SHARD_ROUTER_H
@@ -0,0 +1,121 @@
+// coro_sender.cpp
+// co_await-able sends over a MessageSender's pipeline (C++20) - Implementation
+#include "coro_sender.h"
+
+#include <cerrno>
+
+namespace qnx::ipc {
+
+namespace {
+    // How often parked sends are retried when none of ours is in flight
+    constexpr auto RESUBMIT_RETRY = std::chrono::microseconds(200);
+}
+
+size_t CoroSender::inFlight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+size_t CoroSender::parked() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return parked_.size();
+}
+
+bool CoroSender::start(SendAwaiter& awaiter) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!parked_.empty()) {
+            parked_.push_back(&awaiter);    // Stay behind earlier sends
+            return true;
+        }
+
+        const int error = trySubmitLocked(awaiter);
+        if (error == EOK) {
+            return true;
+        }
+        if (error != EWOULDBLOCK) {
+            awaiter.result_ = SendResult{0, error};
+            return false;                   // Resume at once with the error
+        }
+        parked_.push_back(&awaiter);        // A reply will resubmit it...
+        if (!needsRetryLocked()) {
+            return true;
+        }
+    }
+
+    // ...unless the pipeline is full of other traffic and none of ours
+    // will reply: this may be a loop thread, so retry on a timer instead
+    // of waiting for room here
+    scheduleRetry();
+    return true;
+}
+
+int CoroSender::trySubmitLocked(SendAwaiter& awaiter) {
+    const int error = sender_.trySendAsync(
+        awaiter.msg_,
+        [this, &awaiter](const SendResult& result) { replied(awaiter, result); },
+        awaiter.stream_);
+    if (error == EOK) {
+        ++in_flight_;
+    }
+    return error;
+}
+
+bool CoroSender::needsRetryLocked() noexcept {
+    if (in_flight_ > 0 || retrying_) {
+        return false;
+    }
+    retrying_ = true;
+    return true;
+}
+
+void CoroSender::scheduleRetry() {
+    loop_.spawn([](CoroSender& self) -> Task<void> {
+        co_await self.loop_.sleepFor(RESUBMIT_RETRY);
+        {
+            std::lock_guard<std::mutex> lock(self.mutex_);
+            self.retrying_ = false;
+        }
+        self.resubmit();
+    }(*this));
+}
+
+// Runs on a pipeline thread; the awaiter is gone once its handle is posted
+void CoroSender::replied(SendAwaiter& awaiter, const SendResult& result) {
+    awaiter.result_ = result;
+    const std::coroutine_handle<> handle = awaiter.handle_;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --in_flight_;
+    }
+    resubmit();
+    loop_.post(handle);
+}
+
+void CoroSender::resubmit() {
+    bool retry = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!parked_.empty()) {
+            SendAwaiter& next = *parked_.front();
+            const int error = trySubmitLocked(next);
+            if (error == EWOULDBLOCK) {
+                // Nothing left to wake it: neither a pipeline thread (it may
+                // be the one that frees room) nor a loop thread may wait here
+                retry = needsRetryLocked();
+                break;
+            }
+            parked_.pop_front();
+            if (error != EOK) {
+                next.result_ = SendResult{0, error};
+                loop_.post(next.handle_);
+            }
+        }
+    }
+
+    if (retry) {
+        scheduleRetry();
+    }
+}
+
+} // namespace qnx::ipc
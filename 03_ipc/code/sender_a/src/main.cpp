@@ -1,10 +1,16 @@
 // main.cpp
 // Entry point for Sender A (Authorized Sender)
 #include "message_sender.h"
+#include "binary_log.h"
+#include "realtime.h"
 
 #include <iostream>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <chrono>
+#include <optional>
+#include <unistd.h>
 
 namespace {
     constexpr const char* SENDER_ID = "SENDER1";
@@ -17,26 +23,67 @@ namespace {
     constexpr uint16_t MESSAGE_SUBTYPE = 100;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     using namespace qnx::ipc;
 
+    // -R policy[:priority][@cpu]: realtime mode, as for the receiver
+    // -t deadline_us: give up on each message after this long
+    RealtimeConfig realtime{};
+    std::chrono::microseconds deadline{0};
+    int opt;
+    while ((opt = getopt(argc, argv, "R:t:")) != -1) {
+        std::optional<RealtimeConfig> spec;
+        if (opt == 'R') {
+            spec = parseRealtimeSpec(optarg);
+        } else if (opt == 't') {
+            deadline = std::chrono::microseconds(std::strtoul(optarg, nullptr, 0));
+            continue;
+        }
+        if (!spec) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [-R policy[:priority][@cpu]] [-t deadline_us]\n";
+            return EXIT_FAILURE;
+        }
+        realtime = *spec;
+    }
+    if (realtime.enabled) {
+        if (!lockMemory()) {
+            std::cerr << "Error: Cannot lock memory for realtime mode: "
+                      << std::strerror(errno) << "\n";
+            return EXIT_FAILURE;
+        }
+        BinaryLog::attachThread();
+        if (!enterRealtimeThread(realtime)) {
+            IPC_LOG_WARN("Not fully realtime: {}", std::strerror(errno));
+        }
+    }
+
     MessageSender sender(SENDER_ID, RECEIVER_NAME);
 
     if (!sender.connect()) {
         return EXIT_FAILURE;
     }
+    if (realtime.enabled) {
+        armHotPathWatch();
+    }
 
     const SendConfig config{
         .message_count = MESSAGE_COUNT,
         .interval = INTERVAL,
         .type = MESSAGE_TYPE,
-        .subtype = MESSAGE_SUBTYPE
+        .subtype = MESSAGE_SUBTYPE,
+        .deadline = deadline
     };
 
     const int sent_count = sender.sendMessages(config);
 
-    std::cout << "Sender 1 completed (" << sent_count << "/"
-              << MESSAGE_COUNT << " messages sent successfully)\n";
+    IPC_LOG_INFO("Sender 1 completed ({}/{} messages sent successfully)",
+                 sent_count, MESSAGE_COUNT);
+    if (realtime.enabled) {
+        const HotPathStats hot_path = hotPathStats();
+        IPC_LOG_INFO("Realtime: {} heap allocations on the send path ({} bytes)",
+                     hot_path.allocations, hot_path.bytes);
+    }
 
     return (sent_count == MESSAGE_COUNT) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
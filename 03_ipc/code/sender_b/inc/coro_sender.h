@@ -0,0 +1,121 @@
+// coro_sender.h
+// co_await-able sends over a MessageSender's pipeline (C++20) - Header
+#ifndef CORO_SENDER_H
+#define CORO_SENDER_H
+
+#include "event_loop.h"
+#include "message.h"
+#include "message_sender.h"
+#include "send_pipeline.h"
+#include "task.h"
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace qnx::ipc {
+
+/**
+ * @brief Sends from coroutines: co_await sender.send(msg) yields the reply
+ *
+ * MsgSend() blocks its thread until the reply, so the sends themselves
+ * are made by the MessageSender's SendPipeline threads (startPipeline()
+ * sets how many are in flight at once). A coroutine awaiting a reply is
+ * only its frame; when the reply arrives it is resumed on the EventLoop.
+ * Thousands of conversations can therefore wait on a handful of loop
+ * threads plus `window` pipeline threads, instead of a thread each.
+ *
+ * When the pipeline queue (or the flow-control window) is full, the
+ * awaiting coroutine is parked here, not blocked, and resubmitted in
+ * order as replies free room. If none of its sends are in flight to
+ * bring a reply (the pipeline is full of other traffic), a loop timer
+ * retries the parked sends instead; no loop or pipeline thread waits.
+ *
+ * @code
+ * sender.startPipeline(16);
+ * CoroSender coro(sender, loop);
+ * loop.spawn([&]() -> Task<void> {
+ *     const SendResult result = co_await coro.send(msg);
+ * }());
+ * @endcode
+ */
+class CoroSender {
+public:
+    /**
+     * @param sender Connected sender with a running pipeline (must outlive this)
+     * @param loop Where awaiting coroutines are resumed (must outlive this)
+     */
+    CoroSender(MessageSender& sender, EventLoop& loop) noexcept
+        : sender_(sender), loop_(loop) {}
+
+    // Prevent copying and moving (pending sends reference this object)
+    CoroSender(const CoroSender&) = delete;
+    CoroSender& operator=(const CoroSender&) = delete;
+
+    class SendAwaiter {
+    public:
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            return sender_.start(*this);
+        }
+        SendResult await_resume() const noexcept { return result_; }
+
+    private:
+        friend class CoroSender;
+
+        SendAwaiter(CoroSender& sender, const MessageView& msg,
+                    std::optional<uint32_t> stream) noexcept
+            : sender_(sender), msg_(msg), stream_(stream) {}
+
+        CoroSender& sender_;
+        MessageView msg_;               // Caller's payload, valid while suspended
+        std::optional<uint32_t> stream_;
+        std::coroutine_handle<> handle_;
+        SendResult result_{0, 0};
+    };
+
+    /**
+     * @brief Send a message and suspend until its reply
+     *
+     * co_await yields the SendResult: the receiver's status, or the send
+     * error (ENOTCONN if the pipeline is not running, EMSGSIZE).
+     * @param stream Messages with the same stream id are kept in order
+     */
+    [[nodiscard]] SendAwaiter send(const MessageView& msg,
+                                   std::optional<uint32_t> stream = std::nullopt) noexcept {
+        return SendAwaiter(*this, msg, stream);
+    }
+
+    /**
+     * @brief Sends submitted to the pipeline and not replied to yet
+     */
+    [[nodiscard]] size_t inFlight() const;
+
+    /**
+     * @brief Sends parked until the pipeline has room
+     */
+    [[nodiscard]] size_t parked() const;
+
+private:
+    MessageSender& sender_;
+    EventLoop& loop_;
+
+    mutable std::mutex mutex_;
+    std::deque<SendAwaiter*> parked_;   // mutex_, oldest first
+    size_t in_flight_ = 0;              // mutex_
+    bool retrying_ = false;             // mutex_; a retry timer is pending
+
+    [[nodiscard]] bool start(SendAwaiter& awaiter);
+    [[nodiscard]] int trySubmitLocked(SendAwaiter& awaiter);
+    void replied(SendAwaiter& awaiter, const SendResult& result);
+    void resubmit();
+    [[nodiscard]] bool needsRetryLocked() noexcept;
+    void scheduleRetry();
+};
+
+} // namespace qnx::ipc
+
+#endif // CORO_SENDER_H
@@ -3,49 +3,57 @@
 #ifndef MESSAGE_SENDER_H
 #define MESSAGE_SENDER_H
 
+#include "credit_window.h"
+#include "ipc_metrics.h"
+#include "message_batcher.h"
+#include "send_pipeline.h"
+#include "shard_router.h"
+#include "shared_ring_channel.h"
+#include "shm_segment.h"
+#include "transport.h"
+
 #include <string>
 #include <string_view>
+#include <map>
 #include <optional>
 #include <chrono>
+#include <future>
+#include <memory>
 
 namespace qnx::ipc {
 
 // Forward declaration
-struct Message;
+struct MessageView;
 
 /**
  * @brief Configuration for message sending
  */
 struct SendConfig {
     int message_count;
-    std::chrono::seconds interval;
+    std::chrono::nanoseconds interval;
     uint16_t type;
     uint16_t subtype;
+    size_t window = 1;      // Pipelined mode: requests in flight at once
+    uint32_t streams = 0;   // Pipelined mode: 0 = unordered, N = message i
+                            // joins stream i % N and stays in order within it
+    size_t batch_records = 32;          // Batch mode: records per envelope
+    size_t batch_bytes = 16 * 1024;     // Batch mode: envelope payload bytes
+    std::chrono::microseconds linger{1000}; // Batch mode: max record wait
+    std::string_view lane{};            // Receiver lane suffix ("hi", "lo");
+                                        // empty = the main channel
+    std::chrono::microseconds deadline{0};  // Per message, from its send (or
+                                            // submission); 0 = none. Not
+                                            // used in batch mode
 };
 
 /**
- * @brief RAII wrapper for QNX connection ID
- *
- * Automatically closes the connection when destroyed
+ * @brief One-way (pulse) send counters since the sender was created
  */
-class ConnectionGuard {
-public:
-    explicit ConnectionGuard(int coid) noexcept;
-    ~ConnectionGuard() noexcept;
-
-    // Prevent copying
-    ConnectionGuard(const ConnectionGuard&) = delete;
-    ConnectionGuard& operator=(const ConnectionGuard&) = delete;
-
-    // Allow moving
-    ConnectionGuard(ConnectionGuard&& other) noexcept;
-    ConnectionGuard& operator=(ConnectionGuard&& other) noexcept;
-
-    [[nodiscard]] int get() const noexcept { return coid_; }
-    [[nodiscard]] bool isValid() const noexcept { return coid_ != -1; }
-
-private:
-    int coid_;
+struct PulseSendStats {
+    uint64_t sent;
+    uint64_t overflowed;    // EAGAIN: the kernel could not queue the pulse
+    uint64_t failed;        // Any other MsgSendPulse error
+    uint64_t throttled;     // Not sent: no pulse credit (flow control)
 };
 
 /**
@@ -56,6 +64,27 @@ private:
  * - std::string_view for efficient string passing
  * - std::chrono for time management
  * - RAII for connection management
+ *
+ * Connections come from the transport library: QNX message passing on
+ * the target, its Unix-socket equivalent on a Linux host.
+ *
+ * Once connected, counters and send-to-reply latency are published in an
+ * IpcMetrics region named after the sender id (read it with ipc_stats).
+ *
+ * After enableFlowControl() every request on every connection (main
+ * channel and lanes) needs a credit from the receiver: blocking calls
+ * wait for one, trySendAsync() reports EWOULDBLOCK, and pulses beyond
+ * the receiver's pulse window are not sent.
+ *
+ * Requests may carry a deadline: the credit wait, the send-blocked and
+ * the reply-blocked time all end there with ETIMEDOUT (counted as
+ * send_timeouts), and the receiver drops a request that arrives too late
+ * instead of handling it. Batches, shard routing and CoroSender send
+ * without deadlines.
+ *
+ * connectShards() spreads sendRouted() traffic over receiver shards
+ * <receiver_name>.0 .. N-1 by key (see ShardRouter); the other calls keep
+ * using the connection opened by connect().
  */
 class MessageSender {
 public:
@@ -92,6 +121,266 @@ public:
      */
     int sendMessages(const SendConfig& config);
 
+    /**
+     * @brief Send messages with up to config.window requests in flight
+     *
+     * Unlike sendMessages(), the next message does not wait for the
+     * previous reply; config.interval only paces submissions.
+     * @param config Message sending configuration
+     * @return Number of successfully sent messages
+     */
+    int sendMessagesPipelined(const SendConfig& config);
+
+    /**
+     * @brief Send messages packed into MSG_TYPE_BATCH envelopes
+     *
+     * An envelope goes out when it holds config.batch_records records or
+     * config.batch_bytes bytes, or its oldest record is config.linger old.
+     * @param config Message sending configuration
+     * @return Number of records the receiver accepted (status 0)
+     */
+    int sendMessagesBatched(const SendConfig& config);
+
+    /**
+     * @brief Join the receiver's credit-based flow control
+     *
+     * Call after connect() and before startPipeline()/startBatching();
+     * lanes opened later join too.
+     * @return false if the receiver grants no credits (flow control is
+     *         then off and sending works as before)
+     */
+    bool enableFlowControl();
+
+    /**
+     * @brief Credits of the connection to a lane
+     * @return std::nullopt if that connection is not flow controlled
+     */
+    [[nodiscard]] std::optional<CreditState> creditState(std::string_view lane = {}) const;
+
+    /**
+     * @brief Start (or reconfigure) the batcher used by sendBatched()
+     * @param lane Receiver lane suffix; empty for the main channel
+     * @return true if connected and batching is active
+     */
+    bool startBatching(const BatchLimits& limits, std::string_view lane = {});
+
+    /**
+     * @brief Queue a message into the current batch
+     * @param msg Message to queue (payload is copied)
+     * @param on_reply Called with the record's own status from the reply
+     * @return false if batching was not started
+     */
+    bool sendBatched(const MessageView& msg, ReplyCallback on_reply = {});
+
+    /**
+     * @brief Send the current batch without waiting for a limit
+     */
+    void flushBatch();
+
+    /**
+     * @brief Start (or resize) the pipeline used by sendAsync()
+     * @param window Number of requests in flight at once
+     * @param lane Receiver lane suffix; empty for the main channel
+     * @return true if connected and the pipeline is running
+     */
+    bool startPipeline(size_t window, std::string_view lane = {});
+
+    /**
+     * @brief Queue a message without waiting for the reply
+     * @param msg Message to send (payload is copied)
+     * @param stream Messages with the same stream id are kept in order
+     * @param deadline When to give up (ETIMEDOUT), queueing included
+     * @return Future that becomes ready with the reply or send error
+     */
+    std::future<SendResult> sendAsync(const MessageView& msg,
+                                      std::optional<uint32_t> stream = std::nullopt,
+                                      std::chrono::steady_clock::time_point deadline =
+                                          NO_DEADLINE);
+
+    /**
+     * @brief Queue a message; on_reply runs on a pipeline thread
+     * @return false (on_reply not called, errno set) if the pipeline is
+     *         not running (ENOTCONN) or the payload is too large (EMSGSIZE)
+     */
+    bool sendAsync(const MessageView& msg, ReplyCallback on_reply,
+                   std::optional<uint32_t> stream = std::nullopt,
+                   std::chrono::steady_clock::time_point deadline = NO_DEADLINE);
+
+    /**
+     * @brief Queue a message only if it can go out without waiting
+     *
+     * Never blocks: under flow control a message needs a free credit,
+     * otherwise free queue space.
+     * @return EOK if queued (on_reply runs on a pipeline thread);
+     *         EWOULDBLOCK if it would wait for a reply first, ENOTCONN if
+     *         the pipeline is not running or EMSGSIZE (on_reply not called)
+     */
+    [[nodiscard]] int trySendAsync(const MessageView& msg, ReplyCallback on_reply,
+                                   std::optional<uint32_t> stream = std::nullopt,
+                                   std::chrono::steady_clock::time_point deadline =
+                                       NO_DEADLINE);
+
+    /**
+     * @brief Block until every message queued with sendAsync() is replied to
+     */
+    void flushPipeline();
+
+    /**
+     * @brief Send one message and wait for the reply
+     *
+     * Header and payload go out as two iovecs, so only the payload bytes
+     * are copied (no fixed-size buffer, up to MAX_PAYLOAD_SIZE).
+     * @param msg Message type, subtype and payload
+     * @param reply_status Receives the reply status
+     * @param deadline When to give up waiting; errno is then ETIMEDOUT
+     * @return true if the message was delivered and replied to
+     */
+    bool sendMessage(const MessageView& msg, int& reply_status,
+                     std::chrono::steady_clock::time_point deadline = NO_DEADLINE);
+
+    /**
+     * @brief Send one request and receive its reply payload into buffer
+     *
+     * The receiver gathers the payload from its own buffers and the
+     * kernel copies it once, straight into buffer; the result is a view
+     * of it there, valid for as long as buffer is.
+     * @param buffer Caller's buffer for the reply payload
+     * @param capacity Its size in bytes
+     * @param reply_status Receives the reply status
+     * @param deadline When to give up waiting; errno is then ETIMEDOUT
+     * @return The reply payload within buffer, or std::nullopt with errno
+     *         set; EMSGSIZE if it was larger than capacity (buffer then
+     *         holds its first capacity bytes)
+     */
+    std::optional<std::string_view> request(const MessageView& msg, char* buffer,
+                                            size_t capacity, int& reply_status,
+                                            std::chrono::steady_clock::time_point deadline =
+                                                NO_DEADLINE);
+
+    /**
+     * @brief A shared-memory segment of at least size bytes to fill with
+     *        a payload for sendShared()
+     *
+     * Segments come from a pool made for the receiver's process, so most
+     * calls reuse one it already has mapped. The payload must not outlive
+     * the connection.
+     * @return An empty payload with errno set on failure
+     */
+    [[nodiscard]] ShmPayload allocateShared(size_t size);
+
+    /**
+     * @brief Send a message whose payload is the first size bytes of a
+     *        segment from allocateShared(), and wait for the reply
+     *
+     * Only a ShmPayloadHeader goes through the kernel; the receiver reads
+     * the payload in place, up to SHM_SEGMENT_MAX_SIZE. Once replied to
+     * the segment goes back to the pool.
+     * @param reply_status Receives the reply status
+     * @param deadline When to give up waiting; errno is then ETIMEDOUT
+     * @return true if the message was delivered and replied to
+     */
+    bool sendShared(uint16_t type, uint16_t subtype, ShmPayload payload, size_t size,
+                    int& reply_status,
+                    std::chrono::steady_clock::time_point deadline = NO_DEADLINE);
+
+    /**
+     * @brief Segments kept for reuse (default DEFAULT_POOLED_SEGMENTS);
+     *        0 sends every payload in a segment of its own
+     *
+     * Call before allocateShared() or with no payload outstanding.
+     */
+    void setSharedSegments(size_t max_pooled);
+
+    /**
+     * @brief Counters of the segments behind allocateShared()
+     */
+    [[nodiscard]] ShmPoolStats sharedStats() const;
+
+    /**
+     * @brief Open the receiver shards <receiver_name>.0 .. shard_count-1
+     *
+     * Shards that are not running yet are looked for again every rescan
+     * interval, so they may be started in any order and at any time.
+     * @param rescan Minimum time between looks for missing shards
+     * @return true if at least one shard is running
+     */
+    bool connectShards(uint32_t shard_count,
+                       std::chrono::milliseconds rescan = std::chrono::milliseconds(1000));
+
+    /**
+     * @brief Send one message to the shard that owns key and wait for the reply
+     *
+     * Messages with the same key go to the same shard for as long as it
+     * is running. A shard whose connection fails is dropped and its keys
+     * move to the others; the failed message is not resent, as the shard
+     * may have handled it. Safe to call from several threads at once.
+     * Shard connections do not take part in flow control.
+     * @param msg Message type, subtype and payload
+     * @param key Routing key, e.g. a device or session id
+     * @param reply_status Receives the reply status
+     * @return true if the message was delivered and replied to
+     */
+    bool sendRouted(const MessageView& msg, uint64_t key, int& reply_status);
+
+    /**
+     * @brief Send one message routed by its type/subtype
+     */
+    bool sendRouted(const MessageView& msg, int& reply_status);
+
+    /**
+     * @brief Number of shards currently on the routing ring
+     */
+    [[nodiscard]] size_t liveShards() const;
+
+    /**
+     * @brief Set up a shared-memory ring to the receiver for streaming
+     *
+     * The setup request goes over the (secpol-checked) connection; the
+     * receiver replies with a shm handle only this process can open.
+     * @param capacity Requested ring size in bytes
+     * @return true if the ring is mapped and ready
+     */
+    bool openSharedRing(uint32_t capacity = DEFAULT_RING_CAPACITY);
+
+    /**
+     * @brief Queue a message on the shared ring without blocking
+     *
+     * No reply is returned. A doorbell pulse is sent only when the
+     * receiver has gone idle.
+     * @param msg Message to queue (payload up to the ring's maxPayload())
+     * @return false if no ring is open or it is full (retry later)
+     */
+    bool streamMessage(const MessageView& msg);
+
+    /**
+     * @brief Send a telemetry sample as a pulse; never waits for a reply
+     *
+     * The receiver routes it by sample.type to a registered handler.
+     * Pulses the kernel cannot queue, or that exceed the pulse credits
+     * under flow control, are dropped and counted, so callers at sensor
+     * rate never wait for a slow receiver (beyond one MSG_TYPE_CREDIT
+     * round trip per PULSE_REFRESH_INTERVAL while the credits look used
+     * up; in between, pulses over the window are dropped at once).
+     * @param sample Type, subtype and 16-bit value
+     * @return true if the pulse was queued
+     */
+    bool sendTelemetry(const TelemetrySample& sample);
+
+    /**
+     * @brief Send an application pulse; never waits for a reply
+     * @param code Pulse code in PULSE_CODE_USER_MIN..PULSE_CODE_USER_MAX
+     * @param value Passed to the receiver's handler unchanged
+     * @return true if the pulse was queued
+     */
+    bool sendPulse(int code, int value);
+
+    /**
+     * @brief Counters for sendTelemetry() and sendPulse()
+     */
+    [[nodiscard]] const PulseSendStats& pulseStats() const noexcept {
+        return pulse_stats_;
+    }
+
     /**
      * @brief Check if sender is connected
      * @return true if connected
@@ -101,11 +390,34 @@ public:
 private:
     std::string sender_id_;
     std::string receiver_name_;
-    std::optional<ConnectionGuard> connection_;
+    std::unique_ptr<ClientConnection> connection_;
+    std::map<std::string, std::unique_ptr<ClientConnection>, std::less<>> lanes_;
+    std::optional<SharedRingChannel> ring_;
+    std::shared_ptr<IpcMetrics> metrics_;
+    // Before the pipeline and batcher, which use the windows until destroyed
+    std::map<const ClientConnection*, std::unique_ptr<CreditWindow>> credits_;
+    std::unique_ptr<SendPipeline> pipeline_;
+    std::unique_ptr<MessageBatcher> batcher_;
+    std::unique_ptr<ShardRouter> shards_;
+    std::unique_ptr<ShmSegmentPool> shm_pool_;  // Made for connection_'s receiver
+    size_t shm_segments_;
+    bool flow_control_;
+    uint32_t ring_id_;
+    bool doorbell_pending_;
+    PulseSendStats pulse_stats_;
 
     void displayStartupInfo() const;
-    [[nodiscard]] std::optional<int> attemptConnection();
-    [[nodiscard]] bool sendSingleMessage(const Message& msg, int& reply_status);
+    [[nodiscard]] std::unique_ptr<ClientConnection> attemptConnection();
+    [[nodiscard]] ClientConnection* laneConnection(std::string_view lane);
+    [[nodiscard]] CreditWindow* creditsFor(const ClientConnection& connection) const;
+    bool joinFlowControl(ClientConnection& connection);
+    [[nodiscard]] bool sendSingleMessage(ClientConnection& connection, const MessageView& msg,
+                                         int& reply_status,
+                                         std::chrono::steady_clock::time_point deadline =
+                                             NO_DEADLINE,
+                                         ReplyBuffer* reply = nullptr);
+    [[nodiscard]] bool ringDoorbell();
+    [[nodiscard]] bool sendOneWay(int code, int value);
 };
 
 } // namespace qnx::ipc
@@ -0,0 +1,134 @@
+// credit_window.cpp
+// Flow-control credits for one sender connection - Implementation
+#include "credit_window.h"
+
+namespace qnx::ipc {
+
+namespace {
+    bool requestCredits(ClientConnection& connection, CreditGrant& grant) {
+        const MessageHeader header{MSG_TYPE_CREDIT, 0, 0};
+        const iovec iov{const_cast<MessageHeader*>(&header), sizeof(header)};
+        const iovec reply_iov{&grant, sizeof(grant)};
+        return connection.send(&iov, 1, &reply_iov, 1) != -1;
+    }
+}
+
+std::unique_ptr<CreditWindow> CreditWindow::join(ClientConnection& connection) {
+    std::unique_ptr<CreditWindow> credits(new CreditWindow(connection));
+    if (!credits->refresh()) {
+        return nullptr;
+    }
+    return credits;
+}
+
+CreditWindow::CreditWindow(ClientConnection& connection) noexcept
+    : connection_(connection),
+      window_(1),
+      in_flight_(0),
+      pulse_window_(0),
+      pulses_sent_(0),
+      pulses_handled_(0) {}
+
+bool CreditWindow::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (in_flight_ >= window_) {
+        return false;
+    }
+    ++in_flight_;
+    return true;
+}
+
+bool CreditWindow::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const bool waited = in_flight_ >= window_;
+    released_.wait(lock, [this] { return in_flight_ < window_; });
+    ++in_flight_;
+    return waited;
+}
+
+bool CreditWindow::acquireUntil(std::chrono::steady_clock::time_point deadline,
+                                bool& waited) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    waited = in_flight_ >= window_;
+    if (!released_.wait_until(lock, deadline, [this] { return in_flight_ < window_; })) {
+        return false;
+    }
+    ++in_flight_;
+    return true;
+}
+
+void CreditWindow::release(const CreditGrant& grant) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --in_flight_;
+        applyLocked(grant);
+    }
+    released_.notify_all();
+}
+
+bool CreditWindow::tryAcquirePulse() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pulses_sent_ - pulses_handled_ < pulse_window_) {
+            ++pulses_sent_;
+            return true;
+        }
+
+        // Replies may not have come for a while: ask how far the receiver
+        // is, but not once per pulse of a receiver that is falling behind
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next_pulse_refresh_) {
+            return false;
+        }
+        next_pulse_refresh_ = now + PULSE_REFRESH_INTERVAL;
+    }
+
+    if (!refresh()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pulses_sent_ - pulses_handled_ < pulse_window_) {
+        ++pulses_sent_;
+        return true;
+    }
+    return false;
+}
+
+void CreditWindow::cancelPulse() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --pulses_sent_;
+}
+
+CreditState CreditWindow::state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return CreditState{window_, in_flight_, pulse_window_, pulses_sent_ - pulses_handled_};
+}
+
+bool CreditWindow::refresh() {
+    CreditGrant grant{};
+    if (!requestCredits(connection_, grant)) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        applyLocked(grant);
+    }
+    released_.notify_all();
+    return true;
+}
+
+void CreditWindow::applyLocked(const CreditGrant& grant) noexcept {
+    if (grant.window == 0) {
+        return;
+    }
+    window_ = grant.window;
+    pulse_window_ = grant.pulse_window;
+
+    // Replies on different threads can arrive out of order; the handled
+    // count only moves forward (modulo 2^32)
+    if (static_cast<int32_t>(grant.pulses_handled - pulses_handled_) > 0) {
+        pulses_handled_ = grant.pulses_handled;
+    }
+}
+
+} // namespace qnx::ipc
@@ -0,0 +1,184 @@
+// message_batcher.cpp
+// Batched message envelopes - Implementation
+#include "message_batcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace qnx::ipc {
+
+namespace {
+    size_t paddedRecordSize(size_t payload) noexcept {
+        const size_t bytes = sizeof(MessageHeader) + payload;
+        return (bytes + BATCH_RECORD_ALIGN - 1) / BATCH_RECORD_ALIGN * BATCH_RECORD_ALIGN;
+    }
+}
+
+MessageBatcher::MessageBatcher(ClientConnection& connection, const BatchLimits& limits,
+                               std::shared_ptr<IpcMetrics> metrics, CreditWindow* credits)
+    : connection_(connection),
+      limits_(limits),
+      metrics_(std::move(metrics)),
+      credits_(credits),
+      stopping_(false) {
+    limits_.max_records = std::clamp<size_t>(limits_.max_records, 1, MAX_BATCH_RECORDS);
+    limits_.max_bytes = std::clamp<size_t>(limits_.max_bytes, sizeof(BatchHeader),
+                                           MAX_PAYLOAD_SIZE);
+
+    buffer_.reserve(limits_.max_bytes);
+    buffer_.resize(sizeof(BatchHeader));
+    callbacks_.reserve(limits_.max_records);
+    statuses_.resize(limits_.max_records);
+
+    linger_thread_ = std::thread(&MessageBatcher::lingerLoop, this);
+}
+
+MessageBatcher::~MessageBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushLocked();
+        stopping_ = true;
+    }
+    linger_cv_.notify_one();
+    linger_thread_.join();
+}
+
+void MessageBatcher::add(const MessageView& msg, ReplyCallback on_reply) {
+    const size_t record = paddedRecordSize(msg.payload.size());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Make room first; an oversized record still travels, in its own batch
+    if (!callbacks_.empty() && buffer_.size() + record > limits_.max_bytes) {
+        flushLocked();
+    }
+    if (sizeof(BatchHeader) + record > MAX_PAYLOAD_SIZE) {
+        if (on_reply) {
+            on_reply(SendResult{0, EMSGSIZE});
+        }
+        return;
+    }
+
+    const MessageHeader header{msg.type, msg.subtype,
+                               static_cast<uint32_t>(msg.payload.size())};
+    const size_t offset = buffer_.size();
+    buffer_.resize(offset + record);
+    std::memcpy(buffer_.data() + offset, &header, sizeof(header));
+    std::memcpy(buffer_.data() + offset + sizeof(header), msg.payload.data(),
+                msg.payload.size());
+
+    callbacks_.push_back(std::move(on_reply));
+    if (metrics_) {
+        metrics_->add(Counter::PAYLOAD_BYTES, msg.payload.size());
+        metrics_->countMessage(msg.type, msg.subtype);
+    }
+    if (callbacks_.size() == 1) {
+        oldest_ = std::chrono::steady_clock::now();
+        linger_cv_.notify_one();
+    }
+
+    if (callbacks_.size() >= limits_.max_records ||
+        buffer_.size() >= limits_.max_bytes) {
+        flushLocked();
+    }
+}
+
+void MessageBatcher::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushLocked();
+}
+
+void MessageBatcher::lingerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stopping_) {
+        if (callbacks_.empty()) {
+            linger_cv_.wait(lock);
+            continue;
+        }
+
+        const auto deadline = oldest_ + limits_.linger;
+        if (linger_cv_.wait_until(lock, deadline) == std::cv_status::timeout &&
+            !callbacks_.empty() &&
+            std::chrono::steady_clock::now() >= oldest_ + limits_.linger) {
+            flushLocked();
+        }
+    }
+}
+
+void MessageBatcher::flushLocked() {
+    const size_t count = callbacks_.size();
+    if (count == 0) {
+        return;
+    }
+
+    const BatchHeader batch{static_cast<uint32_t>(count), 0};
+    std::memcpy(buffer_.data(), &batch, sizeof(batch));
+
+    const MessageHeader header{MSG_TYPE_BATCH, 0,
+                               static_cast<uint32_t>(buffer_.size())};
+    const iovec send_iov[2] = {
+        {const_cast<MessageHeader*>(&header), sizeof(header)},
+        {buffer_.data(), buffer_.size()}
+    };
+
+    // A flow-controlled connection's reply carries a grant after the statuses
+    BatchReplyHeader reply{};
+    CreditGrant grant{};
+    const iovec reply_iov[3] = {
+        {&reply, sizeof(reply)},
+        {statuses_.data(), count * sizeof(int32_t)},
+        {&grant, sizeof(grant)}
+    };
+
+    if (credits_ && credits_->acquire() && metrics_) {
+        metrics_->add(Counter::CREDIT_WAITS);
+    }
+
+    const auto sent = std::chrono::steady_clock::now();
+    const int result = connection_.send(send_iov, 2, reply_iov, credits_ ? 3 : 2);
+    const int error = errno;
+    if (credits_) {
+        credits_->release(grant);
+    }
+
+    if (result == -1) {
+        fail(error);
+    } else if (reply.count != count) {
+        fail(EBADMSG);
+    } else {
+        size_t rejected = 0;
+        for (size_t i = 0; i < count; ++i) {
+            rejected += (statuses_[i] != EOK);
+            if (callbacks_[i]) {
+                callbacks_[i](SendResult{statuses_[i], 0});
+            }
+        }
+
+        // One latency sample per envelope: its records share the round trip
+        if (metrics_) {
+            metrics_->add(Counter::MESSAGES, count);
+            metrics_->add(Counter::REPLY_ERRORS, rejected);
+            metrics_->recordLatency(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - sent).count()));
+        }
+    }
+
+    buffer_.resize(sizeof(BatchHeader));
+    callbacks_.clear();
+}
+
+void MessageBatcher::fail(int error) {
+    if (metrics_) {
+        metrics_->add(Counter::SEND_ERRORS);
+    }
+    for (auto& callback : callbacks_) {
+        if (callback) {
+            callback(SendResult{0, error});
+        }
+    }
+}
+
+} // namespace qnx::ipc
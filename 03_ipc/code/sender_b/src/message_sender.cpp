@@ -2,41 +2,39 @@
 // Message Sender - Implementation
 #include "message_sender.h"
 #include "message.h"
+#include "message_schema.h"
+#include "binary_log.h"
+#include "realtime.h"
 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <cerrno>
 #include <unistd.h>
 #include <thread>
-#include <sys/neutrino.h>
-#include <sys/dispatch.h>
 
 namespace qnx::ipc {
 
-// ConnectionGuard implementation
-ConnectionGuard::ConnectionGuard(int coid) noexcept
-    : coid_(coid) {}
-
-ConnectionGuard::~ConnectionGuard() noexcept {
-    if (coid_ != -1) {
-        name_close(coid_);
+namespace {
+    // Demo payload, written straight into the send buffer
+    void fillGreeting(Greeting& greeting, std::string_view sender_id, int sequence) noexcept {
+        greeting.sent_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        greeting.sequence = static_cast<uint32_t>(sequence);
+        greeting.pid = static_cast<int32_t>(getpid());
+        std::memcpy(greeting.sender_id, sender_id.data(),
+                    std::min(sender_id.size(), sizeof(greeting.sender_id)));
     }
-}
-
-ConnectionGuard::ConnectionGuard(ConnectionGuard&& other) noexcept
-    : coid_(other.coid_) {
-    other.coid_ = -1;
-}
 
-ConnectionGuard& ConnectionGuard::operator=(ConnectionGuard&& other) noexcept {
-    if (this != &other) {
-        if (coid_ != -1) {
-            name_close(coid_);
+    std::chrono::steady_clock::time_point deadlineFrom(const SendConfig& config) noexcept {
+        if (config.deadline.count() <= 0) {
+            return NO_DEADLINE;
         }
-        coid_ = other.coid_;
-        other.coid_ = -1;
+        return std::chrono::steady_clock::now() + config.deadline;
     }
-    return *this;
 }
 
 // MessageSender implementation
@@ -44,24 +42,38 @@ MessageSender::MessageSender(std::string_view sender_id,
                              std::string_view receiver_name)
     : sender_id_(sender_id),
       receiver_name_(receiver_name),
-      connection_(std::nullopt) {}
+      connection_(nullptr),
+      ring_(std::nullopt),
+      metrics_(nullptr),
+      pipeline_(nullptr),
+      batcher_(nullptr),
+      shards_(nullptr),
+      shm_pool_(nullptr),
+      shm_segments_(DEFAULT_POOLED_SEGMENTS),
+      flow_control_(false),
+      ring_id_(0),
+      doorbell_pending_(false),
+      pulse_stats_{} {}
 
 bool MessageSender::connect(int max_attempts,
                             std::chrono::seconds retry_delay) {
     displayStartupInfo();
 
     for (int attempt = 0; attempt < max_attempts; ++attempt) {
-        if (auto coid = attemptConnection(); coid.has_value()) {
-            connection_ = ConnectionGuard(*coid);
-            std::cout << "Connected successfully (coid: "
-                      << connection_->get() << ")\n";
-            std::cout << "===========================================\n\n";
+        if (auto connection = attemptConnection()) {
+            shm_pool_.reset();      // Its segments were granted to the old receiver
+            connection_ = std::move(connection);
+            if (!metrics_) {
+                metrics_ = IpcMetrics::create(sender_id_);
+            }
+            IPC_LOG_INFO("Connected successfully (coid: {}, transport: {})\n"
+                         "===========================================\n",
+                         connection_->id(), transportName());
             return true;
         }
 
         if (attempt < max_attempts - 1) {
-            std::cout << "Connection attempt " << (attempt + 1)
-                      << " failed, retrying...\n";
+            IPC_LOG_INFO("Connection attempt {} failed, retrying...", attempt + 1);
             std::this_thread::sleep_for(retry_delay);
         }
     }
@@ -78,69 +90,632 @@ int MessageSender::sendMessages(const SendConfig& config) {
         return 0;
     }
 
+    ClientConnection* const connection = laneConnection(config.lane);
+    if (connection == nullptr) {
+        return 0;
+    }
+
     int successful_sends = 0;
 
     for (int i = 1; i <= config.message_count; ++i) {
-        Message msg{};
-        msg.type = config.type;
-        msg.subtype = config.subtype;
-
-        std::snprintf(msg.data.data(), msg.data.size(),
-                     "Hello from %s - Message #%d",
-                     sender_id_.c_str(), i);
+        SchemaMessage<Greeting> greeting(config.type, config.subtype);
+        fillGreeting(greeting.body, sender_id_, i);
+        const MessageView msg = greeting.view();
 
-        std::cout << "[" << sender_id_ << "] Sending message #"
-                  << i << ": " << msg.data.data() << "\n";
+        IPC_LOG_DEBUG("[{}] Sending greeting #{}", sender_id_, i);
 
         int reply_status;
-        if (sendSingleMessage(msg, reply_status)) {
-            std::cout << "[" << sender_id_ << "] Reply received: "
-                      << reply_status << "\n\n";
+        if (sendSingleMessage(*connection, msg, reply_status, deadlineFrom(config))) {
+            IPC_LOG_DEBUG("[{}] Reply received: {}", sender_id_, reply_status);
             ++successful_sends;
-        } else {
-            break;
+        } else if (errno != ETIMEDOUT) {
+            break;      // A missed deadline only costs that message
+        }
+
+        if (i < config.message_count) {
+            std::this_thread::sleep_for(config.interval);
+        }
+    }
+
+    return successful_sends;
+}
+
+int MessageSender::sendMessagesPipelined(const SendConfig& config) {
+    if (!startPipeline(config.window, config.lane)) {
+        return 0;
+    }
+
+    std::atomic<int> successful_sends{0};
+
+    for (int i = 1; i <= config.message_count; ++i) {
+        SchemaMessage<Greeting> greeting(config.type, config.subtype);
+        fillGreeting(greeting.body, sender_id_, i);
+        const MessageView msg = greeting.view();
+
+        IPC_LOG_DEBUG("[{}] Queueing greeting #{}", sender_id_, i);
+
+        std::optional<uint32_t> stream;
+        if (config.streams > 0) {
+            stream = static_cast<uint32_t>(i) % config.streams;
         }
 
+        pipeline_->submit(msg, [this, i, &successful_sends](const SendResult& result) {
+            if (result.ok()) {
+                IPC_LOG_DEBUG("[{}] Reply received for #{}: {}", sender_id_, i, result.status);
+                ++successful_sends;
+            } else {
+                IPC_LOG_ERROR("Error: MsgSend failed for #{}: {}", i,
+                              std::strerror(result.error));
+            }
+        }, stream, deadlineFrom(config));
+
         if (i < config.message_count) {
             std::this_thread::sleep_for(config.interval);
         }
     }
 
+    pipeline_->flush();
     return successful_sends;
 }
 
+int MessageSender::sendMessagesBatched(const SendConfig& config) {
+    if (!startBatching(BatchLimits{config.batch_records, config.batch_bytes,
+                                   config.linger},
+                       config.lane)) {
+        return 0;
+    }
+
+    // Callbacks run inside the batcher, serialised by its lock
+    int accepted = 0;
+
+    for (int i = 1; i <= config.message_count; ++i) {
+        SchemaMessage<Greeting> greeting(config.type, config.subtype);
+        fillGreeting(greeting.body, sender_id_, i);
+        const MessageView msg = greeting.view();
+
+        batcher_->add(msg, [&accepted](const SendResult& result) {
+            if (result.ok() && result.status == EOK) {
+                ++accepted;
+            }
+        });
+
+        if (i < config.message_count) {
+            std::this_thread::sleep_for(config.interval);
+        }
+    }
+
+    batcher_->flush();
+
+    IPC_LOG_INFO("[{}] Batched send: {}/{} records accepted", sender_id_, accepted,
+                 config.message_count);
+    return accepted;
+}
+
+bool MessageSender::enableFlowControl() {
+    if (!isConnected()) {
+        std::cerr << "Error: Not connected to receiver\n";
+        return false;
+    }
+    if (!joinFlowControl(*connection_)) {
+        return false;
+    }
+
+    flow_control_ = true;
+    for (auto& [name, lane] : lanes_) {
+        (void)joinFlowControl(*lane);
+    }
+    return true;
+}
+
+std::optional<CreditState> MessageSender::creditState(std::string_view lane) const {
+    const ClientConnection* connection = connection_.get();
+    if (!lane.empty()) {
+        const auto it = lanes_.find(lane);
+        connection = (it != lanes_.end()) ? it->second.get() : nullptr;
+    }
+    if (connection == nullptr) {
+        return std::nullopt;
+    }
+
+    const CreditWindow* const credits = creditsFor(*connection);
+    if (credits == nullptr) {
+        return std::nullopt;
+    }
+    return credits->state();
+}
+
+bool MessageSender::startBatching(const BatchLimits& limits, std::string_view lane) {
+    ClientConnection* const connection = laneConnection(lane);
+    if (connection == nullptr) {
+        return false;
+    }
+
+    // Replacing a batcher first sends whatever it still holds
+    batcher_.reset();
+    batcher_ = std::make_unique<MessageBatcher>(*connection, limits, metrics_,
+                                                creditsFor(*connection));
+    return true;
+}
+
+bool MessageSender::sendBatched(const MessageView& msg, ReplyCallback on_reply) {
+    if (!batcher_ || !isConnected()) {
+        return false;
+    }
+    batcher_->add(msg, std::move(on_reply));
+    return true;
+}
+
+void MessageSender::flushBatch() {
+    if (batcher_) {
+        batcher_->flush();
+    }
+}
+
+bool MessageSender::startPipeline(size_t window, std::string_view lane) {
+    ClientConnection* const connection = laneConnection(lane);
+    if (connection == nullptr) {
+        return false;
+    }
+
+    CreditWindow* const credits = creditsFor(*connection);
+    if (!pipeline_ || pipeline_->window() != window || &pipeline_->connection() != connection ||
+        pipeline_->credits() != credits) {
+        // Replacing a pipeline first sends everything it still has queued
+        pipeline_.reset();
+        pipeline_ = std::make_unique<SendPipeline>(*connection, window, window * 4, metrics_,
+                                                   credits);
+    }
+    return true;
+}
+
+std::future<SendResult> MessageSender::sendAsync(const MessageView& msg,
+                                                 std::optional<uint32_t> stream,
+                                                 std::chrono::steady_clock::time_point deadline) {
+    auto promise = std::make_shared<std::promise<SendResult>>();
+    auto future = promise->get_future();
+
+    const bool queued = sendAsync(msg, [promise](const SendResult& result) {
+        promise->set_value(result);
+    }, stream, deadline);
+
+    if (!queued) {
+        promise->set_value(SendResult{0, errno});
+    }
+    return future;
+}
+
+bool MessageSender::sendAsync(const MessageView& msg, ReplyCallback on_reply,
+                              std::optional<uint32_t> stream,
+                              std::chrono::steady_clock::time_point deadline) {
+    if (!pipeline_ || !isConnected()) {
+        errno = ENOTCONN;
+        return false;
+    }
+    if (msg.payload.size() > MAX_PAYLOAD_SIZE) {
+        errno = EMSGSIZE;
+        return false;
+    }
+
+    pipeline_->submit(msg, std::move(on_reply), stream, deadline);
+    return true;
+}
+
+int MessageSender::trySendAsync(const MessageView& msg, ReplyCallback on_reply,
+                                std::optional<uint32_t> stream,
+                                std::chrono::steady_clock::time_point deadline) {
+    if (!pipeline_ || !isConnected()) {
+        return ENOTCONN;
+    }
+    if (msg.payload.size() > MAX_PAYLOAD_SIZE) {
+        return EMSGSIZE;
+    }
+
+    if (!pipeline_->trySubmit(msg, std::move(on_reply), stream, deadline)) {
+        if (metrics_) {
+            metrics_->add(Counter::CREDIT_REFUSED);
+        }
+        return EWOULDBLOCK;
+    }
+    return EOK;
+}
+
+void MessageSender::flushPipeline() {
+    if (pipeline_) {
+        pipeline_->flush();
+    }
+}
+
+bool MessageSender::sendMessage(const MessageView& msg, int& reply_status,
+                                std::chrono::steady_clock::time_point deadline) {
+    if (msg.payload.size() > MAX_PAYLOAD_SIZE) {
+        std::cerr << "Error: Payload too large (" << msg.payload.size()
+                  << " > " << MAX_PAYLOAD_SIZE << " bytes)\n";
+        return false;
+    }
+    return isConnected() && sendSingleMessage(*connection_, msg, reply_status, deadline);
+}
+
+std::optional<std::string_view> MessageSender::request(
+    const MessageView& msg, char* buffer, size_t capacity, int& reply_status,
+    std::chrono::steady_clock::time_point deadline) {
+    if (msg.payload.size() > MAX_PAYLOAD_SIZE) {
+        std::cerr << "Error: Payload too large (" << msg.payload.size()
+                  << " > " << MAX_PAYLOAD_SIZE << " bytes)\n";
+        errno = EMSGSIZE;
+        return std::nullopt;
+    }
+    if (!isConnected()) {
+        errno = ENOTCONN;
+        return std::nullopt;
+    }
+
+    ReplyBuffer reply{buffer, capacity, 0};
+    if (!sendSingleMessage(*connection_, msg, reply_status, deadline, &reply)) {
+        return std::nullopt;
+    }
+    if (reply.size > capacity) {
+        errno = EMSGSIZE;
+        return std::nullopt;
+    }
+    return std::string_view(buffer, reply.size);
+}
+
+ShmPayload MessageSender::allocateShared(size_t size) {
+    if (!isConnected()) {
+        errno = ENOTCONN;
+        return ShmPayload();
+    }
+    if (!shm_pool_) {
+        const pid_t receiver_pid = connection_->serverPid();
+        if (receiver_pid == -1) {
+            std::cerr << "Error: Cannot get receiver pid: " << std::strerror(errno) << "\n";
+            return ShmPayload();
+        }
+        shm_pool_ = std::make_unique<ShmSegmentPool>(receiver_pid, shm_segments_);
+    }
+    return shm_pool_->acquire(size);
+}
+
+bool MessageSender::sendShared(uint16_t type, uint16_t subtype, ShmPayload payload,
+                               size_t size, int& reply_status,
+                               std::chrono::steady_clock::time_point deadline) {
+    if (!payload || size > payload.capacity() || !shm_pool_) {
+        errno = EINVAL;
+        return false;
+    }
+    if (!isConnected()) {
+        errno = ENOTCONN;
+        return false;
+    }
+
+    const ShmPayloadHeader header = shm_pool_->describe(payload, type, subtype, size);
+    const MessageView msg{
+        MSG_TYPE_SHM_PAYLOAD,
+        0,
+        std::string_view(reinterpret_cast<const char*>(&header), sizeof(header))
+    };
+    const bool sent = sendSingleMessage(*connection_, msg, reply_status, deadline);
+    const int error = errno;
+    if (sent && metrics_) {
+        metrics_->add(Counter::SHM_PAYLOADS);
+        if ((header.flags & SHM_SEGMENT_NEW) != 0) {
+            metrics_->add(Counter::SHM_SEGMENTS);
+        }
+    }
+
+    // Reused only once the receiver has it mapped and is done with it
+    shm_pool_->release(std::move(payload), sent && reply_status == EOK);
+    errno = error;
+    return sent;
+}
+
+void MessageSender::setSharedSegments(size_t max_pooled) {
+    shm_segments_ = max_pooled;
+    shm_pool_.reset();
+}
+
+ShmPoolStats MessageSender::sharedStats() const {
+    return shm_pool_ ? shm_pool_->stats() : ShmPoolStats{0, 0, 0, 0};
+}
+
+bool MessageSender::connectShards(uint32_t shard_count, std::chrono::milliseconds rescan) {
+    if (shard_count == 0) {
+        std::cerr << "Error: No receiver shards to connect to\n";
+        return false;
+    }
+
+    shards_ = std::make_unique<ShardRouter>(receiver_name_, shard_count, rescan);
+    if (!metrics_) {
+        metrics_ = IpcMetrics::create(sender_id_);
+    }
+
+    const size_t live = shards_->discover();
+    if (live == 0) {
+        std::cerr << "Error: None of the " << shard_count << " shards of "
+                  << receiver_name_ << " is running\n";
+        return false;
+    }
+    IPC_LOG_INFO("[{}] Routing over {} of {} shards of {}", sender_id_, live, shard_count,
+                 receiver_name_);
+    return true;
+}
+
+bool MessageSender::sendRouted(const MessageView& msg, uint64_t key, int& reply_status) {
+    if (!shards_) {
+        std::cerr << "Error: Not connected to receiver shards\n";
+        return false;
+    }
+    if (msg.payload.size() > MAX_PAYLOAD_SIZE) {
+        if (metrics_) {
+            metrics_->add(Counter::SEND_ERRORS);
+        }
+        IPC_LOG_WARN("[{}] Payload too large ({} > {} bytes)", sender_id_,
+                     msg.payload.size(), MAX_PAYLOAD_SIZE);
+        errno = EMSGSIZE;
+        return false;
+    }
+
+    uint32_t shard = 0;
+    const std::shared_ptr<ClientConnection> connection = shards_->route(key, shard);
+    if (!connection) {
+        if (metrics_) {
+            metrics_->add(Counter::SEND_ERRORS);
+        }
+        IPC_LOG_WARN("[{}] No shard of {} is running", sender_id_, receiver_name_);
+        errno = ESRCH;
+        return false;
+    }
+
+    if (!sendSingleMessage(*connection, msg, reply_status)) {
+        // ESRCH: the shard went away (EBADF: its connection is no longer valid)
+        if (errno == ESRCH || errno == EBADF) {
+            shards_->markDown(shard, *connection);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool MessageSender::sendRouted(const MessageView& msg, int& reply_status) {
+    return sendRouted(msg, routingKey(msg.type, msg.subtype), reply_status);
+}
+
+size_t MessageSender::liveShards() const {
+    return shards_ ? shards_->liveShards() : 0;
+}
+
+bool MessageSender::openSharedRing(uint32_t capacity) {
+    if (!isConnected()) {
+        std::cerr << "Error: Not connected to receiver\n";
+        return false;
+    }
+
+    const RingSetupRequest request{capacity};
+    const MessageHeader header{
+        MSG_TYPE_RING_SETUP,
+        0,
+        static_cast<uint32_t>(sizeof(request))
+    };
+
+    const iovec iov[2] = {
+        {const_cast<MessageHeader*>(&header), sizeof(header)},
+        {const_cast<RingSetupRequest*>(&request), sizeof(request)}
+    };
+
+    RingSetupReply reply{};
+    const iovec reply_iov{&reply, sizeof(reply)};
+    if (connection_->send(iov, 2, &reply_iov, 1) == -1) {
+        std::cerr << "Error: Shared ring setup failed: "
+                  << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    ring_ = SharedRingChannel::open(reply.shm_handle, reply.capacity);
+    if (!ring_) {
+        return false;
+    }
+    ring_id_ = reply.ring_id;
+    doorbell_pending_ = false;
+
+    IPC_LOG_INFO("[{}] Shared ring {} ready ({} bytes)", sender_id_, ring_id_,
+                 ring_->capacity());
+    return true;
+}
+
+bool MessageSender::streamMessage(const MessageView& msg) {
+    if (!ring_ || !isConnected()) {
+        return false;
+    }
+
+    // A previous doorbell failed; the receiver may still be asleep
+    if (doorbell_pending_ && ringDoorbell()) {
+        doorbell_pending_ = false;
+    }
+
+    bool wake_consumer = false;
+    if (!ring_->tryPush(msg, wake_consumer)) {
+        return false;
+    }
+    if (metrics_) {
+        metrics_->add(Counter::MESSAGES);
+        metrics_->add(Counter::PAYLOAD_BYTES, msg.payload.size());
+        metrics_->countMessage(msg.type, msg.subtype);
+    }
+
+    if (wake_consumer && !ringDoorbell()) {
+        doorbell_pending_ = true;
+    }
+    return true;
+}
+
+bool MessageSender::sendTelemetry(const TelemetrySample& sample) {
+    return sendOneWay(PULSE_CODE_TELEMETRY,
+                      static_cast<int>(encodeTelemetry(sample)));
+}
+
+bool MessageSender::sendPulse(int code, int value) {
+    if (code < PULSE_CODE_USER_MIN || code > PULSE_CODE_USER_MAX) {
+        ++pulse_stats_.failed;
+        return false;
+    }
+    return sendOneWay(code, value);
+}
+
 bool MessageSender::isConnected() const noexcept {
-    return connection_.has_value() && connection_->isValid();
+    return connection_ != nullptr;
 }
 
 void MessageSender::displayStartupInfo() const {
-    std::cout << "===========================================\n"
-              << "  " << sender_id_ << " Started\n"
-              << "===========================================\n"
-              << "Process ID: " << getpid() << "\n"
-              << "Connecting to: " << receiver_name_ << "\n";
+    IPC_LOG_INFO("===========================================\n"
+                 "  {} Started\n"
+                 "===========================================\n"
+                 "Process ID: {}\n"
+                 "Connecting to: {}",
+                 sender_id_, getpid(), receiver_name_);
+}
+
+std::unique_ptr<ClientConnection> MessageSender::attemptConnection() {
+    return openConnection(receiver_name_);
+}
+
+ClientConnection* MessageSender::laneConnection(std::string_view lane) {
+    if (!isConnected()) {
+        std::cerr << "Error: Not connected to receiver\n";
+        return nullptr;
+    }
+    if (lane.empty()) {
+        return connection_.get();
+    }
+
+    if (const auto it = lanes_.find(lane); it != lanes_.end()) {
+        return it->second.get();
+    }
+
+    // Each lane is its own channel, so it is also checked by secpol
+    const std::string name = receiver_name_ + "." + std::string(lane);
+    auto connection = openConnection(name);
+    if (!connection) {
+        std::cerr << "Error: Cannot open lane " << name << ": "
+                  << std::strerror(errno) << "\n";
+        return nullptr;
+    }
+    ClientConnection* const opened =
+        lanes_.emplace(std::string(lane), std::move(connection)).first->second.get();
+    if (flow_control_) {
+        (void)joinFlowControl(*opened);
+    }
+    return opened;
+}
+
+CreditWindow* MessageSender::creditsFor(const ClientConnection& connection) const {
+    const auto it = credits_.find(&connection);
+    return (it != credits_.end()) ? it->second.get() : nullptr;
 }
 
-std::optional<int> MessageSender::attemptConnection() {
-    const int coid = name_open(receiver_name_.c_str(), 0);
-    if (coid != -1) {
-        return coid;
+bool MessageSender::joinFlowControl(ClientConnection& connection) {
+    if (creditsFor(connection) != nullptr) {
+        return true;
     }
-    return std::nullopt;
+
+    auto credits = CreditWindow::join(connection);
+    if (!credits) {
+        if (errno == ENOSYS) {
+            IPC_LOG_INFO("[{}] Receiver grants no credits, sending without flow control",
+                         sender_id_);
+        } else {
+            std::cerr << "Error: Credit request failed: "
+                      << std::strerror(errno) << "\n";
+        }
+        return false;
+    }
+
+    const CreditState state = credits->state();
+    IPC_LOG_INFO("[{}] Flow control on (coid: {}, window {}, {} pulses)", sender_id_,
+                 connection.id(), state.window, state.pulse_window);
+    credits_.emplace(&connection, std::move(credits));
+    return true;
+}
+
+bool MessageSender::sendSingleMessage(ClientConnection& connection, const MessageView& msg,
+                                      int& reply_status,
+                                      std::chrono::steady_clock::time_point deadline,
+                                      ReplyBuffer* reply) {
+    // Watched for allocations in realtime mode (-R)
+    const HotPathScope hot_path;
+    const MessageHeader header{
+        msg.type,
+        msg.subtype,
+        static_cast<uint32_t>(msg.payload.size())
+    };
+
+    const SendResult result = exchangeMessage(connection, header, msg.payload,
+                                              creditsFor(connection), false, metrics_.get(),
+                                              deadline, reply);
+    if (!result.ok()) {
+        // A missed deadline is expected and already counted (SEND_TIMEOUTS)
+        if (result.error != ETIMEDOUT) {
+            IPC_LOG_WARN("[{}] MsgSend failed: {}", sender_id_, std::strerror(result.error));
+        }
+        errno = result.error;
+        return false;
+    }
+    reply_status = result.status;
+    return true;
 }
 
-bool MessageSender::sendSingleMessage(const Message& msg, int& reply_status) {
+bool MessageSender::ringDoorbell() {
+    if (connection_->sendPulse(PULSE_CODE_RING_DOORBELL,
+                               static_cast<int>(ring_id_)) == -1) {
+        const int error = errno;
+        if (metrics_) {
+            metrics_->add(error == EAGAIN ? Counter::PULSE_OVERFLOWS : Counter::SEND_ERRORS);
+        }
+        // streamMessage() retries with every message until one goes through
+        if (!doorbell_pending_) {
+            IPC_LOG_WARN("[{}] Ring doorbell failed: {}", sender_id_, std::strerror(error));
+        }
+        return false;
+    }
+    return true;
+}
+
+bool MessageSender::sendOneWay(int code, int value) {
     if (!isConnected()) {
+        ++pulse_stats_.failed;
         return false;
     }
 
-    if (MsgSend(connection_->get(), &msg, sizeof(msg),
-                &reply_status, sizeof(reply_status)) == -1) {
-        std::cerr << "Error: MsgSend failed: "
-                  << std::strerror(errno) << "\n";
+    // A receiver that has fallen behind gets no more pulses
+    CreditWindow* const credits = creditsFor(*connection_);
+    if (credits && !credits->tryAcquirePulse()) {
+        ++pulse_stats_.throttled;
+        if (metrics_) {
+            metrics_->add(Counter::CREDIT_REFUSED);
+        }
         return false;
     }
 
+    // No console output here: this path runs at sensor rate
+    if (connection_->sendPulse(code, value) == -1) {
+        const bool overflow = (errno == EAGAIN);
+        if (credits) {
+            credits->cancelPulse();
+        }
+        if (overflow) {
+            ++pulse_stats_.overflowed;
+        } else {
+            ++pulse_stats_.failed;
+        }
+        if (metrics_) {
+            metrics_->add(overflow ? Counter::PULSE_OVERFLOWS : Counter::SEND_ERRORS);
+        }
+        return false;
+    }
+
+    ++pulse_stats_.sent;
+    if (metrics_) {
+        metrics_->add(Counter::PULSES);
+    }
     return true;
 }
 
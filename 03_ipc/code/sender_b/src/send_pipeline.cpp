@@ -0,0 +1,276 @@
+// send_pipeline.cpp
+// Pipelined asynchronous sending - Implementation
+#include "send_pipeline.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <limits>
+
+namespace qnx::ipc {
+
+void recordReply(IpcMetrics& metrics, const MessageHeader& header, int status,
+                 std::chrono::steady_clock::duration elapsed) noexcept {
+    metrics.add(Counter::MESSAGES);
+    metrics.add(Counter::PAYLOAD_BYTES, header.size);
+    metrics.countMessage(header.type, header.subtype);
+    if (status != EOK) {
+        metrics.add(Counter::REPLY_ERRORS);
+    }
+    metrics.recordLatency(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+SendResult exchangeMessage(ClientConnection& connection, const MessageHeader& header,
+                           std::string_view payload, CreditWindow* credits, bool credited,
+                           IpcMetrics* metrics, std::chrono::steady_clock::time_point deadline,
+                           ReplyBuffer* reply) {
+    const bool bounded = (deadline != NO_DEADLINE);
+    if (credits && !credited) {
+        bool waited = false;
+        bool acquired = true;
+        if (bounded) {
+            acquired = credits->acquireUntil(deadline, waited);
+        } else {
+            waited = credits->acquire();
+        }
+        if (metrics && waited) {
+            metrics->add(Counter::CREDIT_WAITS);
+        }
+        if (!acquired) {
+            if (metrics) {
+                metrics->add(Counter::SEND_TIMEOUTS);
+            }
+            return SendResult{0, ETIMEDOUT};
+        }
+    }
+
+    // A bounded request goes out behind a MSG_TYPE_DEADLINE header and
+    // the time it has left; the kernel gathers all parts in one copy
+    const auto sent = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds timeout{0};
+    DeadlineHeader bound{};
+    if (bounded) {
+        timeout = deadline - sent;
+        bound.sent_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                sent.time_since_epoch()).count());
+        bound.budget_us = static_cast<uint32_t>(std::clamp<int64_t>(
+            std::chrono::ceil<std::chrono::microseconds>(timeout).count(),
+            0, std::numeric_limits<uint32_t>::max()));
+    }
+    MessageHeader envelope{
+        MSG_TYPE_DEADLINE,
+        0,
+        static_cast<uint32_t>(sizeof(bound) + sizeof(header) + payload.size())
+    };
+    const iovec iov[4] = {
+        {&envelope, sizeof(envelope)},
+        {&bound, sizeof(bound)},
+        {const_cast<MessageHeader*>(&header), sizeof(header)},
+        {const_cast<char*>(payload.data()), payload.size()}
+    };
+
+    // A flow-controlled connection's reply carries a grant after the
+    // status; the payload follows, received straight into the caller's buffer
+    int status = 0;
+    CreditGrant grant{};
+    std::array<iovec, 3> reply_iov;
+    int rparts = 0;
+    reply_iov[rparts++] = iovec{&status, sizeof(status)};
+    if (credits) {
+        reply_iov[rparts++] = iovec{&grant, sizeof(grant)};
+    }
+    if (reply) {
+        reply_iov[rparts++] = iovec{reply->data, reply->capacity};
+    }
+    const int result = bounded
+        ? connection.send(iov, 4, reply_iov.data(), rparts, timeout)
+        : connection.send(iov + 2, 2, reply_iov.data(), rparts);
+    const int error = errno;
+    if (credits) {
+        credits->release(grant);
+    }
+    if (result == -1) {
+        if (metrics) {
+            metrics->add(error == ETIMEDOUT ? Counter::SEND_TIMEOUTS : Counter::SEND_ERRORS);
+        }
+        return SendResult{0, error};
+    }
+
+    // The reply's status is the size of the payload the receiver sent
+    if (reply) {
+        reply->size = static_cast<size_t>(result);
+    }
+    if (metrics) {
+        recordReply(*metrics, header, status, std::chrono::steady_clock::now() - sent);
+        if (reply && result > 0) {
+            metrics->add(Counter::REPLY_BYTES, static_cast<uint64_t>(result));
+        }
+    }
+    return SendResult{status, 0};
+}
+
+SendPipeline::SendPipeline(ClientConnection& connection, size_t window,
+                           size_t queue_limit, std::shared_ptr<IpcMetrics> metrics,
+                           CreditWindow* credits)
+    : connection_(connection),
+      queue_limit_(queue_limit == 0 ? 1 : queue_limit),
+      metrics_(std::move(metrics)),
+      credits_(credits),
+      lanes_(window == 0 ? 1 : window),
+      slots_(queue_limit_ + lanes_.size()),
+      queued_(0),
+      outstanding_(0),
+      stopping_(false) {
+    free_slots_.reserve(slots_.size());
+    for (size_t slot = slots_.size(); slot > 0; --slot) {
+        free_slots_.push_back(slot - 1);
+    }
+
+    threads_.reserve(lanes_.size());
+    for (size_t lane = 0; lane < lanes_.size(); ++lane) {
+        threads_.emplace_back(&SendPipeline::senderLoop, this, lane);
+    }
+}
+
+SendPipeline::~SendPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void SendPipeline::submit(const MessageView& msg, ReplyCallback on_reply,
+                          std::optional<uint32_t> stream,
+                          std::chrono::steady_clock::time_point deadline) {
+    size_t slot = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_cv_.wait(lock, [this] { return queued_ < queue_limit_; });
+        slot = reserveLocked();
+    }
+    enqueue(slot, msg, std::move(on_reply), false, stream, deadline);
+}
+
+bool SendPipeline::trySubmit(const MessageView& msg, ReplyCallback on_reply,
+                             std::optional<uint32_t> stream,
+                             std::chrono::steady_clock::time_point deadline) {
+    size_t slot = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queued_ >= queue_limit_ || (credits_ && !credits_->tryAcquire())) {
+            return false;
+        }
+        slot = reserveLocked();
+    }
+    enqueue(slot, msg, std::move(on_reply), credits_ != nullptr, stream, deadline);
+    return true;
+}
+
+void SendPipeline::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return outstanding_ == 0; });
+}
+
+size_t SendPipeline::reserveLocked() {
+    // queued_ < queue_limit_ and at most window requests in flight, so a
+    // slot is always free here
+    const size_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    ++queued_;
+    ++outstanding_;
+    return slot;
+}
+
+void SendPipeline::enqueue(size_t slot, const MessageView& msg, ReplyCallback on_reply,
+                           bool credited, std::optional<uint32_t> stream,
+                           std::chrono::steady_clock::time_point deadline) {
+    // The slot is ours alone until queued, so copy without the lock;
+    // assign() reuses the capacity left by earlier requests
+    slots_[slot].assign(msg.payload.begin(), msg.payload.end());
+    Request request{
+        MessageHeader{msg.type, msg.subtype,
+                      static_cast<uint32_t>(msg.payload.size())},
+        slot,
+        std::move(on_reply),
+        credited,
+        deadline
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stream) {
+            lanes_[*stream % lanes_.size()].push_back(std::move(request));
+        } else {
+            shared_.push_back(std::move(request));
+        }
+    }
+    notifyWork(stream);
+}
+
+void SendPipeline::notifyWork(std::optional<uint32_t> stream) {
+    // Ordered requests must reach their own lane's thread
+    if (stream) {
+        work_cv_.notify_all();
+    } else {
+        work_cv_.notify_one();
+    }
+}
+
+void SendPipeline::senderLoop(size_t lane) {
+    auto& own = lanes_[lane];
+
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this, &own] {
+                return stopping_ || !own.empty() || !shared_.empty();
+            });
+
+            // Own lane first so ordered streams don't starve
+            auto& queue = !own.empty() ? own : shared_;
+            if (queue.empty()) {
+                return;     // Stopping and nothing left to send
+            }
+            request = std::move(queue.front());
+            queue.pop_front();
+            --queued_;
+        }
+        space_cv_.notify_one();
+
+        const SendResult result = transmit(request);
+        if (request.on_reply) {
+            request.on_reply(result);
+        }
+
+        auto& payload = slots_[request.slot];
+        if (payload.capacity() > SLOT_KEEP_BYTES) {
+            std::vector<char>().swap(payload);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_slots_.push_back(request.slot);
+            --outstanding_;
+            if (outstanding_ == 0) {
+                idle_cv_.notify_all();
+            }
+        }
+    }
+}
+
+SendResult SendPipeline::transmit(const Request& request) const {
+    return exchangeMessage(connection_, request.header,
+                           std::string_view(slots_[request.slot].data(),
+                                            slots_[request.slot].size()),
+                           credits_, request.credited, metrics_.get(), request.deadline);
+}
+
+} // namespace qnx::ipc
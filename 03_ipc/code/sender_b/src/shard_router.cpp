@@ -0,0 +1,142 @@
+// shard_router.cpp
+// Consistent-hash routing over receiver shards - Implementation
+#include "shard_router.h"
+#include "binary_log.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace qnx::ipc {
+
+namespace {
+    // splitmix64 finalizer: neighbouring keys land far apart on the ring
+    constexpr uint64_t mix(uint64_t x) noexcept {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // A shard's points depend only on its index, so membership changes
+    // leave every other shard's points where they were
+    constexpr uint64_t pointHash(uint32_t shard, uint32_t node) noexcept {
+        return mix((static_cast<uint64_t>(shard) << 32 | node) ^ 0x9e3779b97f4a7c15ULL);
+    }
+
+    int64_t nowNs() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+ShardRouter::ShardRouter(std::string_view base_name, uint32_t shard_count,
+                         std::chrono::milliseconds rescan)
+    : base_name_(base_name),
+      rescan_(rescan),
+      shards_(shard_count),
+      next_rescan_ns_(0) {}
+
+size_t ShardRouter::discover() {
+    std::lock_guard<std::mutex> discovering(discover_mutex_);
+    return discoverLocked();
+}
+
+std::shared_ptr<ClientConnection> ShardRouter::route(uint64_t key, uint32_t& shard) {
+    if (nowNs() >= next_rescan_ns_.load(std::memory_order_relaxed)) {
+        // Whoever finds the rescan due does it; the others route as before
+        std::unique_lock<std::mutex> discovering(discover_mutex_, std::try_to_lock);
+        if (discovering.owns_lock() &&
+            nowNs() >= next_rescan_ns_.load(std::memory_order_relaxed)) {
+            (void)discoverLocked();
+        }
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (ring_.empty()) {
+        return nullptr;
+    }
+
+    const uint64_t hash = mix(key);
+    auto it = std::lower_bound(ring_.begin(), ring_.end(), hash,
+                               [](const Point& point, uint64_t h) { return point.hash < h; });
+    if (it == ring_.end()) {
+        it = ring_.begin();
+    }
+    shard = it->shard;
+    return shards_[shard];
+}
+
+size_t ShardRouter::discoverLocked() {
+    next_rescan_ns_.store(
+        nowNs() + std::chrono::duration_cast<std::chrono::nanoseconds>(rescan_).count(),
+        std::memory_order_relaxed);
+
+    std::vector<uint32_t> missing;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (uint32_t shard = 0; shard < shards_.size(); ++shard) {
+            if (!shards_[shard]) {
+                missing.push_back(shard);
+            }
+        }
+    }
+
+    // Opened without the lock held: routing carries on meanwhile
+    std::vector<std::pair<uint32_t, std::shared_ptr<ClientConnection>>> opened;
+    for (const uint32_t shard : missing) {
+        if (auto connection = openConnection(base_name_ + "." + std::to_string(shard))) {
+            opened.emplace_back(shard, std::move(connection));
+        }
+    }
+
+    if (opened.empty()) {
+        return liveShards();
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (auto& [shard, connection] : opened) {
+        shards_[shard] = std::move(connection);
+    }
+    rebuildLocked();
+    for (const auto& entry : opened) {
+        IPC_LOG_INFO("Shard {}.{} joined (coid: {}, {} of {} live)", base_name_, entry.first,
+                     shards_[entry.first]->id(), ring_.size() / VIRTUAL_NODES, shards_.size());
+    }
+    return ring_.size() / VIRTUAL_NODES;
+}
+
+void ShardRouter::markDown(uint32_t shard, const ClientConnection& connection) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (shard >= shards_.size() || shards_[shard].get() != &connection) {
+        return;     // Another sender got there first
+    }
+
+    // Senders still using the connection keep it alive until they return
+    shards_[shard].reset();
+    rebuildLocked();
+    IPC_LOG_WARN("Shard {}.{} is gone, its keys move to the {} live shards", base_name_,
+                 shard, ring_.size() / VIRTUAL_NODES);
+}
+
+size_t ShardRouter::liveShards() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return ring_.size() / VIRTUAL_NODES;
+}
+
+void ShardRouter::rebuildLocked() {
+    ring_.clear();
+    for (uint32_t shard = 0; shard < shards_.size(); ++shard) {
+        if (!shards_[shard]) {
+            continue;
+        }
+        for (uint32_t node = 0; node < VIRTUAL_NODES; ++node) {
+            ring_.push_back(Point{pointHash(shard, node), shard});
+        }
+    }
+    std::sort(ring_.begin(), ring_.end(),
+              [](const Point& a, const Point& b) { return a.hash < b.hash; });
+}
+
+} // namespace qnx::ipc
@@ -0,0 +1,112 @@
+// shared_ring_channel.h
+// Single-producer/single-consumer message ring in shared memory - Header
+#ifndef SHARED_RING_CHANNEL_H
+#define SHARED_RING_CHANNEL_H
+
+#include "message.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <sys/types.h>
+
+namespace qnx::ipc {
+
+/// Default and limits for the ring data area (power of two)
+constexpr uint32_t DEFAULT_RING_CAPACITY = 1024 * 1024;
+constexpr uint32_t MIN_RING_CAPACITY = 4 * 1024;
+constexpr uint32_t MAX_RING_CAPACITY = 64 * 1024 * 1024;
+
+/**
+ * @brief Lock-free SPSC ring of variable-length messages in shared memory
+ *
+ * The receiver creates the ring (create()) and hands the client a
+ * shm handle that only the client's process can open (open()). Records
+ * are a MessageHeader plus payload, 8-byte aligned. Data flows without
+ * kernel calls; the producer only sends a doorbell pulse when the
+ * consumer has declared itself idle.
+ *
+ * The consumer treats the shared area as untrusted: every record header
+ * is bounds-checked, and a malformed ring is marked broken.
+ */
+class SharedRingChannel {
+public:
+    /**
+     * @brief Create a ring (consumer side)
+     * @param capacity Data bytes, rounded up to a power of two
+     * @param client_pid Only this process may open the returned handle
+     * @param handle Receives the shm handle for the client
+     */
+    static std::optional<SharedRingChannel> create(uint32_t capacity,
+                                                   pid_t client_pid,
+                                                   uint64_t& handle);
+
+    /**
+     * @brief Map a ring created by the receiver (producer side)
+     */
+    static std::optional<SharedRingChannel> open(uint64_t handle,
+                                                 uint32_t capacity);
+
+    // Prevent copying
+    SharedRingChannel(const SharedRingChannel&) = delete;
+    SharedRingChannel& operator=(const SharedRingChannel&) = delete;
+
+    // Allow moving
+    SharedRingChannel(SharedRingChannel&& other) noexcept;
+    SharedRingChannel& operator=(SharedRingChannel&& other) noexcept;
+
+    ~SharedRingChannel() noexcept;
+
+    /**
+     * @brief Append one record (producer)
+     * @param msg Message to copy into the ring
+     * @param wake_consumer Set when the consumer is idle and needs a doorbell
+     * @return false if the ring is full or the record cannot fit at all
+     */
+    bool tryPush(const MessageView& msg, bool& wake_consumer);
+
+    /**
+     * @brief Hand up to budget records to handler, in order (consumer)
+     *
+     * The view points into the ring and is valid during the call only.
+     * @return Number of records consumed
+     */
+    size_t drain(size_t budget,
+                 const std::function<void(const MessageView&)>& handler);
+
+    /**
+     * @brief Publish whether the consumer stopped draining (consumer)
+     *
+     * Marking idle and then re-checking empty() closes the race with a
+     * producer that pushed just before the flag became visible.
+     */
+    void setConsumerIdle(bool idle) noexcept;
+
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] bool isBroken() const noexcept { return broken_; }
+    [[nodiscard]] uint32_t capacity() const noexcept { return capacity_; }
+
+    /// Largest payload a single record may carry
+    [[nodiscard]] size_t maxPayload() const noexcept;
+
+private:
+    struct Control;
+
+    SharedRingChannel(void* base, size_t mapped, uint32_t capacity) noexcept;
+
+    void* base_;
+    size_t mapped_;
+    uint32_t capacity_;
+    Control* control_;
+    char* data_;
+    uint64_t position_;     // Producer: tail, consumer: head (owned locally)
+    bool broken_;
+
+    static size_t mappedSize(uint32_t capacity) noexcept;
+};
+
+} // namespace qnx::ipc
+
+#endif // SHARED_RING_CHANNEL_H
@@ -0,0 +1,342 @@
+// shared_ring_channel.cpp
+// Shared-memory SPSC message ring - Implementation
+#include "shared_ring_channel.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <new>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifndef __QNXNTO__
+#include <sys/random.h>
+#endif
+
+namespace qnx::ipc {
+
+namespace {
+    // Record type used to skip the unused tail of the data area on wrap
+    constexpr uint16_t RING_PAD_TYPE = 0xFFFF;
+    constexpr uint64_t RECORD_ALIGN = 8;
+
+    constexpr uint64_t alignRecord(uint64_t bytes) noexcept {
+        return (bytes + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+    }
+
+    uint32_t roundCapacity(uint32_t capacity) noexcept {
+        uint32_t rounded = MIN_RING_CAPACITY;
+        while (rounded < capacity && rounded < MAX_RING_CAPACITY) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    bool isValidCapacity(uint32_t capacity) noexcept {
+        return capacity >= MIN_RING_CAPACITY && capacity <= MAX_RING_CAPACITY &&
+               (capacity & (capacity - 1)) == 0;
+    }
+
+#ifdef __QNXNTO__
+    // Anonymous object; the handle is granted once it is mapped
+    int createObject(uint64_t& /*handle*/) {
+        return shm_open(SHM_ANON, O_RDWR | O_CREAT, 0600);
+    }
+
+    bool grantHandle(int fd, pid_t client_pid, uint64_t& handle) {
+        shm_handle_t shm_handle{};
+        if (shm_create_handle(fd, client_pid, O_RDWR, &shm_handle, 0) == -1) {
+            return false;
+        }
+        handle = shm_handle;
+        return true;
+    }
+
+    int openHandle(uint64_t handle) {
+        return shm_open_handle(static_cast<shm_handle_t>(handle), O_RDWR);
+    }
+
+    void discardObject(uint64_t /*handle*/) {}
+#else
+    // No shm handles on Linux: the handle is a random name, readable only
+    // by our user, that the client unlinks as soon as it has opened it
+    constexpr int CREATE_ATTEMPTS = 8;
+
+    std::string handleName(uint64_t handle) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "/qnx_ipc.ring.%016llx",
+                      static_cast<unsigned long long>(handle));
+        return name;
+    }
+
+    int createObject(uint64_t& handle) {
+        for (int attempt = 0; attempt < CREATE_ATTEMPTS; ++attempt) {
+            uint64_t candidate;
+            if (getrandom(&candidate, sizeof(candidate), 0) != sizeof(candidate)) {
+                return -1;
+            }
+            const int fd = shm_open(handleName(candidate).c_str(),
+                                    O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd != -1 || errno != EEXIST) {
+                handle = candidate;
+                return fd;
+            }
+        }
+        return -1;
+    }
+
+    bool grantHandle(int /*fd*/, pid_t /*client_pid*/, uint64_t& /*handle*/) {
+        return true;
+    }
+
+    int openHandle(uint64_t handle) {
+        const std::string name = handleName(handle);
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd != -1) {
+            shm_unlink(name.c_str());
+        }
+        return fd;
+    }
+
+    void discardObject(uint64_t handle) {
+        shm_unlink(handleName(handle).c_str());
+    }
+#endif
+}
+
+/**
+ * @brief Shared control block at the start of the mapping
+ *
+ * Producer- and consumer-written fields live on separate cache lines.
+ */
+struct SharedRingChannel::Control {
+    alignas(64) std::atomic<uint64_t> head;          // Written by consumer
+    alignas(64) std::atomic<uint64_t> tail;          // Written by producer
+    alignas(64) std::atomic<uint32_t> consumer_idle; // Doorbell needed
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "ring positions must be lock-free to be shared between processes");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "ring flags must be lock-free to be shared between processes");
+
+size_t SharedRingChannel::mappedSize(uint32_t capacity) noexcept {
+    return sizeof(Control) + capacity;
+}
+
+std::optional<SharedRingChannel> SharedRingChannel::create(uint32_t capacity,
+                                                           pid_t client_pid,
+                                                           uint64_t& handle) {
+    capacity = roundCapacity(capacity);
+    const size_t size = mappedSize(capacity);
+
+    uint64_t shm_handle = 0;
+    const int fd = createObject(shm_handle);
+    if (fd == -1) {
+        std::cerr << "Error: shm_open failed: " << std::strerror(errno) << "\n";
+        return std::nullopt;
+    }
+
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1 ||
+        (base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0)) == MAP_FAILED ||
+        !grantHandle(fd, client_pid, shm_handle)) {
+        std::cerr << "Error: Shared ring setup failed: "
+                  << std::strerror(errno) << "\n";
+        if (base != MAP_FAILED) {
+            munmap(base, size);
+        }
+        close(fd);
+        discardObject(shm_handle);
+        return std::nullopt;
+    }
+    close(fd);
+
+    auto* control = new (base) Control{};
+    control->consumer_idle.store(1);
+
+    handle = shm_handle;
+    return SharedRingChannel(base, size, capacity);
+}
+
+std::optional<SharedRingChannel> SharedRingChannel::open(uint64_t handle,
+                                                         uint32_t capacity) {
+    if (!isValidCapacity(capacity)) {
+        std::cerr << "Error: Invalid shared ring capacity " << capacity << "\n";
+        return std::nullopt;
+    }
+
+    const int fd = openHandle(handle);
+    if (fd == -1) {
+        std::cerr << "Error: shm_open_handle failed: "
+                  << std::strerror(errno) << "\n";
+        return std::nullopt;
+    }
+
+    const size_t size = mappedSize(capacity);
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "Error: mmap failed: " << std::strerror(errno) << "\n";
+        return std::nullopt;
+    }
+
+    SharedRingChannel ring(base, size, capacity);
+    ring.position_ = ring.control_->tail.load();
+    return ring;
+}
+
+SharedRingChannel::SharedRingChannel(void* base, size_t mapped,
+                                     uint32_t capacity) noexcept
+    : base_(base),
+      mapped_(mapped),
+      capacity_(capacity),
+      control_(static_cast<Control*>(base)),
+      data_(static_cast<char*>(base) + sizeof(Control)),
+      position_(0),
+      broken_(false) {}
+
+SharedRingChannel::SharedRingChannel(SharedRingChannel&& other) noexcept
+    : base_(other.base_),
+      mapped_(other.mapped_),
+      capacity_(other.capacity_),
+      control_(other.control_),
+      data_(other.data_),
+      position_(other.position_),
+      broken_(other.broken_) {
+    other.base_ = nullptr;
+}
+
+SharedRingChannel& SharedRingChannel::operator=(SharedRingChannel&& other) noexcept {
+    if (this != &other) {
+        if (base_ != nullptr) {
+            munmap(base_, mapped_);
+        }
+        base_ = other.base_;
+        mapped_ = other.mapped_;
+        capacity_ = other.capacity_;
+        control_ = other.control_;
+        data_ = other.data_;
+        position_ = other.position_;
+        broken_ = other.broken_;
+        other.base_ = nullptr;
+    }
+    return *this;
+}
+
+SharedRingChannel::~SharedRingChannel() noexcept {
+    if (base_ != nullptr) {
+        munmap(base_, mapped_);
+    }
+}
+
+size_t SharedRingChannel::maxPayload() const noexcept {
+    return capacity_ / 4 - sizeof(MessageHeader);
+}
+
+bool SharedRingChannel::tryPush(const MessageView& msg, bool& wake_consumer) {
+    wake_consumer = false;
+    if (broken_ || msg.payload.size() > maxPayload()) {
+        return false;
+    }
+
+    const uint64_t record = alignRecord(sizeof(MessageHeader) + msg.payload.size());
+    const uint64_t head = control_->head.load(std::memory_order_acquire);
+    uint64_t offset = position_ & (capacity_ - 1);
+    const uint64_t contiguous = capacity_ - offset;
+    const uint64_t needed = (record <= contiguous) ? record : contiguous + record;
+
+    if (position_ + needed - head > capacity_) {
+        return false;
+    }
+
+    if (record > contiguous) {
+        const MessageHeader pad{RING_PAD_TYPE, 0,
+                                static_cast<uint32_t>(contiguous - sizeof(MessageHeader))};
+        std::memcpy(data_ + offset, &pad, sizeof(pad));
+        position_ += contiguous;
+        offset = 0;
+    }
+
+    const MessageHeader header{msg.type, msg.subtype,
+                               static_cast<uint32_t>(msg.payload.size())};
+    std::memcpy(data_ + offset, &header, sizeof(header));
+    std::memcpy(data_ + offset + sizeof(header), msg.payload.data(),
+                msg.payload.size());
+    position_ += record;
+
+    // Publish, then check idle: pairs with setConsumerIdle() + empty()
+    control_->tail.store(position_, std::memory_order_seq_cst);
+    wake_consumer = control_->consumer_idle.load(std::memory_order_seq_cst) != 0 &&
+                    control_->consumer_idle.exchange(0) != 0;
+    return true;
+}
+
+size_t SharedRingChannel::drain(size_t budget,
+                                const std::function<void(const MessageView&)>& handler) {
+    size_t count = 0;
+    uint64_t tail = control_->tail.load(std::memory_order_acquire);
+
+    while (!broken_ && count < budget) {
+        if (position_ == tail) {
+            tail = control_->tail.load(std::memory_order_acquire);
+            if (position_ == tail) {
+                break;
+            }
+        }
+
+        const uint64_t available = tail - position_;
+        const uint64_t offset = position_ & (capacity_ - 1);
+        const uint64_t contiguous = capacity_ - offset;
+
+        // The producer is another process: never trust what it wrote
+        if (available > capacity_ || available % RECORD_ALIGN != 0) {
+            broken_ = true;
+            break;
+        }
+
+        MessageHeader header;
+        std::memcpy(&header, data_ + offset, sizeof(header));
+
+        if (header.type == RING_PAD_TYPE) {
+            if (header.size != contiguous - sizeof(header) || contiguous > available) {
+                broken_ = true;
+                break;
+            }
+            position_ += contiguous;
+            control_->head.store(position_, std::memory_order_release);
+            continue;
+        }
+
+        const uint64_t record = alignRecord(sizeof(header) + uint64_t{header.size});
+        if (record > contiguous || record > available) {
+            broken_ = true;
+            break;
+        }
+
+        handler(MessageView{
+            header.type,
+            header.subtype,
+            std::string_view(data_ + offset + sizeof(header), header.size)
+        });
+
+        position_ += record;
+        control_->head.store(position_, std::memory_order_release);
+        ++count;
+    }
+
+    return count;
+}
+
+void SharedRingChannel::setConsumerIdle(bool idle) noexcept {
+    control_->consumer_idle.store(idle ? 1 : 0, std::memory_order_seq_cst);
+}
+
+bool SharedRingChannel::empty() const noexcept {
+    return control_->tail.load(std::memory_order_seq_cst) == position_;
+}
+
+} // namespace qnx::ipc
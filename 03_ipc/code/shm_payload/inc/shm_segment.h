@@ -0,0 +1,259 @@
+// shm_segment.h
+// Pooled shared-memory segments for large message payloads - Header
+#ifndef SHM_SEGMENT_H
+#define SHM_SEGMENT_H
+
+#include "message.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+namespace qnx::ipc {
+
+/// Segment sizes: powers of two between these
+constexpr size_t SHM_SEGMENT_MIN_SIZE = 64 * 1024;
+constexpr size_t SHM_SEGMENT_MAX_SIZE = 256 * 1024 * 1024;
+
+/// Segments one client may have mapped in the receiver at once
+constexpr size_t MAX_CLIENT_SEGMENTS = 16;
+
+/// Segments a sender keeps for reuse by default
+constexpr size_t DEFAULT_POOLED_SEGMENTS = 8;
+
+struct ShmSegment;
+class ShmSegmentPool;
+
+/**
+ * @brief A segment lent out by a ShmSegmentPool (sender side)
+ *
+ * Writable until it is sent. Move-only; a payload that is never sent
+ * goes back to its pool when destroyed. Must not outlive the pool.
+ */
+class ShmPayload {
+public:
+    ShmPayload() noexcept = default;
+    ~ShmPayload();
+
+    ShmPayload(const ShmPayload&) = delete;
+    ShmPayload& operator=(const ShmPayload&) = delete;
+
+    ShmPayload(ShmPayload&& other) noexcept
+        : pool_(std::exchange(other.pool_, nullptr)),
+          segment_(std::exchange(other.segment_, nullptr)) {}
+    ShmPayload& operator=(ShmPayload&& other) noexcept;
+
+    [[nodiscard]] char* data() const noexcept;
+    [[nodiscard]] size_t capacity() const noexcept;
+    explicit operator bool() const noexcept { return segment_ != nullptr; }
+
+private:
+    friend class ShmSegmentPool;
+
+    ShmPayload(ShmSegmentPool* pool, ShmSegment* segment) noexcept
+        : pool_(pool), segment_(segment) {}
+
+    ShmSegmentPool* pool_ = nullptr;
+    ShmSegment* segment_ = nullptr;
+};
+
+/**
+ * @brief Counters of a ShmSegmentPool
+ */
+struct ShmPoolStats {
+    uint64_t created;       // Segments created (each one shm object and mapping)
+    uint64_t reused;        // Payloads served from a pooled segment
+    uint64_t one_shot;      // Segments sent once and released: the pool was full
+    size_t pooled_bytes;    // Bytes of the segments kept for reuse
+};
+
+/**
+ * @brief Shared-memory segments a sender fills and lends to one receiver
+ *
+ * Each segment is a shared memory object mapped read-write here. Its
+ * handle (shm_create_handle()) lets only the receiver's process open it,
+ * read-only; the first message in a segment carries the handle, and the
+ * receiver keeps the segment mapped for the ones after. A segment comes
+ * back to the pool once its message has been replied to with EOK, so the
+ * cost of creating and mapping it is paid once for many messages.
+ *
+ * Segments are sized in powers of two from SHM_SEGMENT_MIN_SIZE. Up to
+ * max_pooled of them are kept; one needed beyond that is sent with
+ * SHM_SEGMENT_RELEASE and unmapped on both sides afterwards. Thread-safe.
+ *
+ * On a Linux host a handle is a randomly named POSIX shared memory
+ * object readable only by the same user, which the receiver unlinks as
+ * soon as it has opened it.
+ */
+class ShmSegmentPool {
+public:
+    /**
+     * @param receiver_pid Only this process may open the segments
+     * @param max_pooled Segments kept for reuse
+     */
+    ShmSegmentPool(pid_t receiver_pid, size_t max_pooled = DEFAULT_POOLED_SEGMENTS);
+    ~ShmSegmentPool();
+
+    // Prevent copying and moving (payloads point back to the pool)
+    ShmSegmentPool(const ShmSegmentPool&) = delete;
+    ShmSegmentPool& operator=(const ShmSegmentPool&) = delete;
+
+    /**
+     * @brief A segment of at least size bytes, a free one if there is one
+     * @return An empty payload with errno set on failure (EMSGSIZE above
+     *         SHM_SEGMENT_MAX_SIZE)
+     */
+    [[nodiscard]] ShmPayload acquire(size_t size);
+
+    /**
+     * @brief The MSG_TYPE_SHM_PAYLOAD payload announcing payload's first
+     *        size bytes as a type/subtype message
+     *
+     * Carries the segment's handle the first time it is sent.
+     */
+    [[nodiscard]] ShmPayloadHeader describe(const ShmPayload& payload, uint16_t type,
+                                            uint16_t subtype, size_t size) const noexcept;
+
+    /**
+     * @brief Give back a payload that was sent
+     * @param reusable The receiver replied EOK, so it has the segment
+     *        mapped and is done reading it; any other segment is destroyed
+     */
+    void release(ShmPayload payload, bool reusable) noexcept;
+
+    [[nodiscard]] ShmPoolStats stats() const;
+
+private:
+    friend class ShmPayload;
+
+    pid_t receiver_pid_;
+    size_t max_pooled_;
+
+    mutable std::mutex mutex_;
+    std::vector<ShmSegment*> free_;
+    size_t pooled_ = 0;             // Segments, lent or free, that come back here
+    uint32_t next_id_ = 1;
+    ShmPoolStats stats_{0, 0, 0, 0};
+
+    [[nodiscard]] ShmSegment* create(size_t capacity, bool pooled);
+    void recycle(ShmSegment* segment, bool reusable) noexcept;
+    void destroy(ShmSegment* segment) noexcept;
+};
+
+/**
+ * @brief A segment mapped read-only in the receiver
+ */
+class ShmMapping {
+public:
+    ShmMapping(const char* data, size_t size) noexcept : data_(data), size_(size) {}
+    ~ShmMapping();
+
+    ShmMapping(const ShmMapping&) = delete;
+    ShmMapping& operator=(const ShmMapping&) = delete;
+
+    [[nodiscard]] const char* data() const noexcept { return data_; }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+};
+
+/**
+ * @brief The segments one client has shared with the receiver
+ *
+ * Maps a segment read-only when a message first carries its handle and
+ * keeps it until the client releases it or goes away, at most
+ * MAX_CLIENT_SEGMENTS at a time; when full, a segment no message is
+ * using makes room. The receiver also releases a segment whose message
+ * it answers with anything but EOK, since the sender destroys it then. A mapping is shared with the messages using it, so
+ * it stays valid while they are handled.
+ *
+ * The sender keeps write access to its segments. A segment is checked
+ * to be as large as announced when it is mapped, and handlers should
+ * treat its bytes like any other payload from another process (see
+ * SharedRingChannel). Thread-safe.
+ */
+class ShmSegmentMap {
+public:
+    ShmSegmentMap() = default;
+
+    // Prevent copying and moving (workers share one map)
+    ShmSegmentMap(const ShmSegmentMap&) = delete;
+    ShmSegmentMap& operator=(const ShmSegmentMap&) = delete;
+
+    /**
+     * @brief The segment a MSG_TYPE_SHM_PAYLOAD message names, mapping
+     *        it first if the message carries its handle
+     * @param mapping Receives the segment; the payload is its first
+     *        header.size bytes
+     * @param mapped Set if this call mapped the segment
+     * @return EOK; EBADMSG for a malformed header, EMSGSIZE for a segment
+     *         above SHM_SEGMENT_MAX_SIZE, ENOENT for an unknown segment,
+     *         EMFILE if MAX_CLIENT_SEGMENTS are in use, or the errno of
+     *         opening or mapping it
+     */
+    int resolve(const ShmPayloadHeader& header, std::shared_ptr<const ShmMapping>& mapping,
+                bool& mapped);
+
+    /**
+     * @brief Forget a segment; it is unmapped once no message uses it
+     */
+    void release(uint32_t segment) noexcept;
+
+    [[nodiscard]] size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::pair<uint32_t, std::shared_ptr<const ShmMapping>>> segments_;
+};
+
+/**
+ * @brief The receiver's hold on the segment one message's payload is in
+ *
+ * Keeps the mapping valid while the message is handled, on the worker
+ * or in a handler that finishes later. A segment the sender sent with
+ * SHM_SEGMENT_RELEASE is forgotten by its map when the hold ends.
+ * Move-only.
+ */
+class ShmSegmentHold {
+public:
+    ShmSegmentHold() noexcept = default;
+
+    /**
+     * @param release Segment id to release from map afterwards, if any
+     */
+    ShmSegmentHold(std::shared_ptr<const ShmMapping> mapping,
+                   std::shared_ptr<ShmSegmentMap> map,
+                   std::optional<uint32_t> release) noexcept
+        : mapping_(std::move(mapping)), map_(std::move(map)), release_(release) {}
+    ~ShmSegmentHold() { reset(); }
+
+    ShmSegmentHold(const ShmSegmentHold&) = delete;
+    ShmSegmentHold& operator=(const ShmSegmentHold&) = delete;
+
+    ShmSegmentHold(ShmSegmentHold&& other) noexcept
+        : mapping_(std::move(other.mapping_)), map_(std::move(other.map_)),
+          release_(std::exchange(other.release_, std::nullopt)) {}
+    ShmSegmentHold& operator=(ShmSegmentHold&& other) noexcept;
+
+    [[nodiscard]] const ShmMapping* mapping() const noexcept { return mapping_.get(); }
+    explicit operator bool() const noexcept { return mapping_ != nullptr; }
+
+    void reset() noexcept;
+
+private:
+    std::shared_ptr<const ShmMapping> mapping_;
+    std::shared_ptr<ShmSegmentMap> map_;
+    std::optional<uint32_t> release_;
+};
+
+} // namespace qnx::ipc
+
+#endif // SHM_SEGMENT_H
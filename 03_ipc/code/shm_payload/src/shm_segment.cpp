@@ -0,0 +1,406 @@
+// shm_segment.cpp
+// Pooled shared-memory segments for large message payloads - Implementation
+#include "shm_segment.h"
+#include "binary_log.h"
+#include "transport.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifndef __QNXNTO__
+#include <sys/random.h>
+#endif
+
+namespace qnx::ipc {
+
+/**
+ * @brief One segment, mapped read-write on the sender side
+ */
+struct ShmSegment {
+    uint32_t id;
+    char* data;
+    size_t capacity;
+    uint64_t handle;
+    bool granted;       // The receiver has it mapped
+    bool pooled;        // Comes back to the pool after use
+};
+
+namespace {
+    size_t roundSegment(size_t size) noexcept {
+        size_t rounded = SHM_SEGMENT_MIN_SIZE;
+        while (rounded < size) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+#ifdef __QNXNTO__
+    // Anonymous object; the handle is granted once it is sized
+    int createObject(uint64_t& /*handle*/) {
+        return shm_open(SHM_ANON, O_RDWR | O_CREAT, 0600);
+    }
+
+    bool grantHandle(int fd, pid_t receiver_pid, uint64_t& handle) {
+        shm_handle_t shm_handle{};
+        if (shm_create_handle(fd, receiver_pid, O_RDONLY, &shm_handle, 0) == -1) {
+            return false;
+        }
+        handle = shm_handle;
+        return true;
+    }
+
+    int openHandle(uint64_t handle) {
+        return shm_open_handle(static_cast<shm_handle_t>(handle), O_RDONLY);
+    }
+
+    void discardObject(uint64_t handle) {
+        shm_delete_handle(static_cast<shm_handle_t>(handle));
+    }
+#else
+    // No shm handles on Linux: the handle is a random name, readable only
+    // by our user, that the receiver unlinks as soon as it has opened it
+    constexpr int CREATE_ATTEMPTS = 8;
+
+    std::string handleName(uint64_t handle) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "/qnx_ipc.segment.%016llx",
+                      static_cast<unsigned long long>(handle));
+        return name;
+    }
+
+    int createObject(uint64_t& handle) {
+        for (int attempt = 0; attempt < CREATE_ATTEMPTS; ++attempt) {
+            uint64_t candidate;
+            if (getrandom(&candidate, sizeof(candidate), 0) != sizeof(candidate)) {
+                return -1;
+            }
+            const int fd = shm_open(handleName(candidate).c_str(),
+                                    O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd != -1 || errno != EEXIST) {
+                handle = candidate;
+                return fd;
+            }
+        }
+        return -1;
+    }
+
+    bool grantHandle(int /*fd*/, pid_t /*receiver_pid*/, uint64_t& /*handle*/) {
+        return true;
+    }
+
+    int openHandle(uint64_t handle) {
+        const std::string name = handleName(handle);
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd != -1) {
+            shm_unlink(name.c_str());
+        }
+        return fd;
+    }
+
+    void discardObject(uint64_t handle) {
+        shm_unlink(handleName(handle).c_str());
+    }
+#endif
+}
+
+// ---- ShmPayload ----------------------------------------------------------
+
+ShmPayload::~ShmPayload() {
+    if (segment_ != nullptr) {
+        pool_->recycle(segment_, true);     // Never sent: as good as new
+    }
+}
+
+ShmPayload& ShmPayload::operator=(ShmPayload&& other) noexcept {
+    if (this != &other) {
+        if (segment_ != nullptr) {
+            pool_->recycle(segment_, true);
+        }
+        pool_ = std::exchange(other.pool_, nullptr);
+        segment_ = std::exchange(other.segment_, nullptr);
+    }
+    return *this;
+}
+
+char* ShmPayload::data() const noexcept {
+    return segment_ ? segment_->data : nullptr;
+}
+
+size_t ShmPayload::capacity() const noexcept {
+    return segment_ ? segment_->capacity : 0;
+}
+
+// ---- ShmSegmentPool ------------------------------------------------------
+
+ShmSegmentPool::ShmSegmentPool(pid_t receiver_pid, size_t max_pooled)
+    : receiver_pid_(receiver_pid), max_pooled_(max_pooled) {}
+
+ShmSegmentPool::~ShmSegmentPool() {
+    for (ShmSegment* segment : free_) {
+        destroy(segment);
+    }
+}
+
+ShmPayload ShmSegmentPool::acquire(size_t size) {
+    if (size > SHM_SEGMENT_MAX_SIZE) {
+        errno = EMSGSIZE;
+        return ShmPayload();
+    }
+    const size_t capacity = roundSegment(size);
+
+    bool pooled = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto found = std::find_if(free_.begin(), free_.end(),
+                                        [capacity](const ShmSegment* segment) {
+                                            return segment->capacity == capacity;
+                                        });
+        if (found != free_.end()) {
+            ShmSegment* const segment = *found;
+            free_.erase(found);
+            ++stats_.reused;
+            return ShmPayload(this, segment);
+        }
+
+        // A free segment of another size gives way to this one
+        if (pooled_ == max_pooled_ && !free_.empty()) {
+            ShmSegment* const evicted = free_.front();
+            free_.erase(free_.begin());
+            --pooled_;
+            stats_.pooled_bytes -= evicted->capacity;
+            destroy(evicted);
+        }
+        if (pooled_ < max_pooled_) {
+            pooled = true;
+            ++pooled_;
+            stats_.pooled_bytes += capacity;
+        }
+    }
+
+    // Created outside the lock: creating and mapping are kernel calls
+    ShmSegment* const segment = create(capacity, pooled);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (segment == nullptr) {
+        if (pooled) {
+            --pooled_;
+            stats_.pooled_bytes -= capacity;
+        }
+        return ShmPayload();
+    }
+    ++stats_.created;
+    if (!pooled) {
+        ++stats_.one_shot;
+    }
+    return ShmPayload(this, segment);
+}
+
+ShmPayloadHeader ShmSegmentPool::describe(const ShmPayload& payload, uint16_t type,
+                                          uint16_t subtype, size_t size) const noexcept {
+    const ShmSegment& segment = *payload.segment_;
+    uint32_t flags = 0;
+    if (!segment.granted) {
+        flags |= SHM_SEGMENT_NEW;
+    }
+    if (!segment.pooled) {
+        flags |= SHM_SEGMENT_RELEASE;
+    }
+    return ShmPayloadHeader{
+        segment.granted ? 0 : segment.handle,
+        segment.id,
+        flags,
+        segment.capacity,
+        type,
+        subtype,
+        static_cast<uint32_t>(size)
+    };
+}
+
+void ShmSegmentPool::release(ShmPayload payload, bool reusable) noexcept {
+    ShmSegment* const segment = std::exchange(payload.segment_, nullptr);
+    if (segment == nullptr) {
+        return;
+    }
+    if (reusable) {
+        segment->granted = true;
+    }
+    recycle(segment, reusable);
+}
+
+ShmPoolStats ShmSegmentPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+ShmSegment* ShmSegmentPool::create(size_t capacity, bool pooled) {
+    uint64_t handle = 0;
+    const int fd = createObject(handle);
+    if (fd == -1) {
+        const int error = errno;
+        IPC_LOG_ERROR("shm_open failed: {}", std::strerror(error));
+        errno = error;
+        return nullptr;
+    }
+
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(capacity)) == -1 ||
+        (base = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0)) == MAP_FAILED ||
+        !grantHandle(fd, receiver_pid_, handle)) {
+        const int error = errno;
+        IPC_LOG_ERROR("Shared segment setup failed: {}", std::strerror(error));
+        if (base != MAP_FAILED) {
+            munmap(base, capacity);
+        }
+        close(fd);
+        discardObject(handle);
+        errno = error;
+        return nullptr;
+    }
+    close(fd);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return new ShmSegment{next_id_++, static_cast<char*>(base), capacity, handle, false, pooled};
+}
+
+void ShmSegmentPool::recycle(ShmSegment* segment, bool reusable) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (reusable && segment->pooled) {
+        free_.push_back(segment);
+        return;
+    }
+    if (segment->pooled) {
+        --pooled_;
+        stats_.pooled_bytes -= segment->capacity;
+    }
+    destroy(segment);
+}
+
+void ShmSegmentPool::destroy(ShmSegment* segment) noexcept {
+    munmap(segment->data, segment->capacity);
+    if (!segment->granted) {
+        discardObject(segment->handle);
+    }
+    delete segment;
+}
+
+// ---- ShmSegmentMap -------------------------------------------------------
+
+ShmMapping::~ShmMapping() {
+    munmap(const_cast<char*>(data_), size_);
+}
+
+int ShmSegmentMap::resolve(const ShmPayloadHeader& header,
+                           std::shared_ptr<const ShmMapping>& mapping, bool& mapped) {
+    mapped = false;
+    if (header.size > header.capacity) {
+        return EBADMSG;
+    }
+    if (header.capacity > SHM_SEGMENT_MAX_SIZE) {
+        return EMSGSIZE;
+    }
+
+    if ((header.flags & SHM_SEGMENT_NEW) == 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto found = std::find_if(segments_.begin(), segments_.end(),
+                                        [&header](const auto& entry) {
+                                            return entry.first == header.segment;
+                                        });
+        if (found == segments_.end()) {
+            return ENOENT;
+        }
+        if (found->second->size() != header.capacity) {
+            return EBADMSG;
+        }
+        mapping = found->second;
+        return EOK;
+    }
+
+    // Opened and mapped outside the lock: both are kernel calls
+    const int fd = openHandle(header.shm_handle);
+    if (fd == -1) {
+        return errno;
+    }
+    struct stat info{};
+    if (fstat(fd, &info) == -1 || info.st_size < static_cast<off_t>(header.capacity)) {
+        close(fd);
+        return EBADMSG;
+    }
+    void* const base = mmap(nullptr, header.capacity, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        return error;
+    }
+    auto segment = std::make_shared<const ShmMapping>(static_cast<const char*>(base),
+                                                      header.capacity);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = std::find_if(segments_.begin(), segments_.end(),
+                                    [&header](const auto& entry) {
+                                        return entry.first == header.segment;
+                                    });
+    if (found != segments_.end()) {
+        found->second = segment;        // The sender replaced it
+    } else {
+        if (segments_.size() == MAX_CLIENT_SEGMENTS) {
+            // Make room with a segment no message is using
+            const auto idle = std::find_if(segments_.begin(), segments_.end(),
+                                           [](const auto& entry) {
+                                               return entry.second.use_count() == 1;
+                                           });
+            if (idle == segments_.end()) {
+                return EMFILE;
+            }
+            segments_.erase(idle);
+        }
+        segments_.emplace_back(header.segment, segment);
+    }
+    mapping = std::move(segment);
+    mapped = true;
+    return EOK;
+}
+
+void ShmSegmentMap::release(uint32_t segment) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = std::find_if(segments_.begin(), segments_.end(),
+                                    [segment](const auto& entry) {
+                                        return entry.first == segment;
+                                    });
+    if (found != segments_.end()) {
+        segments_.erase(found);
+    }
+}
+
+size_t ShmSegmentMap::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.size();
+}
+
+// ---- ShmSegmentHold ------------------------------------------------------
+
+ShmSegmentHold& ShmSegmentHold::operator=(ShmSegmentHold&& other) noexcept {
+    if (this != &other) {
+        reset();
+        mapping_ = std::move(other.mapping_);
+        map_ = std::move(other.map_);
+        release_ = std::exchange(other.release_, std::nullopt);
+    }
+    return *this;
+}
+
+void ShmSegmentHold::reset() noexcept {
+    mapping_.reset();
+    if (release_) {
+        map_->release(*release_);
+        release_.reset();
+    }
+    map_.reset();
+}
+
+} // namespace qnx::ipc
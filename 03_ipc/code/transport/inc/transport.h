@@ -0,0 +1,237 @@
+// transport.h
+// Message-passing transport with QNX native and Linux backends - Header
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// QNX's "no error" reply status, used by the code on both backends
+#ifndef EOK
+#define EOK 0
+#endif
+
+namespace qnx::ipc {
+
+/// Pulse the transport delivers when a client connection goes away
+/// (same value as QNX _PULSE_CODE_DISCONNECT)
+constexpr int TRANSPORT_PULSE_DISCONNECT = -33;
+
+/// Pulse the transport delivers when a reply-blocked client's send()
+/// times out; its value is the client's rcvid (same value as QNX
+/// _PULSE_CODE_UNBLOCK). The client stays blocked until that rcvid is
+/// replied to. Only QNX channels send it: on Linux the client gives up
+/// at once and a later reply is dropped.
+constexpr int TRANSPORT_PULSE_UNBLOCK = -32;
+
+/// Highest pulse code available to applications
+/// (same value as QNX _PULSE_CODE_MAXAVAIL)
+constexpr int TRANSPORT_PULSE_CODE_MAXAVAIL = 127;
+
+/**
+ * @brief A pulse as seen by the server
+ */
+struct Pulse {
+    int code;
+    int value;
+    int scoid;
+};
+
+/**
+ * @brief Sender details for one receive, a portable subset of _msg_info
+ */
+struct ReceiveInfo {
+    int scoid;          // Server connection id, unique across the process's channels
+    pid_t pid;          // Sending process
+    size_t msglen;      // Bytes placed in the receive buffer
+    size_t srcmsglen;   // Bytes the client sent
+    Pulse pulse;        // Valid when receive() returned 0
+};
+
+/**
+ * @brief Credentials of the process behind a connection, a portable
+ *        subset of _client_info
+ */
+struct ClientCredentials {
+    pid_t pid;
+    uid_t uid;          // Real user id
+    uid_t euid;         // Effective user id
+    gid_t gid;          // Real group id
+    gid_t egid;         // Effective group id
+};
+
+/**
+ * @brief Client side of a connection: MsgSend()/MsgSendPulse()
+ *
+ * send() may be called from several threads at once; each call blocks
+ * until its own reply arrives, like MsgSend() on a shared coid.
+ */
+class ClientConnection {
+public:
+    virtual ~ClientConnection() = default;
+
+    /**
+     * @brief Send a gathered message and wait for the reply
+     * @return The server's reply status, or -1 with errno set
+     */
+    virtual int send(const iovec* smsg, int sparts, const iovec* rmsg, int rparts) = 0;
+
+    /**
+     * @brief send() that gives up when timeout passes
+     *
+     * The timeout covers the send-blocked and reply-blocked states
+     * (TimerTimeout() on QNX; on Linux the wait for the reply). See
+     * TRANSPORT_PULSE_UNBLOCK for what the server sees.
+     * @return As send(); -1 with errno ETIMEDOUT if the timeout passed,
+     *         at once if it is not positive
+     */
+    virtual int send(const iovec* smsg, int sparts, const iovec* rmsg, int rparts,
+                     std::chrono::nanoseconds timeout) = 0;
+
+    /**
+     * @brief Queue a pulse without waiting
+     * @return 0, or -1 with errno set (EAGAIN: the pulse could not be queued)
+     */
+    virtual int sendPulse(int code, int value) = 0;
+
+    /**
+     * @brief Process id of the server, to grant it shared memory
+     *
+     * ConnectServerInfo() on QNX, the socket peer's credentials on Linux.
+     * @return The pid, or -1 with errno set
+     */
+    [[nodiscard]] virtual pid_t serverPid() const = 0;
+
+    /**
+     * @brief Backend connection id (the coid on QNX), for diagnostics
+     */
+    [[nodiscard]] virtual int id() const noexcept = 0;
+};
+
+/**
+ * @brief A timer that delivers a pulse to its channel when it expires
+ *
+ * A kernel timer with a SIGEV_PULSE event on QNX, a timerfd watched by
+ * the channel's I/O thread on Linux: neither needs a thread of its own,
+ * and the pulse is received like any other. Timer pulses have no client
+ * connection behind them.
+ */
+class PulseTimer {
+public:
+    virtual ~PulseTimer() = default;
+
+    /**
+     * @brief Start or restart the timer
+     * @param initial Time until the first pulse
+     * @param interval Time between later pulses; zero for a single pulse
+     * @return 0, or -1 with errno set
+     */
+    virtual int arm(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval) = 0;
+
+    /**
+     * @brief Stop the timer; a pulse already queued is still delivered
+     * @return 0, or -1 with errno set
+     */
+    virtual int disarm() = 0;
+};
+
+/**
+ * @brief Server side of a channel: MsgReceive()/MsgRead()/MsgReply()
+ *
+ * Any number of threads may receive on one channel. A rcvid stays valid
+ * until it is replied to with reply() or error().
+ */
+class ServerChannel {
+public:
+    virtual ~ServerChannel() = default;
+
+    /**
+     * @brief Wait for the next message or pulse
+     *
+     * Only the first `size` bytes of a message are copied; the rest can
+     * be pulled with read(). Connection setup and other transport-level
+     * traffic is handled internally and never returned.
+     * @return rcvid (> 0) for a message, 0 for a pulse, -1 with errno set
+     */
+    virtual int receive(void* buffer, size_t size, ReceiveInfo& info) = 0;
+
+    /**
+     * @brief Copy message bytes starting at offset
+     * @return Bytes copied, or -1 with errno set
+     */
+    virtual ssize_t read(int rcvid, void* buffer, size_t size, size_t offset) = 0;
+
+    /**
+     * @brief Unblock the client with a status and reply data
+     * @return 0, or -1 with errno set
+     */
+    virtual int reply(int rcvid, int status, const iovec* rmsg, int rparts) = 0;
+
+    /**
+     * @brief Unblock the client with an error (its send() fails with errno)
+     * @return 0, or -1 with errno set
+     */
+    virtual int error(int rcvid, int error) = 0;
+
+    /**
+     * @brief Look up who is behind a connection (ConnectClientInfo())
+     *
+     * A kernel call on QNX: look clients up once per connection, not
+     * once per message.
+     * @return 0, or -1 with errno set (ESRCH: no such connection)
+     */
+    virtual int clientInfo(int scoid, ClientCredentials& credentials) = 0;
+
+    /**
+     * @brief Open a connection to this channel from the same process
+     *
+     * Used for pulses to ourselves and by in-process benchmarks.
+     * @return nullptr with errno set on failure
+     */
+    virtual std::unique_ptr<ClientConnection> connectSelf() = 0;
+
+    /**
+     * @brief Create a disarmed timer that pulses this channel with code/value
+     *
+     * The timer must be destroyed before the channel.
+     * @return nullptr with errno set on failure
+     */
+    virtual std::unique_ptr<PulseTimer> createTimer(int code, int value) = 0;
+
+    /**
+     * @brief Backend channel id (the chid on QNX), for diagnostics
+     */
+    [[nodiscard]] virtual int id() const noexcept = 0;
+};
+
+/**
+ * @brief Create a channel clients can find by name (name_attach())
+ * @return nullptr with errno set on failure
+ */
+std::unique_ptr<ServerChannel> attachChannel(std::string_view name);
+
+/**
+ * @brief Create an unnamed channel, reachable only through connectSelf()
+ * @return nullptr with errno set on failure
+ */
+std::unique_ptr<ServerChannel> createChannel();
+
+/**
+ * @brief Connect to a channel created with attachChannel() (name_open())
+ * @return nullptr with errno set on failure
+ */
+std::unique_ptr<ClientConnection> openConnection(std::string_view name);
+
+/**
+ * @brief Name of the backend this binary was built with ("qnx" or "linux")
+ */
+const char* transportName() noexcept;
+
+} // namespace qnx::ipc
+
+#endif // TRANSPORT_H
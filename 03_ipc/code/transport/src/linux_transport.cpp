@@ -0,0 +1,867 @@
+// linux_transport.cpp
+// Linux transport: QNX send/receive/reply semantics over Unix sockets - Implementation
+//
+// Each client connection is a SOCK_STREAM socket carrying frames. A
+// per-channel I/O thread reads whole messages into memory and queues
+// them, so any number of threads can receive() on the channel; a rcvid
+// names a queued message until it is replied to. On the client side the
+// first waiting sender reads replies for everyone and hands each to the
+// thread that sent the matching request, so concurrent send() calls on
+// one connection behave like MsgSend() on a shared coid. A send() that
+// times out drops its request's slot; the reply, if it comes, is read
+// and discarded. Timers are
+// timerfds on the same epoll set, turned into pulses by the I/O thread.
+#include "transport.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace qnx::ipc {
+
+namespace {
+
+/**
+ * @brief Header in front of every transfer on a connection
+ */
+struct Frame {
+    uint32_t kind;
+    uint32_t id;        // Request id; the value for FRAME_PULSE
+    int32_t status;     // Reply status; errno for FRAME_ERROR; code for FRAME_PULSE
+    uint32_t length;    // Data bytes following the header
+};
+
+enum FrameKind : uint32_t {
+    FRAME_SEND = 1,
+    FRAME_PULSE,
+    FRAME_REPLY,
+    FRAME_ERROR
+};
+
+// Larger frames are treated as a protocol error and drop the client
+constexpr uint32_t MAX_FRAME_LENGTH = 64 * 1024 * 1024;
+
+constexpr int MAX_IOV_PARTS = 16;
+constexpr const char* SOCKET_PREFIX = "qnx_ipc.";
+
+// epoll keys below the first scoid
+constexpr uint64_t KEY_STOP = 0;
+constexpr uint64_t KEY_LISTEN = 1;
+constexpr int FIRST_SCOID = 2;
+
+// Shared by every channel: as on QNX, a scoid names one connection to
+// the server process, whichever channel it is on
+std::atomic<int> next_scoid{FIRST_SCOID};
+// epoll keys above every scoid
+constexpr uint64_t FIRST_TIMER_KEY = uint64_t{1} << 32;
+
+// Abstract socket address: nothing in the filesystem to clean up
+socklen_t makeAddress(std::string_view name, sockaddr_un& addr) {
+    addr = sockaddr_un{};
+    addr.sun_family = AF_UNIX;
+
+    const std::string path = std::string(SOCKET_PREFIX) + std::string(name);
+    const size_t length = std::min(path.size(), sizeof(addr.sun_path) - 1);
+    std::memcpy(addr.sun_path + 1, path.data(), length);
+    return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + length);
+}
+
+// A peer that vanished looks like a dead QNX server/client
+int peerError(int error) noexcept {
+    return (error == EPIPE || error == ECONNRESET) ? ESRCH : error;
+}
+
+bool readAll(int fd, void* buffer, size_t size) {
+    char* out = static_cast<char*>(buffer);
+    while (size > 0) {
+        const ssize_t n = ::recv(fd, out, size, 0);
+        if (n > 0) {
+            out += n;
+            size -= static_cast<size_t>(n);
+        } else if (n == -1 && errno == EINTR) {
+            continue;
+        } else {
+            if (n == 0) {
+                errno = ESRCH;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+bool discard(int fd, size_t size) {
+    std::array<char, 4096> scratch;
+    while (size > 0) {
+        const size_t chunk = std::min(size, scratch.size());
+        if (!readAll(fd, scratch.data(), chunk)) {
+            return false;
+        }
+        size -= chunk;
+    }
+    return true;
+}
+
+timespec toTimespec(std::chrono::nanoseconds duration) noexcept {
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    return timespec{static_cast<time_t>(seconds.count()),
+                    static_cast<long>((duration - seconds).count())};
+}
+
+size_t totalLength(const iovec* iov, int parts) noexcept {
+    size_t total = 0;
+    for (int i = 0; i < parts; ++i) {
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+/**
+ * @brief Write a frame header and its data in as few syscalls as possible
+ *
+ * Callers serialise writers per socket. With `try_only` the write fails
+ * with EAGAIN if the socket buffer is full, unless part of the frame
+ * already went out, in which case it completes (frames never split).
+ * @return 0, or -1 with errno set
+ */
+int writeFrame(int fd, const Frame& frame, const iovec* data, int parts,
+               bool try_only = false) {
+    if (parts < 0 || parts > MAX_IOV_PARTS) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    std::array<iovec, MAX_IOV_PARTS + 1> iov;
+    iov[0] = iovec{const_cast<Frame*>(&frame), sizeof(frame)};
+    std::copy(data, data + parts, iov.begin() + 1);
+
+    iovec* next = iov.data();
+    size_t count = static_cast<size_t>(parts) + 1;
+    int flags = MSG_NOSIGNAL | (try_only ? MSG_DONTWAIT : 0);
+
+    while (count > 0) {
+        msghdr msg{};
+        msg.msg_iov = next;
+        msg.msg_iovlen = count;
+
+        const ssize_t n = ::sendmsg(fd, &msg, flags);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        flags &= ~MSG_DONTWAIT;
+
+        size_t done = static_cast<size_t>(n);
+        while (count > 0 && done >= next->iov_len) {
+            done -= next->iov_len;
+            ++next;
+            --count;
+        }
+        if (count > 0) {
+            next->iov_base = static_cast<char*>(next->iov_base) + done;
+            next->iov_len -= done;
+        }
+    }
+    return 0;
+}
+
+int connectTo(std::string_view name) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+
+    sockaddr_un addr;
+    const socklen_t length = makeAddress(name, addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), length) == -1) {
+        const int error = errno;
+        ::close(fd);
+        // Same errno as name_open() for a name nobody has attached
+        errno = (error == ECONNREFUSED) ? ENOENT : error;
+        return -1;
+    }
+    return fd;
+}
+
+class LinuxConnection : public ClientConnection {
+public:
+    explicit LinuxConnection(int fd) noexcept : fd_(fd) {}
+
+    ~LinuxConnection() override { ::close(fd_); }
+
+    LinuxConnection(const LinuxConnection&) = delete;
+    LinuxConnection& operator=(const LinuxConnection&) = delete;
+
+    int send(const iovec* smsg, int sparts, const iovec* rmsg, int rparts) override {
+        return exchange(smsg, sparts, rmsg, rparts, std::nullopt);
+    }
+
+    int send(const iovec* smsg, int sparts, const iovec* rmsg, int rparts,
+             std::chrono::nanoseconds timeout) override {
+        if (timeout.count() <= 0) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        return exchange(smsg, sparts, rmsg, rparts, std::chrono::steady_clock::now() + timeout);
+    }
+
+    int sendPulse(int code, int value) override {
+        // As MsgSendPulse(): the server would drop us for anything else
+        if (code < 0 || code > TRANSPORT_PULSE_CODE_MAXAVAIL) {
+            errno = EINVAL;
+            return -1;
+        }
+        const Frame frame{FRAME_PULSE, static_cast<uint32_t>(value), code, 0};
+
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        if (writeFrame(fd_, frame, nullptr, 0, true) == -1) {
+            errno = peerError(errno);
+            return -1;
+        }
+        return 0;
+    }
+
+    pid_t serverPid() const override {
+        ucred cred{};
+        socklen_t length = sizeof(cred);
+        if (::getsockopt(fd_, SOL_SOCKET, SO_PEERCRED, &cred, &length) == -1) {
+            return -1;
+        }
+        return cred.pid;
+    }
+
+    int id() const noexcept override { return fd_; }
+
+private:
+    struct Slot {
+        const iovec* rmsg;
+        int rparts;
+        int status = 0;
+        int error = 0;
+        bool done = false;
+    };
+
+    int fd_;
+    std::atomic<uint32_t> next_id_{1};
+
+    std::mutex write_mutex_;
+    std::mutex mutex_;
+    std::condition_variable reply_cv_;
+    std::unordered_map<uint32_t, Slot*> slots_;
+    bool reading_ = false;
+    bool broken_ = false;
+
+    int exchange(const iovec* smsg, int sparts, const iovec* rmsg, int rparts,
+                 std::optional<std::chrono::steady_clock::time_point> deadline) {
+        Slot slot{rmsg, rparts};
+        const uint32_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (broken_) {
+                errno = ESRCH;
+                return -1;
+            }
+            slots_.emplace(id, &slot);
+        }
+
+        const Frame frame{FRAME_SEND, id, 0,
+                          static_cast<uint32_t>(totalLength(smsg, sparts))};
+        int write_error = 0;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            if (writeFrame(fd_, frame, smsg, sparts) == -1) {
+                write_error = errno;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (write_error != 0) {
+            slots_.erase(id);
+            errno = peerError(write_error);
+            return -1;
+        }
+
+        // Whoever finds nobody reading takes over reading replies
+        while (!slot.done) {
+            bool expired = false;
+            if (reading_) {
+                if (!deadline) {
+                    reply_cv_.wait(lock);
+                    continue;
+                }
+                expired = reply_cv_.wait_until(lock, *deadline) == std::cv_status::timeout;
+            } else {
+                reading_ = true;
+                lock.unlock();
+                expired = !(deadline ? waitReadable(*deadline) : true);
+                if (!expired) {
+                    readReply();
+                }
+                lock.lock();
+                reading_ = false;
+                reply_cv_.notify_all();
+            }
+
+            // A slot no longer listed is being filled by the reader: wait
+            if (expired && !slot.done && slots_.erase(id) == 1) {
+                errno = ETIMEDOUT;
+                return -1;
+            }
+        }
+
+        if (slot.error != 0) {
+            errno = slot.error;
+            return -1;
+        }
+        return slot.status;
+    }
+
+    // Without consuming anything; an error or hang-up counts as readable
+    // so that readReply() sees it
+    bool waitReadable(std::chrono::steady_clock::time_point deadline) {
+        while (true) {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                return false;
+            }
+            pollfd fds{fd_, POLLIN, 0};
+            const int ready = ::poll(&fds, 1, static_cast<int>(
+                std::min<std::chrono::milliseconds::rep>(left.count(), INT_MAX)));
+            if (ready > 0 || (ready == -1 && errno != EINTR)) {
+                return true;
+            }
+        }
+    }
+
+    // Runs without the lock; only one thread reads at a time
+    void readReply() {
+        Frame frame;
+        if (!readAll(fd_, &frame, sizeof(frame))) {
+            failAll(ESRCH);
+            return;
+        }
+
+        Slot* slot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto it = slots_.find(frame.id);
+            if (it != slots_.end()) {
+                slot = it->second;
+                slots_.erase(it);
+            }
+        }
+
+        // Fill the sender's reply buffers; bytes that don't fit are dropped
+        size_t left = frame.length;
+        bool ok = true;
+        if (slot != nullptr) {
+            for (int i = 0; ok && i < slot->rparts && left > 0; ++i) {
+                const size_t chunk = std::min(left, slot->rmsg[i].iov_len);
+                ok = readAll(fd_, slot->rmsg[i].iov_base, chunk);
+                left -= chunk;
+            }
+        }
+        ok = ok && discard(fd_, left);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (slot != nullptr) {
+                slot->status = frame.status;
+                slot->error = !ok ? ESRCH : (frame.kind == FRAME_ERROR ? frame.status : 0);
+                slot->done = true;
+            }
+            if (!ok) {
+                failAllLocked(ESRCH);
+            }
+        }
+        // The reply may belong to another waiting sender
+        reply_cv_.notify_all();
+    }
+
+    void failAll(int error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failAllLocked(error);
+    }
+
+    void failAllLocked(int error) {
+        broken_ = true;
+        for (auto& [id, slot] : slots_) {
+            slot->error = error;
+            slot->done = true;
+        }
+        slots_.clear();
+    }
+};
+
+class LinuxChannel : public ServerChannel {
+public:
+    LinuxChannel(std::string name, int listen_fd, int epoll_fd, int stop_fd)
+        : name_(std::move(name)),
+          listen_fd_(listen_fd),
+          epoll_fd_(epoll_fd),
+          stop_fd_(stop_fd),
+          io_thread_(&LinuxChannel::ioLoop, this) {}
+
+    ~LinuxChannel() override {
+        const uint64_t one = 1;
+        (void)!::write(stop_fd_, &one, sizeof(one));
+        io_thread_.join();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        receive_cv_.notify_all();
+
+        ::close(listen_fd_);
+        ::close(epoll_fd_);
+        ::close(stop_fd_);
+    }
+
+    LinuxChannel(const LinuxChannel&) = delete;
+    LinuxChannel& operator=(const LinuxChannel&) = delete;
+
+    int receive(void* buffer, size_t size, ReceiveInfo& info) override {
+        Message message;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            receive_cv_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                errno = EBADF;
+                return -1;
+            }
+            message = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        if (message.kind == FRAME_PULSE) {
+            // Timer pulses have no client; QNX reports scoid 0 for them too
+            const int scoid = message.client ? message.client->scoid : 0;
+            const pid_t pid = message.client ? message.client->pid : ::getpid();
+            info = ReceiveInfo{scoid, pid, 0, 0,
+                               Pulse{message.status, static_cast<int>(message.id), scoid}};
+            return 0;
+        }
+
+        const Client& client = *message.client;
+        const size_t copied = std::min(size, message.data.size());
+        std::memcpy(buffer, message.data.data(), copied);
+        info = ReceiveInfo{client.scoid, client.pid, copied, message.data.size(), Pulse{}};
+
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        const int rcvid = next_rcvid_;
+        next_rcvid_ = (next_rcvid_ == INT_MAX) ? 1 : next_rcvid_ + 1;
+        pending_[rcvid] = std::move(message);
+        return rcvid;
+    }
+
+    ssize_t read(int rcvid, void* buffer, size_t size, size_t offset) override {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        const auto it = pending_.find(rcvid);
+        if (it == pending_.end()) {
+            errno = ESRCH;
+            return -1;
+        }
+
+        const std::vector<char>& data = it->second.data;
+        if (offset >= data.size()) {
+            return 0;
+        }
+        const size_t copied = std::min(size, data.size() - offset);
+        std::memcpy(buffer, data.data() + offset, copied);
+        return static_cast<ssize_t>(copied);
+    }
+
+    int reply(int rcvid, int status, const iovec* rmsg, int rparts) override {
+        return respond(rcvid, FRAME_REPLY, status, rmsg, rparts);
+    }
+
+    int error(int rcvid, int error) override {
+        return respond(rcvid, FRAME_ERROR, error, nullptr, 0);
+    }
+
+    int clientInfo(int scoid, ClientCredentials& credentials) override {
+        std::lock_guard<std::mutex> lock(credentials_mutex_);
+        const auto it = credentials_.find(scoid);
+        if (it == credentials_.end()) {
+            errno = ESRCH;
+            return -1;
+        }
+        credentials = it->second;
+        return 0;
+    }
+
+    std::unique_ptr<ClientConnection> connectSelf() override {
+        const int fd = connectTo(name_);
+        if (fd == -1) {
+            return nullptr;
+        }
+        return std::make_unique<LinuxConnection>(fd);
+    }
+
+    std::unique_ptr<PulseTimer> createTimer(int code, int value) override;
+
+    int id() const noexcept override { return listen_fd_; }
+
+    // Called by LinuxTimer: the timerfd is closed with the entry
+    void removeTimer(uint64_t key) {
+        std::lock_guard<std::mutex> lock(timers_mutex_);
+        const auto it = timers_.find(key);
+        if (it != timers_.end()) {
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+            ::close(it->second.fd);
+            timers_.erase(it);
+        }
+    }
+
+private:
+    struct Client {
+        Client(int socket, int id, pid_t owner) noexcept
+            : fd(socket), scoid(id), pid(owner) {}
+        ~Client() { ::close(fd); }
+
+        int fd;
+        int scoid;
+        pid_t pid;
+        std::mutex write_mutex;
+    };
+
+    // A queued message or pulse; replies hold the client open
+    struct Message {
+        std::shared_ptr<Client> client;
+        uint32_t kind = 0;
+        uint32_t id = 0;
+        int32_t status = 0;
+        std::vector<char> data;
+    };
+
+    std::string name_;
+    int listen_fd_;
+    int epoll_fd_;
+    int stop_fd_;
+
+    std::mutex mutex_;
+    std::condition_variable receive_cv_;
+    std::deque<Message> queue_;
+    bool closed_ = false;
+
+    std::mutex pending_mutex_;
+    std::unordered_map<int, Message> pending_;
+    int next_rcvid_ = 1;
+
+    // SO_PEERCRED at connect time, until the client disconnects
+    std::mutex credentials_mutex_;
+    std::unordered_map<int, ClientCredentials> credentials_;
+
+    // Looked up by the I/O thread under the lock, so a timer being
+    // destroyed never has its fd read after it is closed
+    struct TimerSource {
+        int fd;
+        int code;
+        int value;
+    };
+    std::mutex timers_mutex_;
+    std::unordered_map<uint64_t, TimerSource> timers_;
+    uint64_t next_timer_key_ = FIRST_TIMER_KEY;
+
+    // Owned by the I/O thread
+    std::unordered_map<int, std::shared_ptr<Client>> clients_;
+
+    std::thread io_thread_;
+
+    int respond(int rcvid, uint32_t kind, int status, const iovec* rmsg, int rparts) {
+        Message message;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            const auto it = pending_.find(rcvid);
+            if (it == pending_.end()) {
+                errno = ESRCH;
+                return -1;
+            }
+            message = std::move(it->second);
+            pending_.erase(it);
+        }
+
+        const Frame frame{kind, message.id, status,
+                          static_cast<uint32_t>(totalLength(rmsg, rparts))};
+        Client& client = *message.client;
+
+        std::lock_guard<std::mutex> lock(client.write_mutex);
+        if (writeFrame(client.fd, frame, rmsg, rparts) == -1) {
+            errno = peerError(errno);
+            return -1;
+        }
+        return 0;
+    }
+
+    void enqueue(Message message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(message));
+        }
+        receive_cv_.notify_one();
+    }
+
+    void ioLoop() {
+        std::array<epoll_event, 32> events;
+
+        while (true) {
+            const int count = ::epoll_wait(epoll_fd_, events.data(),
+                                           static_cast<int>(events.size()), -1);
+            if (count == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                const uint64_t key = events[i].data.u64;
+                if (key == KEY_STOP) {
+                    return;
+                }
+                if (key == KEY_LISTEN) {
+                    acceptClient();
+                } else if (key >= FIRST_TIMER_KEY) {
+                    fireTimer(key);
+                } else {
+                    serviceClient(static_cast<int>(key));
+                }
+            }
+        }
+    }
+
+    void acceptClient() {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            return;
+        }
+
+        ucred cred{};
+        socklen_t length = sizeof(cred);
+        ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &length);
+
+        const int scoid = next_scoid.fetch_add(1, std::memory_order_relaxed);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = static_cast<uint64_t>(scoid);
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+            ::close(fd);
+            return;
+        }
+        clients_.emplace(scoid, std::make_shared<Client>(fd, scoid, cred.pid));
+
+        // Sockets only report the effective ids; use them for both
+        std::lock_guard<std::mutex> lock(credentials_mutex_);
+        credentials_[scoid] = ClientCredentials{cred.pid, cred.uid, cred.uid,
+                                                cred.gid, cred.gid};
+    }
+
+    // Any number of expiries since the last read make one pulse
+    void fireTimer(uint64_t key) {
+        std::lock_guard<std::mutex> lock(timers_mutex_);
+        const auto it = timers_.find(key);
+        if (it == timers_.end()) {
+            return;
+        }
+        uint64_t expirations = 0;
+        if (::read(it->second.fd, &expirations, sizeof(expirations)) !=
+            static_cast<ssize_t>(sizeof(expirations))) {
+            return;
+        }
+        enqueue(Message{nullptr, FRAME_PULSE, static_cast<uint32_t>(it->second.value),
+                        it->second.code, {}});
+    }
+
+    // Reads one whole frame; level-triggered epoll brings us back for more
+    void serviceClient(int scoid) {
+        const auto it = clients_.find(scoid);
+        if (it == clients_.end()) {
+            return;
+        }
+        const std::shared_ptr<Client> client = it->second;
+
+        // Clients get the codes QNX lets them send; the negative ones are
+        // the transport's own (disconnect, unblock)
+        Frame frame;
+        bool ok = readAll(client->fd, &frame, sizeof(frame)) &&
+                  (frame.kind == FRAME_SEND ||
+                   (frame.kind == FRAME_PULSE && frame.status >= 0 &&
+                    frame.status <= TRANSPORT_PULSE_CODE_MAXAVAIL)) &&
+                  frame.length <= MAX_FRAME_LENGTH;
+
+        Message message{client, frame.kind, frame.id, frame.status, {}};
+        if (ok) {
+            message.data.resize(frame.length);
+            ok = readAll(client->fd, message.data.data(), frame.length);
+        }
+
+        if (!ok) {
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client->fd, nullptr);
+            clients_.erase(it);
+            {
+                std::lock_guard<std::mutex> lock(credentials_mutex_);
+                credentials_.erase(scoid);
+            }
+            enqueue(Message{client, FRAME_PULSE, 0, TRANSPORT_PULSE_DISCONNECT, {}});
+            return;
+        }
+        enqueue(std::move(message));
+    }
+};
+
+class LinuxTimer : public PulseTimer {
+public:
+    LinuxTimer(LinuxChannel& channel, uint64_t key, int fd) noexcept
+        : channel_(channel), key_(key), fd_(fd) {}
+
+    ~LinuxTimer() override { channel_.removeTimer(key_); }
+
+    LinuxTimer(const LinuxTimer&) = delete;
+    LinuxTimer& operator=(const LinuxTimer&) = delete;
+
+    int arm(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval) override {
+        // A zero it_value disarms, so "now" is the smallest non-zero delay
+        itimerspec spec{};
+        spec.it_value = toTimespec(std::max(initial, std::chrono::nanoseconds(1)));
+        spec.it_interval = toTimespec(interval);
+        return ::timerfd_settime(fd_, 0, &spec, nullptr);
+    }
+
+    int disarm() override {
+        const itimerspec spec{};
+        return ::timerfd_settime(fd_, 0, &spec, nullptr);
+    }
+
+private:
+    LinuxChannel& channel_;
+    uint64_t key_;
+    int fd_;    // Owned by the channel's timer table
+};
+
+std::unique_ptr<PulseTimer> LinuxChannel::createTimer(int code, int value) {
+    const int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd == -1) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(timers_mutex_);
+    const uint64_t key = next_timer_key_++;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = key;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        return nullptr;
+    }
+    timers_.emplace(key, TimerSource{fd, code, value});
+    return std::make_unique<LinuxTimer>(*this, key, fd);
+}
+
+std::unique_ptr<ServerChannel> listenOn(std::string name) {
+    const int listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd == -1) {
+        return nullptr;
+    }
+
+    const auto fail = [&](int extra_fd = -1, int extra_fd2 = -1) {
+        const int error = errno;
+        ::close(listen_fd);
+        if (extra_fd != -1) {
+            ::close(extra_fd);
+        }
+        if (extra_fd2 != -1) {
+            ::close(extra_fd2);
+        }
+        errno = error;
+        return nullptr;
+    };
+
+    sockaddr_un addr;
+    const socklen_t length = makeAddress(name, addr);
+    if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), length) == -1) {
+        // Same errno as name_attach() for a name already in use
+        if (errno == EADDRINUSE) {
+            errno = EEXIST;
+        }
+        return fail();
+    }
+    if (::listen(listen_fd, SOMAXCONN) == -1) {
+        return fail();
+    }
+
+    const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        return fail();
+    }
+    const int stop_fd = ::eventfd(0, EFD_CLOEXEC);
+    if (stop_fd == -1) {
+        return fail(epoll_fd);
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = KEY_STOP;
+    if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &event) == -1) {
+        return fail(epoll_fd, stop_fd);
+    }
+    event.data.u64 = KEY_LISTEN;
+    if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) == -1) {
+        return fail(epoll_fd, stop_fd);
+    }
+
+    return std::make_unique<LinuxChannel>(std::move(name), listen_fd, epoll_fd, stop_fd);
+}
+
+} // namespace
+
+std::unique_ptr<ServerChannel> attachChannel(std::string_view name) {
+    return listenOn(std::string(name));
+}
+
+std::unique_ptr<ServerChannel> createChannel() {
+    static std::atomic<unsigned> counter{0};
+    return listenOn("anon." + std::to_string(::getpid()) + "." +
+                    std::to_string(counter.fetch_add(1)));
+}
+
+std::unique_ptr<ClientConnection> openConnection(std::string_view name) {
+    const int fd = connectTo(name);
+    if (fd == -1) {
+        return nullptr;
+    }
+    return std::make_unique<LinuxConnection>(fd);
+}
+
+const char* transportName() noexcept {
+    return "linux";
+}
+
+} // namespace qnx::ipc
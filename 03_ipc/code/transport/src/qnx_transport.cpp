@@ -0,0 +1,263 @@
+// qnx_transport.cpp
+// QNX native transport: thin wrappers over the kernel calls - Implementation
+#include "transport.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <sys/neutrino.h>
+#include <sys/dispatch.h>
+#include <sys/iomsg.h>
+
+namespace qnx::ipc {
+
+static_assert(TRANSPORT_PULSE_DISCONNECT == _PULSE_CODE_DISCONNECT,
+              "transport disconnect pulse must match the kernel's");
+static_assert(TRANSPORT_PULSE_UNBLOCK == _PULSE_CODE_UNBLOCK,
+              "transport unblock pulse must match the kernel's");
+static_assert(TRANSPORT_PULSE_CODE_MAXAVAIL == _PULSE_CODE_MAXAVAIL,
+              "transport pulse code range must match the kernel's");
+
+namespace {
+
+class QnxConnection : public ClientConnection {
+public:
+    // named: opened with name_open() rather than ConnectAttach()
+    QnxConnection(int coid, bool named) noexcept
+        : coid_(coid), named_(named) {}
+
+    ~QnxConnection() override {
+        if (named_) {
+            name_close(coid_);
+        } else {
+            ConnectDetach(coid_);
+        }
+    }
+
+    QnxConnection(const QnxConnection&) = delete;
+    QnxConnection& operator=(const QnxConnection&) = delete;
+
+    int send(const iovec* smsg, int sparts, const iovec* rmsg, int rparts) override {
+        return static_cast<int>(MsgSendv(coid_, smsg, sparts, rmsg, rparts));
+    }
+
+    int send(const iovec* smsg, int sparts, const iovec* rmsg, int rparts,
+             std::chrono::nanoseconds timeout) override {
+        if (timeout.count() <= 0) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        // Applies to the next blocking kernel call only: the MsgSendv()
+        uint64_t ns = static_cast<uint64_t>(timeout.count());
+        if (TimerTimeout(CLOCK_MONOTONIC, _NTO_TIMEOUT_SEND | _NTO_TIMEOUT_REPLY,
+                         nullptr, &ns, nullptr) == -1) {
+            return -1;
+        }
+        return static_cast<int>(MsgSendv(coid_, smsg, sparts, rmsg, rparts));
+    }
+
+    int sendPulse(int code, int value) override {
+        return MsgSendPulse(coid_, -1, code, value) == -1 ? -1 : 0;
+    }
+
+    pid_t serverPid() const override {
+        _server_info info{};
+        if (ConnectServerInfo(0, coid_, &info) != coid_) {
+            return -1;
+        }
+        return info.pid;
+    }
+
+    int id() const noexcept override { return coid_; }
+
+private:
+    int coid_;
+    bool named_;
+};
+
+timespec toTimespec(std::chrono::nanoseconds duration) noexcept {
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    return timespec{static_cast<time_t>(seconds.count()),
+                    static_cast<long>((duration - seconds).count())};
+}
+
+class QnxTimer : public PulseTimer {
+public:
+    // coid: side-channel connection the pulses are sent over (owned)
+    QnxTimer(timer_t timer, int coid) noexcept : timer_(timer), coid_(coid) {}
+
+    ~QnxTimer() override {
+        timer_delete(timer_);
+        ConnectDetach(coid_);
+    }
+
+    QnxTimer(const QnxTimer&) = delete;
+    QnxTimer& operator=(const QnxTimer&) = delete;
+
+    int arm(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval) override {
+        // A zero it_value disarms, so "now" is the smallest non-zero delay
+        struct itimerspec spec{};
+        spec.it_value = toTimespec(std::max(initial, std::chrono::nanoseconds(1)));
+        spec.it_interval = toTimespec(interval);
+        return timer_settime(timer_, 0, &spec, nullptr);
+    }
+
+    int disarm() override {
+        struct itimerspec spec{};
+        return timer_settime(timer_, 0, &spec, nullptr);
+    }
+
+private:
+    timer_t timer_;
+    int coid_;
+};
+
+class QnxChannel : public ServerChannel {
+public:
+    // attach: created with name_attach(), otherwise ChannelCreate()
+    QnxChannel(int chid, name_attach_t* attach) noexcept
+        : chid_(chid), attach_(attach) {}
+
+    ~QnxChannel() override {
+        if (attach_ != nullptr) {
+            name_detach(attach_, 0);
+        } else {
+            ChannelDestroy(chid_);
+        }
+    }
+
+    QnxChannel(const QnxChannel&) = delete;
+    QnxChannel& operator=(const QnxChannel&) = delete;
+
+    int receive(void* buffer, size_t size, ReceiveInfo& info) override {
+        while (true) {
+            struct _msg_info msg_info;
+            const int rcvid = MsgReceive(chid_, buffer, size, &msg_info);
+            if (rcvid == -1) {
+                return -1;
+            }
+
+            if (rcvid == 0) {
+                struct _pulse pulse;
+                std::memcpy(&pulse, buffer, sizeof(pulse));
+                info = ReceiveInfo{pulse.scoid, 0, 0, 0,
+                                   Pulse{pulse.code, pulse.value.sival_int, pulse.scoid}};
+
+                // Release the server side of the connection; the scoid
+                // still identifies the client to the caller
+                if (pulse.code == _PULSE_CODE_DISCONNECT) {
+                    ConnectDetach(pulse.scoid);
+                }
+                return 0;
+            }
+
+            // name_open() sends _IO_CONNECT; accept it, refuse other I/O messages
+            uint16_t type = 0;
+            if (msg_info.msglen >= sizeof(type)) {
+                std::memcpy(&type, buffer, sizeof(type));
+            }
+            if (type == _IO_CONNECT) {
+                MsgReply(rcvid, EOK, nullptr, 0);
+                continue;
+            }
+            if (type > _IO_BASE && type <= _IO_MAX) {
+                MsgError(rcvid, ENOSYS);
+                continue;
+            }
+
+            info = ReceiveInfo{msg_info.scoid, msg_info.pid, msg_info.msglen,
+                               msg_info.srcmsglen, Pulse{}};
+            return rcvid;
+        }
+    }
+
+    ssize_t read(int rcvid, void* buffer, size_t size, size_t offset) override {
+        return MsgRead(rcvid, buffer, size, offset);
+    }
+
+    int reply(int rcvid, int status, const iovec* rmsg, int rparts) override {
+        return MsgReplyv(rcvid, status, rmsg, rparts) == -1 ? -1 : 0;
+    }
+
+    int error(int rcvid, int error) override {
+        return MsgError(rcvid, error) == -1 ? -1 : 0;
+    }
+
+    int clientInfo(int scoid, ClientCredentials& credentials) override {
+        struct _client_info info;
+        if (ConnectClientInfo(scoid, &info, 0) == -1) {
+            return -1;
+        }
+        credentials = ClientCredentials{info.pid, info.cred.ruid, info.cred.euid,
+                                        info.cred.rgid, info.cred.egid};
+        return 0;
+    }
+
+    std::unique_ptr<ClientConnection> connectSelf() override {
+        const int coid = ConnectAttach(0, 0, chid_, _NTO_SIDE_CHANNEL, 0);
+        if (coid == -1) {
+            return nullptr;
+        }
+        return std::make_unique<QnxConnection>(coid, false);
+    }
+
+    std::unique_ptr<PulseTimer> createTimer(int code, int value) override {
+        const int coid = ConnectAttach(0, 0, chid_, _NTO_SIDE_CHANNEL, 0);
+        if (coid == -1) {
+            return nullptr;
+        }
+
+        // The kernel sends the pulse itself, at the creating thread's priority
+        struct sigevent event;
+        SIGEV_PULSE_INIT(&event, coid, SIGEV_PULSE_PRIO_INHERIT, code, value);
+        timer_t timer;
+        if (timer_create(CLOCK_MONOTONIC, &event, &timer) == -1) {
+            const int error = errno;
+            ConnectDetach(coid);
+            errno = error;
+            return nullptr;
+        }
+        return std::make_unique<QnxTimer>(timer, coid);
+    }
+
+    int id() const noexcept override { return chid_; }
+
+private:
+    int chid_;
+    name_attach_t* attach_;
+};
+
+} // namespace
+
+std::unique_ptr<ServerChannel> attachChannel(std::string_view name) {
+    name_attach_t* attach = name_attach(nullptr, std::string(name).c_str(), 0);
+    if (attach == nullptr) {
+        return nullptr;
+    }
+    return std::make_unique<QnxChannel>(attach->chid, attach);
+}
+
+std::unique_ptr<ServerChannel> createChannel() {
+    const int chid = ChannelCreate(0);
+    if (chid == -1) {
+        return nullptr;
+    }
+    return std::make_unique<QnxChannel>(chid, nullptr);
+}
+
+std::unique_ptr<ClientConnection> openConnection(std::string_view name) {
+    const int coid = name_open(std::string(name).c_str(), 0);
+    if (coid == -1) {
+        return nullptr;
+    }
+    return std::make_unique<QnxConnection>(coid, true);
+}
+
+const char* transportName() noexcept {
+    return "qnx";
+}
+
+} // namespace qnx::ipc